@@ -0,0 +1,488 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file AnalogInputEngine.hxx
+ *
+ * Continuous (DMA) ADC sampling with threshold detection.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef ANALOG_INPUT_ENGINE_HXX_
+#define ANALOG_INPUT_ENGINE_HXX_
+
+#include "InputEngine.hxx"
+
+#include <esp_adc/adc_continuous.h>
+#include <executor/StateFlow.hxx>
+#include <freertos/FreeRTOS.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <algorithm>
+#include <iterator>
+
+namespace esp32io
+{
+
+/// @ref InputEngine which samples ADC1 channels in continuous (DMA) mode and
+/// publishes threshold crossings as transitions.
+///
+/// The ADC hardware scans all enabled channels and stores the conversion
+/// results via DMA, the CPU is only involved once per conversion frame. Each
+/// frame is reduced to one block average per channel and the block averages
+/// are smoothed by a moving average over @ref FILTER_BLOCKS blocks. An input
+/// turns on when the filtered value reaches its on threshold and turns off
+/// when it drops to its off threshold, the gap between the two provides the
+/// hysteresis.
+///
+/// The level of an input is off until its filter has been filled after it
+/// was enabled, an input which is above its on threshold at that point
+/// publishes a transition.
+class AnalogInputEngine : public InputEngine, public StateFlowBase
+{
+public:
+    /// Value used in the channel table for inputs without an ADC1 channel.
+    static constexpr int8_t NO_CHANNEL = -1;
+
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service that will process the conversion
+    /// results.
+    /// @param channels is the array of ADC1 channels, the index into this
+    /// array is the input number, @ref NO_CHANNEL marks inputs without an
+    /// ADC1 channel.
+    /// @param count is the number of entries in @param channels.
+    AnalogInputEngine(Service *service, const int8_t *channels, size_t count)
+        : StateFlowBase(service)
+        , channels_(channels)
+        , count_(count)
+    {
+        HASSERT(count <= MAX_INPUTS);
+        std::fill(std::begin(inputs_), std::end(inputs_), NO_INPUT);
+        for (size_t index = 0; index < count_; index++)
+        {
+            if (channels_[index] != NO_CHANNEL)
+            {
+                HASSERT(channels_[index] < ADC_CHANNELS);
+                inputs_[channels_[index]] = index;
+            }
+        }
+    }
+
+    /// @param index is the input number.
+    /// @return true if the input can be used as an analog input.
+    bool supported(size_t index)
+    {
+        return index < count_ && channels_[index] != NO_CHANNEL;
+    }
+
+    /// Allocates the ADC driver, sampling starts once an input is enabled
+    /// via @ref configure.
+    ///
+    /// @return ESP_OK if the ADC driver was allocated, any other value
+    /// indicates failure.
+    esp_err_t hw_init()
+    {
+        adc_continuous_handle_cfg_t handle_config = {};
+        handle_config.max_store_buf_size = FRAME_SIZE * FRAME_BUFFERS;
+        handle_config.conv_frame_size = FRAME_SIZE;
+        esp_err_t res = adc_continuous_new_handle(&handle_config, &handle_);
+        if (res != ESP_OK)
+        {
+            LOG_ERROR("[Analog] Failed to allocate ADC driver: %s",
+                      esp_err_to_name(res));
+            handle_ = nullptr;
+            return res;
+        }
+        adc_continuous_evt_cbs_t callbacks = {};
+        callbacks.on_conv_done = frame_isr;
+        res = adc_continuous_register_event_callbacks(handle_, &callbacks,
+                                                      this);
+        if (res != ESP_OK)
+        {
+            LOG_ERROR("[Analog] Failed to register ADC callback: %s",
+                      esp_err_to_name(res));
+            return res;
+        }
+        start_flow(STATE(wait_for_frame));
+        return ESP_OK;
+    }
+
+    /// Enables or disables sampling of an input.
+    ///
+    /// @param index is the input number.
+    /// @param debounce_ms is not used, inputs are filtered by the moving
+    /// average instead.
+    /// @param enabled is true if the input should be sampled.
+    void configure(size_t index, uint16_t debounce_ms, bool enabled) override
+    {
+        if (!supported(index))
+        {
+            return;
+        }
+        bool wakeup = false;
+        portENTER_CRITICAL(&lock_);
+        uint32_t mask = 1U << index;
+        if (((enabled_ & mask) != 0) != enabled)
+        {
+            enabled_ ^= mask;
+            reconfigure_ = true;
+            if (waiting_)
+            {
+                waiting_ = false;
+                wakeup = true;
+            }
+        }
+        portEXIT_CRITICAL(&lock_);
+        if (!enabled)
+        {
+            set_level(index, false);
+        }
+        if (wakeup)
+        {
+            notify();
+        }
+    }
+
+    /// Sets the thresholds of an input.
+    ///
+    /// @param index is the input number.
+    /// @param on is the filtered ADC reading at or above which the input
+    /// turns on.
+    /// @param off is the filtered ADC reading at or below which the input
+    /// turns off.
+    void set_thresholds(size_t index, uint16_t on, uint16_t off)
+    {
+        if (!supported(index))
+        {
+            return;
+        }
+        Channel &channel = channelState_[channels_[index]];
+        portENTER_CRITICAL(&lock_);
+        channel.on = on;
+        // the off threshold must be below the on threshold to avoid the
+        // input toggling on every block.
+        channel.off = std::min<uint16_t>(off, on ? on - 1 : 0);
+        portEXIT_CRITICAL(&lock_);
+    }
+
+    /// @param index is the input number.
+    /// @return the current filtered ADC reading of the input.
+    uint16_t reading(size_t index)
+    {
+        if (!supported(index))
+        {
+            return 0;
+        }
+        const Channel &channel = channelState_[channels_[index]];
+        return channel.filled ? channel.total / channel.filled : 0;
+    }
+
+    /// @return number of conversion frames processed.
+    uint32_t frame_count()
+    {
+        return frames_;
+    }
+
+private:
+    /// Number of ADC1 channels.
+    static constexpr size_t ADC_CHANNELS = 8;
+
+    /// Value used in @ref inputs_ for channels without an input.
+    static constexpr uint8_t NO_INPUT = 0xFF;
+
+    /// Number of bytes per conversion frame, each conversion result is two
+    /// bytes.
+    static constexpr uint32_t FRAME_SIZE = 512;
+
+    /// Number of conversion frames buffered by the driver.
+    static constexpr uint32_t FRAME_BUFFERS = 4;
+
+    /// Total sampling frequency shared by all enabled channels, this is the
+    /// lowest frequency supported by the ESP32 in continuous mode.
+    static constexpr uint32_t SAMPLE_FREQ_HZ = 20000;
+
+    /// Number of block averages included in the moving average.
+    static constexpr size_t FILTER_BLOCKS = 16;
+
+    /// Per-channel filter state.
+    struct Channel
+    {
+        /// Sum of the samples in the current frame.
+        uint32_t blockSum;
+
+        /// Number of samples in the current frame.
+        uint32_t blockCount;
+
+        /// Block averages included in the moving average.
+        uint16_t blocks[FILTER_BLOCKS];
+
+        /// Sum of @ref blocks.
+        uint32_t total;
+
+        /// Index of the oldest entry in @ref blocks.
+        uint8_t next;
+
+        /// Number of valid entries in @ref blocks.
+        uint8_t filled;
+
+        /// Filtered reading at or above which the input turns on.
+        uint16_t on;
+
+        /// Filtered reading at or below which the input turns off.
+        uint16_t off;
+    };
+
+    /// ADC1 channel of each input.
+    const int8_t *channels_;
+
+    /// Number of inputs in @ref channels_.
+    const size_t count_;
+
+    /// Input number of each ADC1 channel.
+    uint8_t inputs_[ADC_CHANNELS];
+
+    /// Filter state of each ADC1 channel.
+    Channel channelState_[ADC_CHANNELS]{};
+
+    /// ADC continuous mode driver handle.
+    adc_continuous_handle_t handle_{nullptr};
+
+    /// Lock protecting the state shared with the interrupt handler and the
+    /// configuration updates.
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    /// Inputs which are enabled.
+    uint32_t enabled_{0};
+
+    /// True when the ADC needs to be reconfigured.
+    bool reconfigure_{false};
+
+    /// True when the ADC is sampling.
+    bool running_{false};
+
+    /// True when a conversion frame is ready to be read.
+    bool frameReady_{false};
+
+    /// True when the flow is waiting for a conversion frame or
+    /// reconfiguration.
+    bool waiting_{false};
+
+    /// Number of conversion frames processed.
+    uint32_t frames_{0};
+
+    /// Buffer for reading the conversion results.
+    uint8_t frame_[FRAME_SIZE];
+
+    /// ADC conversion frame done interrupt handler.
+    ///
+    /// @param handle is the ADC driver handle.
+    /// @param edata is the conversion event data.
+    /// @param ctx is the @ref AnalogInputEngine.
+    /// @return false as no task switch is requested from here.
+    static bool frame_isr(adc_continuous_handle_t handle,
+                          const adc_continuous_evt_data_t *edata, void *ctx)
+    {
+        AnalogInputEngine *engine = static_cast<AnalogInputEngine *>(ctx);
+        bool wakeup = false;
+        portENTER_CRITICAL_ISR(&engine->lock_);
+        engine->frameReady_ = true;
+        if (engine->waiting_)
+        {
+            engine->waiting_ = false;
+            wakeup = true;
+        }
+        portEXIT_CRITICAL_ISR(&engine->lock_);
+        if (wakeup)
+        {
+            engine->notify_from_isr();
+        }
+        return false;
+    }
+
+    /// Waits for the next conversion frame or configuration change.
+    Action wait_for_frame()
+    {
+        portENTER_CRITICAL(&lock_);
+        bool reconfigure = reconfigure_;
+        bool ready = frameReady_;
+        reconfigure_ = frameReady_ = false;
+        waiting_ = !reconfigure && !ready;
+        portEXIT_CRITICAL(&lock_);
+        if (reconfigure)
+        {
+            return call_immediately(STATE(apply_config));
+        }
+        if (!ready)
+        {
+            return wait_and_call(STATE(wait_for_frame));
+        }
+        return call_immediately(STATE(process_frames));
+    }
+
+    /// Restarts the ADC with the enabled inputs.
+    Action apply_config()
+    {
+        if (running_)
+        {
+            adc_continuous_stop(handle_);
+            running_ = false;
+        }
+        portENTER_CRITICAL(&lock_);
+        uint32_t enabled = enabled_;
+        portEXIT_CRITICAL(&lock_);
+
+        adc_digi_pattern_config_t patterns[ADC_CHANNELS];
+        adc_continuous_config_t config = {};
+        config.pattern_num = 0;
+        config.adc_pattern = patterns;
+        config.sample_freq_hz = SAMPLE_FREQ_HZ;
+        config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+        while (enabled)
+        {
+            size_t index = __builtin_ctz(enabled);
+            enabled &= ~(1U << index);
+            uint8_t channel = channels_[index];
+            Channel &state = channelState_[channel];
+            state.blockSum = state.blockCount = state.total = 0;
+            state.next = state.filled = 0;
+            adc_digi_pattern_config_t &pattern = patterns[config.pattern_num++];
+            pattern.atten = ADC_ATTEN_DB_12;
+            pattern.channel = channel;
+            pattern.unit = ADC_UNIT_1;
+            pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        }
+        if (config.pattern_num)
+        {
+            esp_err_t res = adc_continuous_config(handle_, &config);
+            if (res == ESP_OK)
+            {
+                res = adc_continuous_start(handle_);
+            }
+            if (res != ESP_OK)
+            {
+                LOG_ERROR("[Analog] Failed to start ADC: %s",
+                          esp_err_to_name(res));
+            }
+            else
+            {
+                running_ = true;
+                LOG(INFO, "[Analog] Sampling %" PRIu32 " channel(s)",
+                    config.pattern_num);
+            }
+        }
+        return call_immediately(STATE(wait_for_frame));
+    }
+
+    /// Processes all available conversion frames.
+    Action process_frames()
+    {
+        uint32_t changed = 0;
+        uint32_t levels = 0;
+        uint32_t length = 0;
+        while (running_ &&
+               adc_continuous_read(handle_, frame_, FRAME_SIZE, &length, 0) ==
+                   ESP_OK)
+        {
+            frames_++;
+            for (uint32_t offs = 0;
+                 offs + SOC_ADC_DIGI_RESULT_BYTES <= length;
+                 offs += SOC_ADC_DIGI_RESULT_BYTES)
+            {
+                const adc_digi_output_data_t *result =
+                    reinterpret_cast<const adc_digi_output_data_t *>(
+                        frame_ + offs);
+                uint8_t channel = result->type1.channel;
+                if (channel < ADC_CHANNELS)
+                {
+                    channelState_[channel].blockSum += result->type1.data;
+                    channelState_[channel].blockCount++;
+                }
+            }
+            end_block(&changed, &levels);
+        }
+        if (changed)
+        {
+            publish(changed, levels);
+        }
+        return call_immediately(STATE(wait_for_frame));
+    }
+
+    /// Adds the block average of each channel to its moving average and
+    /// checks the thresholds.
+    ///
+    /// @param changed collects the inputs which changed.
+    /// @param levels collects the new levels of the inputs.
+    void end_block(uint32_t *changed, uint32_t *levels)
+    {
+        for (size_t channel = 0; channel < ADC_CHANNELS; channel++)
+        {
+            Channel &state = channelState_[channel];
+            if (!state.blockCount || inputs_[channel] == NO_INPUT)
+            {
+                continue;
+            }
+            uint16_t average = state.blockSum / state.blockCount;
+            state.blockSum = state.blockCount = 0;
+            if (state.filled == FILTER_BLOCKS)
+            {
+                state.total -= state.blocks[state.next];
+            }
+            else
+            {
+                state.filled++;
+            }
+            state.blocks[state.next] = average;
+            state.total += average;
+            state.next = (state.next + 1) % FILTER_BLOCKS;
+            if (state.filled < FILTER_BLOCKS)
+            {
+                continue;
+            }
+            uint16_t filtered = state.total / FILTER_BLOCKS;
+            size_t index = inputs_[channel];
+            uint32_t mask = 1U << index;
+            bool current = (*changed & mask) ? (*levels & mask) : level(index);
+            portENTER_CRITICAL(&lock_);
+            bool on = !current && filtered >= state.on;
+            bool off = current && filtered <= state.off;
+            portEXIT_CRITICAL(&lock_);
+            if (on || off)
+            {
+                *changed ^= mask;
+                *levels = on ? (*levels | mask) : (*levels & ~mask);
+            }
+        }
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(AnalogInputEngine);
+};
+
+} // namespace esp32io
+
+#endif // ANALOG_INPUT_ENGINE_HXX_
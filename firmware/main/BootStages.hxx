@@ -0,0 +1,205 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file BootStages.hxx
+ *
+ * Timing and concurrent execution of the startup stages.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef BOOT_STAGES_HXX_
+#define BOOT_STAGES_HXX_
+
+#include <esp_timer.h>
+#include <freertos_includes.h>
+#include <functional>
+#include <inttypes.h>
+#include <os/OS.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <vector>
+
+#include "sdkconfig.h"
+#include "boot_trace.hxx"
+
+namespace esp32io
+{
+
+/// Logs the duration of each startup stage executed on the calling task.
+class BootStageTimer
+{
+public:
+    /// Constructor.
+    ///
+    /// @param group is the name of the group of stages, used for logging.
+    BootStageTimer(const char *group)
+        : group_(group)
+        , last_(esp_timer_get_time())
+    {
+    }
+
+    /// Records the completion of a stage in the boot trace, the duration is
+    /// measured from the completion of the previous stage (or construction of
+    /// this object).
+    ///
+    /// @param phase is the @ref BootPhase which has completed.
+    void done(BootPhase phase)
+    {
+        int64_t now = esp_timer_get_time();
+        boot_trace_record(phase);
+        LOG(INFO, "[Boot] %s/%s: %" PRId64 " usec (%" PRId64 " usec since "
+                  "reset)", group_, boot_trace_phase_name(phase), now - last_,
+            now);
+        last_ = now;
+    }
+
+private:
+    /// Name of the group of stages.
+    const char *group_;
+
+    /// Completion time of the previous stage.
+    int64_t last_;
+};
+
+/// Group of startup stages which do not depend on the OpenLCB IO path and
+/// can be run on the second core while the IO pins and TWAI are brought up.
+///
+/// When concurrent execution is disabled the stages are run in order on the
+/// calling task by @ref start.
+class BootStageGroup
+{
+public:
+    /// Function type for a stage.
+    typedef std::function<void()> Stage;
+
+    /// Constructor.
+    ///
+    /// @param name is the name of the group, used for the task name and
+    /// logging.
+    /// @param concurrent is true to run the stages in a dedicated task.
+    BootStageGroup(const char *name, bool concurrent)
+        : name_(name)
+        , concurrent_(concurrent)
+    {
+    }
+
+    /// Adds a stage to the group, this must be called before @ref start.
+    ///
+    /// @param phase is the @ref BootPhase recorded when the stage completes.
+    /// @param stage is the function to run.
+    void add(BootPhase phase, Stage stage)
+    {
+        HASSERT(!started_);
+        stages_.push_back({phase, std::move(stage)});
+    }
+
+    /// Starts running the stages.
+    void start()
+    {
+        HASSERT(!started_);
+        started_ = true;
+        if (!concurrent_ ||
+            xTaskCreatePinnedToCore(task_entry, name_,
+                                    CONFIG_BOOT_STAGE_STACK_SIZE, this,
+                                    uxTaskPriorityGet(NULL), nullptr,
+                                    CONFIG_BOOT_STAGE_CORE) != pdPASS)
+        {
+            run();
+            complete_ = true;
+        }
+    }
+
+    /// Waits for all stages to complete.
+    void join()
+    {
+        HASSERT(started_);
+        if (!complete_)
+        {
+            done_.wait();
+        }
+    }
+
+private:
+    /// Stage to run.
+    struct Entry
+    {
+        /// Phase recorded when the stage completes.
+        BootPhase phase;
+
+        /// Function to run.
+        Stage stage;
+    };
+
+    /// Name of the group.
+    const char *name_;
+
+    /// True if the stages should run in a dedicated task.
+    const bool concurrent_;
+
+    /// Stages to run, in order.
+    std::vector<Entry> stages_;
+
+    /// Posted once all stages have completed in the dedicated task.
+    OSSem done_;
+
+    /// True once @ref start has been called.
+    bool started_{false};
+
+    /// True when the stages were run by @ref start on the calling task.
+    bool complete_{false};
+
+    /// Runs all stages in order.
+    void run()
+    {
+        BootStageTimer timer(name_);
+        for (auto &entry : stages_)
+        {
+            entry.stage();
+            timer.done(entry.phase);
+        }
+        stages_.clear();
+    }
+
+    /// Entry point for the dedicated task.
+    ///
+    /// @param arg is the @ref BootStageGroup to run.
+    static void task_entry(void *arg)
+    {
+        BootStageGroup *group = static_cast<BootStageGroup *>(arg);
+        group->run();
+        group->done_.post();
+        vTaskDelete(nullptr);
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(BootStageGroup);
+};
+
+} // namespace esp32io
+
+#endif // BOOT_STAGES_HXX_
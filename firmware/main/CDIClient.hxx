@@ -32,11 +32,62 @@
  * @date 8 August 2021
  */
 
+#include <algorithm>
+#include <fcntl.h>
 #include <Httpd.h>
-#include <openlcb/MemoryConfigClient.hxx>
+#include <sdkconfig.h>
+#include <string.h>
+#include <unistd.h>
+#include <utils/ConfigUpdateService.hxx>
 #include <utils/StringPrintf.hxx>
 
+#include "alloc_counter.hxx"
+#include "RemoteConfigClient.hxx"
 #include "StringUtils.hxx"
+#include "WsProtocol.hxx"
+
+/// Maximum length of a field identifier, including the terminating null.
+static constexpr size_t CDI_TARGET_SIZE = 32;
+
+/// Maximum length of a field type, including the terminating null.
+static constexpr size_t CDI_TYPE_SIZE = 4;
+
+/// Largest field value, CDI strings are at most 64 bytes and event IDs are
+/// 8 bytes.
+static constexpr size_t CDI_VALUE_SIZE = 64;
+
+/// Maximum number of fields in a batched read.
+static constexpr size_t CDI_MAX_BATCH_FIELDS = 32;
+
+/// Copies a null terminated string into a fixed size buffer.
+///
+/// @param dst is the buffer to copy into.
+/// @param size is the size of @p dst.
+/// @param src is the string to copy.
+/// @return false if @p src was truncated.
+static inline bool cdi_copy(char *dst, size_t size, const char *src)
+{
+  return strlcpy(dst, src, size) < size;
+}
+
+/// Single field of a batched CDI read.
+struct CDIField
+{
+  size_t offs;
+  size_t size;
+  char target[CDI_TARGET_SIZE];
+  char type[CDI_TYPE_SIZE];
+  /// Position of the field in a binary batch request.
+  uint8_t index;
+};
+
+/// Fields of a batched CDI read, these are drawn from the fixed pool of the
+/// @ref CDIScheduler.
+struct CDIFieldBatch
+{
+  CDIField fields[CDI_MAX_BATCH_FIELDS];
+  size_t count;
+};
 
 struct CDIClientRequest : public CallableFlowRequestBase
 {
@@ -44,6 +95,11 @@ struct CDIClientRequest : public CallableFlowRequestBase
   {
     READ
   };
+
+  enum ReadBatchCmd
+  {
+    READ_BATCH
+  };
   
   enum WriteCmd
   {
@@ -56,52 +112,65 @@ struct CDIClientRequest : public CallableFlowRequestBase
   };
 
   void reset(ReadCmd, openlcb::NodeHandle target_node, http::WebSocketFlow *socket
-           , uint32_t req_id, size_t offs, size_t size, string target
-           , string type)
+           , uint32_t req_id, size_t offs, size_t size, const char *target
+           , const char *type)
   {
-    reset_base();
-    cmd = CMD_READ;
-    this->target_node = target_node;
-    this->socket = socket;
-    this->req_id = req_id;
+    reset_common(CMD_READ, target_node, socket, req_id, target);
     this->offs = offs;
     this->size = size;
-    this->target = target;
-    this->type = type;
-    value.clear();
+    cdi_copy(this->type, sizeof(this->type), type);
+  }
+
+  void reset(ReadBatchCmd, openlcb::NodeHandle target_node
+           , http::WebSocketFlow *socket, uint32_t req_id, const char *target
+           , CDIFieldBatch *batch)
+  {
+    reset_common(CMD_READ_BATCH, target_node, socket, req_id, target);
+    this->batch = batch;
   }
 
   void reset(WriteCmd, openlcb::NodeHandle target_node, http::WebSocketFlow *socket
-           , uint32_t req_id, size_t offs, size_t size, string target
-           , string value)
+           , uint32_t req_id, size_t offs, size_t size, const char *target
+           , const uint8_t *value, size_t value_len)
   {
-    reset_base();
-    cmd = CMD_WRITE;
-    this->target_node = target_node;
-    this->socket = socket;
-    this->req_id = req_id;
+    reset_common(CMD_WRITE, target_node, socket, req_id, target);
     this->offs = offs;
     this->size = size;
-    this->target = target;
-    type.clear();
-    this->value = std::move(value);
+    this->value_len = std::min(value_len, sizeof(this->value));
+    memcpy(this->value, value, this->value_len);
   }
 
   void reset(UpdateCompleteCmd, openlcb::NodeHandle target_node, http::WebSocketFlow *socket
            , uint32_t req_id)
   {
-    reset_base();
-    cmd = CMD_UPDATE_COMPLETE;
-    this->target_node = target_node;
-    this->socket = socket;
-    this->req_id = req_id;
-    type.clear();
-    value.clear();
+    reset_common(CMD_UPDATE_COMPLETE, target_node, socket, req_id, "");
+  }
+
+  /// Sends the response as a binary websocket frame, this must be called
+  /// after reset.
+  ///
+  /// @param opcode is the @ref esp32io::WsOpcode of the request.
+  /// @param tag is the identifier of the request.
+  void set_binary(uint8_t opcode, uint16_t tag)
+  {
+    binary = true;
+    this->opcode = opcode;
+    this->tag = tag;
+  }
+
+  /// Selects the memory space of the request, this must be called after
+  /// reset. Requests use the configuration space by default.
+  ///
+  /// @param space is the memory space to read from or write to.
+  void set_space(uint8_t space)
+  {
+    this->space = space;
   }
 
   enum Command : uint8_t
   {
       CMD_READ,
+      CMD_READ_BATCH,
       CMD_WRITE,
       CMD_UPDATE_COMPLETE
   };
@@ -112,25 +181,106 @@ struct CDIClientRequest : public CallableFlowRequestBase
   uint32_t req_id;
   size_t offs;
   size_t size;
-  string target;
-  string type;
-  string value;
+  char target[CDI_TARGET_SIZE];
+  char type[CDI_TYPE_SIZE];
+  uint8_t value[CDI_VALUE_SIZE];
+  size_t value_len;
+  CDIFieldBatch *batch;
+  /// Memory space of the request.
+  uint8_t space;
+  bool binary;
+  uint8_t opcode;
+  uint16_t tag;
+  /// Next request queued for the same node, used by @ref CDIScheduler.
+  Buffer<CDIClientRequest> *next;
+
+private:
+  void reset_common(Command cmd, openlcb::NodeHandle target_node
+                  , http::WebSocketFlow *socket, uint32_t req_id
+                  , const char *target)
+  {
+    reset_base();
+    this->cmd = cmd;
+    this->target_node = target_node;
+    this->socket = socket;
+    this->req_id = req_id;
+    cdi_copy(this->target, sizeof(this->target), target);
+    type[0] = '\0';
+    offs = 0;
+    size = 0;
+    value_len = 0;
+    batch = nullptr;
+    space = openlcb::MemoryConfigDefs::SPACE_CONFIG;
+    binary = false;
+    next = nullptr;
+  }
 };
 
 class CDIClient : public CallableFlow<CDIClientRequest>
 {
 public:
-  CDIClient(Service *service, openlcb::MemoryConfigClient *memory_client)
+  /// Constructor.
+  ///
+  /// @param service is the @ref Service to execute requests on.
+  /// @param memory_client is used for requests to remote nodes.
+  /// @param local_node is the @ref NodeID of this node, requests for it are
+  /// served directly from @p local_config.
+  /// @param local_config is the configuration file of this node.
+  /// @param local_fd is the handle for @p local_config, it is opened on
+  /// first use and may be shared by clients running on the same executor.
+  CDIClient(Service *service, esp32io::RemoteConfigClient *memory_client
+          , openlcb::NodeID local_node, const char *local_config
+          , int *local_fd)
           : CallableFlow<CDIClientRequest>(service), client_(memory_client)
+          , localNode_(local_node), localConfig_(local_config)
+          , localFd_(*local_fd)
   {
   }
 
 private:
-  openlcb::MemoryConfigClient *client_;
+  /// Maximum number of bytes requested in a single memory config read.
+  static constexpr size_t MAX_READ_SIZE = 64;
+
+  esp32io::RemoteConfigClient *client_;
+
+  /// @ref NodeID of this node.
+  openlcb::NodeID localNode_;
+
+  /// Configuration file of this node.
+  const char *localConfig_;
+
+  /// Handle for @ref localConfig_, opened on first use.
+  int &localFd_;
+
+  /// Index of the first field of the batched read in progress.
+  size_t batchIndex_;
+
+  /// Index one past the last field of the batched read in progress.
+  size_t batchEnd_;
+
+  /// Offset of the batched read in progress.
+  size_t batchOffs_;
+
+  /// JSON array of the fields decoded so far.
+  string batchResponse_;
+
+  /// Data read from the local configuration file.
+  uint8_t readBuf_[MAX_READ_SIZE];
+
+  /// Binary response being built.
+  uint8_t frame_[esp32io::WS_MAX_FRAME];
+
+  /// Number of bytes used in @ref frame_.
+  size_t frameLen_;
 
   StateFlowBase::Action entry() override
   {
+    esp32io::AllocCounterScope alloc_scope;
     request()->resultCode = openlcb::DatagramClient::OPERATION_PENDING;
+    if (request()->target_node.id == localNode_)
+    {
+      return local_request();
+    }
     switch (request()->cmd)
     {
       case CDIClientRequest::CMD_READ:
@@ -140,10 +290,12 @@ private:
           , uint64_to_string_hex(request()->target_node.id).c_str()
           , request()->offs);
         return invoke_subflow_and_wait(client_, STATE(read_complete)
-                                     , openlcb::MemoryConfigClientRequest::READ_PART
+                                     , esp32io::RemoteConfigRequest::READ_PART
                                      , request()->target_node
-                                     , openlcb::MemoryConfigDefs::SPACE_CONFIG
+                                     , request()->space
                                      , request()->offs, request()->size);
+      case CDIClientRequest::CMD_READ_BATCH:
+        return start_batch();
       case CDIClientRequest::CMD_WRITE:
         LOG(VERBOSE
           , "[CDI:%" PRIu32 "] Writing %zu bytes to %s at offset %zu"
@@ -151,141 +303,449 @@ private:
           , uint64_to_string_hex(request()->target_node.id).c_str()
           , request()->offs);
         return invoke_subflow_and_wait(client_, STATE(write_complete)
-                                     , openlcb::MemoryConfigClientRequest::WRITE
+                                     , esp32io::RemoteConfigRequest::WRITE
                                      , request()->target_node
-                                     , openlcb::MemoryConfigDefs::SPACE_CONFIG
-                                     , request()->offs, request()->value);
+                                     , request()->space
+                                     , request()->offs
+                                     , string((const char *)request()->value
+                                            , request()->value_len));
       case CDIClientRequest::CMD_UPDATE_COMPLETE:
         LOG(VERBOSE, "[CDI:%" PRIu32 "] Sending update-complete to %s"
           , request()->req_id
           , uint64_to_string_hex(request()->target_node.id).c_str());
         return invoke_subflow_and_wait(client_, STATE(update_complete)
-                                     , openlcb::MemoryConfigClientRequest::UPDATE_COMPLETE
+                                     , esp32io::RemoteConfigRequest::UPDATE_COMPLETE
                                      , request()->target_node);
     }
     return return_with_error(openlcb::Defs::ERROR_UNIMPLEMENTED_SUBCMD);
   }
 
+  /// Serves a request for this node directly from the configuration file
+  /// rather than looping a datagram back through the memory config server.
+  StateFlowBase::Action local_request()
+  {
+    if (localFd_ < 0)
+    {
+      localFd_ = ::open(localConfig_, O_RDWR);
+      if (localFd_ < 0)
+      {
+        LOG_ERROR("[CDI] Unable to open %s: %s", localConfig_
+                , strerror(errno));
+        return send_error(openlcb::Defs::ERROR_PERMANENT);
+      }
+    }
+    // The ACDI user data is stored at the start of the configuration file
+    // so both spaces use the address as the file offset.
+    if (request()->cmd != CDIClientRequest::CMD_UPDATE_COMPLETE &&
+        request()->space != openlcb::MemoryConfigDefs::SPACE_CONFIG &&
+        request()->space != openlcb::MemoryConfigDefs::SPACE_ACDI_USR)
+    {
+      LOG_ERROR("[CDI:%" PRIu32 "] Unsupported local memory space: %02x"
+              , request()->req_id, request()->space);
+      return send_error(openlcb::Defs::ERROR_INVALID_ARGS);
+    }
+    switch (request()->cmd)
+    {
+      case CDIClientRequest::CMD_READ:
+      {
+        LOG(VERBOSE, "[CDI:%" PRIu32 "] Reading %zu local bytes at offset %zu"
+          , request()->req_id, request()->size, request()->offs);
+        size_t len = 0;
+        int code = local_read(request()->offs
+                            , std::min(request()->size, sizeof(readBuf_))
+                            , &len);
+        return send_field(code, readBuf_, len);
+      }
+      case CDIClientRequest::CMD_READ_BATCH:
+        return start_batch();
+      case CDIClientRequest::CMD_WRITE:
+      {
+        LOG(VERBOSE, "[CDI:%" PRIu32 "] Writing %zu local bytes at offset %zu"
+          , request()->req_id, request()->value_len, request()->offs);
+        int code = openlcb::Defs::ERROR_PERMANENT;
+        if (lseek(localFd_, request()->offs, SEEK_SET) ==
+              (off_t)request()->offs &&
+            ::write(localFd_, request()->value, request()->value_len) ==
+              (ssize_t)request()->value_len)
+        {
+          code = 0;
+#if !CONFIG_OLCB_CONFIG_CACHE
+          // The memory config server reads through its own handle, this
+          // makes the new value visible to it.
+          fsync(localFd_);
+#endif // !CONFIG_OLCB_CONFIG_CACHE
+        }
+        return send_saved(code);
+      }
+      case CDIClientRequest::CMD_UPDATE_COMPLETE:
+        LOG(VERBOSE, "[CDI:%" PRIu32 "] Triggering local config update"
+          , request()->req_id);
+        ConfigUpdateService::instance()->trigger_update();
+        return send_update_complete(0);
+    }
+    return return_with_error(openlcb::Defs::ERROR_UNIMPLEMENTED_SUBCMD);
+  }
+
+  /// Reads from the configuration file of this node into @ref readBuf_.
+  ///
+  /// @param offs is the offset to read from.
+  /// @param size is the number of bytes to read, at most
+  /// @ref MAX_READ_SIZE.
+  /// @param len receives the number of bytes read.
+  /// @return zero on success, otherwise an OpenLCB error code.
+  int local_read(size_t offs, size_t size, size_t *len)
+  {
+    if (lseek(localFd_, offs, SEEK_SET) != (off_t)offs)
+    {
+      return openlcb::MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+    }
+    ssize_t count = ::read(localFd_, readBuf_, size);
+    if (count < 0)
+    {
+      return openlcb::Defs::ERROR_PERMANENT;
+    }
+    else if (count == 0 && size)
+    {
+      return openlcb::MemoryConfigDefs::ERROR_OUT_OF_BOUNDS;
+    }
+    *len = count;
+    return 0;
+  }
+
   StateFlowBase::Action read_complete()
   {
+    esp32io::AllocCounterScope alloc_scope;
     auto b = get_buffer_deleter(full_allocation_result(client_));
     LOG(VERBOSE, "[CDI:%" PRIu32 "] read bytes request returned with code: %d"
       , request()->req_id, b->data()->resultCode);
-    string response;
-    if (b->data()->resultCode)
+    return send_field(b->data()->resultCode
+                    , (const uint8_t *)b->data()->payload.data()
+                    , b->data()->payload.size());
+  }
+
+  /// Sends the result of a single field read.
+  ///
+  /// @param code is the result of the read.
+  /// @param data is the data read.
+  /// @param len is the number of bytes read.
+  StateFlowBase::Action send_field(int code, const uint8_t *data, size_t len)
+  {
+    if (code)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] non-zero result code, sending error response."
-        , request()->req_id);
-      response =
-        StringPrintf(
-          R"!^!({"res":"error","error":"request failed: %d","id":%)!^!" PRIu32 "}"
-        , b->data()->resultCode, request()->req_id);
+      return send_error(code);
     }
-    else
+    LOG(VERBOSE, "[CDI:%" PRIu32 "] Received %zu bytes from offset %zu"
+      , request()->req_id, request()->size, request()->offs);
+    if (request()->binary)
+    {
+      send_binary(0, data, std::min(len, request()->size));
+      return return_ok();
+    }
+    string response =
+      StringPrintf(R"!^!({"res":"field",%s,"id":%)!^!" PRIu32 "}"
+                 , field_json(request()->target, request()->type
+                            , request()->size, data, len).c_str()
+                 , request()->req_id);
+    LOG(VERBOSE, "[CDI-READ] %s", response.c_str());
+    send_json(response);
+    return return_ok();
+  }
+
+  /// Sends an error response for the current request.
+  ///
+  /// @param code is the result of the request.
+  StateFlowBase::Action send_error(int code)
+  {
+    LOG(VERBOSE, "[CDI:%" PRIu32 "] non-zero result code, sending error response."
+      , request()->req_id);
+    if (request()->binary)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] Received %zu bytes from offset %zu"
-        , request()->req_id, request()->size, request()->offs);
-      if (request()->type == "str")
+      send_binary(code);
+      return return_with_error(code);
+    }
+    string response =
+      StringPrintf(
+        R"!^!({"res":"error","error":"request failed: %d","id":%)!^!" PRIu32 "}"
+      , code, request()->req_id);
+    send_json(response);
+    return return_with_error(code);
+  }
+
+  /// Sends a JSON response for the current request.
+  ///
+  /// @param response is the response to send.
+  void send_json(string &response)
+  {
+    // The web server allocates its own copy of the response.
+    esp32io::AllocCounterScope pause(false);
+    request()->socket->send_text(response);
+  }
+
+  /// Sends the binary response in @ref frame_.
+  void send_frame()
+  {
+    // The web server allocates its own copy of the response.
+    esp32io::AllocCounterScope pause(false);
+    request()->socket->send_binary(frame_, frameLen_);
+  }
+
+  /// Sends a binary response for the current request.
+  ///
+  /// @param code is the result of the request.
+  /// @param body is the data following the response header.
+  /// @param len is the length of @p body.
+  void send_binary(int code, const uint8_t *body = nullptr, size_t len = 0)
+  {
+    frameLen_ = esp32io::ws_encode_response(request()->opcode, request()->tag
+                                          , code, frame_);
+    len = std::min(len, sizeof(frame_) - frameLen_);
+    if (len)
+    {
+      memcpy(frame_ + frameLen_, body, len);
+      frameLen_ += len;
+    }
+    send_frame();
+  }
+
+  /// Decodes a field from the data read from the node.
+  ///
+  /// @param target is the field identifier.
+  /// @param type is the type of the field (str, int or evt).
+  /// @param size is the size of the field.
+  /// @param data is the start of the field data.
+  /// @param available is the number of bytes available at @p data.
+  /// @return JSON members (tgt, val and type) for the field.
+  string field_json(const char *target, const char *type, size_t size
+                  , const uint8_t *data, size_t available)
+  {
+    size = std::min(size, available);
+    string value;
+    if (!strcmp(type, "str"))
+    {
+      string payload((const char *)data, size);
+      remove_nulls_and_FF(payload);
+      value = base64_encode(payload);
+    }
+    else if (!strcmp(type, "int"))
+    {
+      uint32_t data32 = size ? data[0] : 0;
+      if (size == 2)
       {
-        remove_nulls_and_FF(b->data()->payload);
-        response =
-          StringPrintf(
-              R"!^!({"res":"field","tgt":"%s","val":"%s","type":"%s","id":%)!^!" PRIu32 "}"
-            , request()->target.c_str(), base64_encode(b->data()->payload).c_str()
-            , request()->type.c_str(), request()->req_id);
+        uint16_t data16 = 0;
+        memcpy(&data16, data, sizeof(uint16_t));
+        data32 = be16toh(data16);
       }
-      else if (request()->type == "int")
+      else if (size == 4)
       {
-        uint32_t data = b->data()->payload.data()[0];
-        if (request()->size == 2)
-        {
-          uint16_t data16 = 0;
-          memcpy(&data16, b->data()->payload.data(), sizeof(uint16_t));
-          data = be16toh(data16);
-        }
-        else if (request()->size == 4)
-        {
-          uint32_t data32 = 0;
-          memcpy(&data32, b->data()->payload.data(), sizeof(uint32_t));
-          data = be32toh(data32);
-        }
-        response =
-          StringPrintf(
-              R"!^!({"res":"field","tgt":"%s","val":"%)!^!" PRIu32 R"!^!(","type":"%s","id":%)!^!" PRIu32 "}"
-          , request()->target.c_str(), data, request()->type.c_str()
+        memcpy(&data32, data, sizeof(uint32_t));
+        data32 = be32toh(data32);
+      }
+      value = StringPrintf("%" PRIu32, data32);
+    }
+    else if (!strcmp(type, "evt"))
+    {
+      uint64_t event_id = 0;
+      memcpy(&event_id, data, std::min(size, sizeof(uint64_t)));
+      value = uint64_to_string_hex(be64toh(event_id));
+    }
+    return StringPrintf(R"!^!("tgt":"%s","val":"%s","type":"%s")!^!"
+                      , target, value.c_str(), type);
+  }
+
+  /// Starts a batched read, fields are read in offset order so that
+  /// neighbouring fields can be retrieved with a single read.
+  StateFlowBase::Action start_batch()
+  {
+    CDIFieldBatch *batch = request()->batch;
+    std::sort(batch->fields, batch->fields + batch->count
+            , [](const CDIField &a, const CDIField &b)
+              {
+                return a.offs < b.offs;
+              });
+    batchIndex_ = 0;
+    if (request()->binary)
+    {
+      // The count of fields is filled in once all fields have been read.
+      frameLen_ = esp32io::ws_encode_response(request()->opcode
+                                            , request()->tag, 0, frame_);
+      frame_[frameLen_++] = 0;
+    }
+    else
+    {
+      batchResponse_ = "[";
+    }
+    return call_immediately(STATE(batch_read_next));
+  }
+
+  /// Requests the next group of fields of a batched read, fields are grouped
+  /// as long as the combined range fits in a single read.
+  StateFlowBase::Action batch_read_next()
+  {
+    esp32io::AllocCounterScope alloc_scope;
+    const CDIField *fields = request()->batch->fields;
+    const size_t count = request()->batch->count;
+    if (batchIndex_ >= count && request()->binary)
+    {
+      frame_[sizeof(esp32io::WsFrameHeader) +
+             sizeof(esp32io::WsResponseHeader)] = count;
+      send_frame();
+      return return_ok();
+    }
+    else if (batchIndex_ >= count)
+    {
+      batchResponse_ += "]";
+      string response =
+        StringPrintf(
+            R"!^!({"res":"fields","tgt":"%s","fields":%s,"id":%)!^!" PRIu32 "}"
+          , request()->target, batchResponse_.c_str()
           , request()->req_id);
+      batchResponse_.clear();
+      LOG(VERBOSE, "[CDI-READ-BATCH] %s", response.c_str());
+      send_json(response);
+      return return_ok();
+    }
+    batchOffs_ = fields[batchIndex_].offs;
+    size_t end = batchOffs_ + fields[batchIndex_].size;
+    batchEnd_ = batchIndex_ + 1;
+    while (batchEnd_ < count &&
+           std::max(end, fields[batchEnd_].offs + fields[batchEnd_].size) -
+             batchOffs_ <= MAX_READ_SIZE)
+    {
+      end = std::max(end, fields[batchEnd_].offs + fields[batchEnd_].size);
+      batchEnd_++;
+    }
+    LOG(VERBOSE
+      , "[CDI:%" PRIu32 "] Requesting %zu bytes (%zu fields) from %s at "
+        "offset %zu", request()->req_id, end - batchOffs_
+      , batchEnd_ - batchIndex_
+      , uint64_to_string_hex(request()->target_node.id).c_str(), batchOffs_);
+    if (request()->target_node.id == localNode_)
+    {
+      size_t len = 0;
+      int code = local_read(batchOffs_, end - batchOffs_, &len);
+      return batch_decode(code, readBuf_, len);
+    }
+    return invoke_subflow_and_wait(client_, STATE(batch_read_complete)
+                                 , esp32io::RemoteConfigRequest::READ_PART
+                                 , request()->target_node
+                                 , request()->space
+                                 , batchOffs_, end - batchOffs_);
+  }
+
+  StateFlowBase::Action batch_read_complete()
+  {
+    esp32io::AllocCounterScope alloc_scope;
+    auto b = get_buffer_deleter(full_allocation_result(client_));
+    return batch_decode(b->data()->resultCode
+                      , (const uint8_t *)b->data()->payload.data()
+                      , b->data()->payload.size());
+  }
+
+  /// Decodes the fields of the completed group of a batched read.
+  ///
+  /// @param code is the result of the read.
+  /// @param data is the data read for the group.
+  /// @param len is the number of bytes read.
+  StateFlowBase::Action batch_decode(int code, const uint8_t *data, size_t len)
+  {
+    if (code)
+    {
+      LOG(VERBOSE, "[CDI:%" PRIu32 "] batch read failed: %d"
+        , request()->req_id, code);
+      batchResponse_.clear();
+      return send_error(code);
+    }
+    for (; batchIndex_ < batchEnd_; batchIndex_++)
+    {
+      const CDIField &field = request()->batch->fields[batchIndex_];
+      size_t start = std::min(field.offs - batchOffs_, len);
+      if (request()->binary)
+      {
+        size_t size = std::min(field.size, len - start);
+        size = std::min(size, sizeof(frame_) - frameLen_ - 2);
+        frame_[frameLen_++] = field.index;
+        frame_[frameLen_++] = size;
+        memcpy(frame_ + frameLen_, data + start, size);
+        frameLen_ += size;
+        continue;
       }
-      else if (request()->type == "evt")
+      if (batchResponse_.size() > 1)
       {
-        uint64_t event_id = 0;
-        memcpy(&event_id, b->data()->payload.data(), sizeof(uint64_t));
-        response =
-          StringPrintf(
-              R"!^!({"res":"field","tgt":"%s","val":"%s","type":"%s","id":%)!^!" PRIu32 "}"
-          , request()->target.c_str()
-          , uint64_to_string_hex(be64toh(event_id)).c_str()
-          , request()->type.c_str(), request()->req_id);
+        batchResponse_ += ",";
       }
+      batchResponse_ += "{";
+      batchResponse_ +=
+        field_json(field.target, field.type, field.size, data + start
+                 , len - start);
+      batchResponse_ += "}";
     }
-    LOG(VERBOSE, "[CDI-READ] %s", response.c_str());
-    request()->socket->send_text(response);
-    return return_with_error(b->data()->resultCode);
+    return call_immediately(STATE(batch_read_next));
   }
 
   StateFlowBase::Action write_complete()
   {
+    esp32io::AllocCounterScope alloc_scope;
     auto b = get_buffer_deleter(full_allocation_result(client_));
     LOG(VERBOSE, "[CDI:%" PRIu32 "] write bytes request returned with code: %d"
       , request()->req_id, b->data()->resultCode);
-    string response;
-    if (b->data()->resultCode)
+    return send_saved(b->data()->resultCode);
+  }
+
+  /// Sends the result of a write request.
+  ///
+  /// @param code is the result of the write.
+  StateFlowBase::Action send_saved(int code)
+  {
+    if (code)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] non-zero result code, sending error response."
-        , request()->req_id);
-      response =
-          StringPrintf(
-              R"!^!({"res":"error","error":"request failed: %d","id":%)!^!" PRIu32 "}"
-            , b->data()->resultCode, request()->req_id);
+      return send_error(code);
     }
-    else
+    LOG(VERBOSE, "[CDI:%" PRIu32 "] Write request processed successfully."
+      , request()->req_id);
+    if (request()->binary)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] Write request processed successfully."
-        , request()->req_id);
-      response =
-        StringPrintf(R"!^!({"res":"saved","tgt":"%s","id":%)!^!" PRIu32 "}"
-                    , request()->target.c_str(), request()->req_id);
+      send_binary(0);
+      return return_ok();
     }
+    string response =
+      StringPrintf(R"!^!({"res":"saved","tgt":"%s","id":%)!^!" PRIu32 "}"
+                  , request()->target, request()->req_id);
     LOG(VERBOSE, "[CDI-WRITE] %s", response.c_str());
-    request()->socket->send_text(response);
-    return return_with_error(b->data()->resultCode);
+    send_json(response);
+    return return_ok();
   }
 
   StateFlowBase::Action update_complete()
   {
+    esp32io::AllocCounterScope alloc_scope;
     auto b = get_buffer_deleter(full_allocation_result(client_));
     LOG(VERBOSE, "[CDI:%" PRIu32 "] update-complete request returned with code: %d"
       , request()->req_id, b->data()->resultCode);
-    string response;
-    if (b->data()->resultCode)
+    return send_update_complete(b->data()->resultCode);
+  }
+
+  /// Sends the result of an update-complete request.
+  ///
+  /// @param code is the result of the request.
+  StateFlowBase::Action send_update_complete(int code)
+  {
+    if (code)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] non-zero result code, sending error response."
-        , request()->req_id);
-      response =
-        StringPrintf(
-            R"!^!({"res":"error","error":"request failed: %d","id":%)!^!" PRIu32 "}"
-          , b->data()->resultCode, request()->req_id);
+      return send_error(code);
     }
-    else
+    LOG(VERBOSE, "[CDI:%" PRIu32 "] update-complete request processed successfully."
+      , request()->req_id);
+    if (request()->binary)
     {
-      LOG(VERBOSE, "[CDI:%" PRIu32 "] update-complete request processed successfully."
-        , request()->req_id);
-      response =
-        StringPrintf(R"!^!({"res":"update-complete","id":%)!^!" PRIu32 "}"
-                   , request()->req_id);
+      send_binary(0);
+      return return_ok();
     }
+    string response =
+      StringPrintf(R"!^!({"res":"update-complete","id":%)!^!" PRIu32 "}"
+                 , request()->req_id);
     LOG(VERBOSE, "[CDI-UPDATE-COMPLETE] %s", response.c_str());
-    request()->socket->send_text(response);
-    return return_with_error(b->data()->resultCode);
+    send_json(response);
+    return return_ok();
   }
 
 };
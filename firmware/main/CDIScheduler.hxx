@@ -0,0 +1,431 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file CDIScheduler.hxx
+ *
+ * Schedules CDI requests across several CDIClient flows so that requests for
+ * different nodes are processed in parallel.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CDI_SCHEDULER_HXX_
+#define CDI_SCHEDULER_HXX_
+
+#include "alloc_counter.hxx"
+#include "CDIClient.hxx"
+#include "RemoteConfigClient.hxx"
+
+#include <map>
+#include <memory>
+#include <os/OS.hxx>
+#include <unistd.h>
+#include <utils/logging.h>
+#include <utils/StringPrintf.hxx>
+#include <vector>
+
+/// Distributes @ref CDIClientRequest across a fixed set of @ref CDIClient
+/// flows. Requests for a single node are processed in order.
+///
+/// Requests for the local node are served from the configuration file and
+/// run in parallel with at most @ref nodeWindow_ in flight. Each client has
+/// its own @ref esp32io::RemoteConfigClient for remote nodes, the replies are
+/// matched to the client by the node that sent them so only one request per
+/// remote node is in flight while different remote nodes are served in
+/// parallel.
+///
+/// Requests and batch field lists are drawn from fixed pools which are
+/// allocated when the scheduler is created, once a node has been seen no
+/// heap allocations are made for scheduling a request.
+///
+/// NOTE: The scheduler owns the done notifiable of all requests sent to it.
+class CDIScheduler
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service to execute the clients on.
+    /// @param node is the local node used for memory config requests.
+    /// @param dg_service is the datagram service of @p node.
+    /// @param memcfg is the memory config handler of @p node.
+    /// @param local_config is the configuration file of @p node.
+    /// @param workers is the maximum number of requests in flight.
+    /// @param node_window is the maximum number of requests in flight for
+    /// @p node.
+    /// @param requests is the number of requests in the pool.
+    /// @param batches is the number of batch field lists in the pool.
+    CDIScheduler(Service *service, openlcb::Node *node
+               , openlcb::DatagramService *dg_service
+               , openlcb::MemoryConfigHandler *memcfg
+               , const char *local_config, size_t workers
+               , size_t node_window, size_t requests, size_t batches)
+        : nodeWindow_(node_window), localNode_(node->node_id())
+        , router_(node, dg_service, memcfg)
+        , batches_(new CDIFieldBatch[batches])
+    {
+        for (size_t idx = 0; idx < workers; idx++)
+        {
+            workers_.emplace_back(
+                new Worker(this, service, &router_, node, dg_service
+                         , local_config, &localFd_));
+        }
+        // The pool keeps a reference to every request so that the buffers
+        // are not returned to the buffer pool when the clients release them.
+        freeRequests_.reserve(requests);
+        for (size_t idx = 0; idx < requests; idx++)
+        {
+            Buffer<CDIClientRequest> *b;
+            mainBufferPool->alloc(&b);
+            freeRequests_.push_back(b);
+        }
+        freeBatches_.reserve(batches);
+        for (size_t idx = 0; idx < batches; idx++)
+        {
+            freeBatches_.push_back(&batches_[idx]);
+        }
+        poolSize_ = requests;
+    }
+
+    ~CDIScheduler()
+    {
+        for (auto *b : freeRequests_)
+        {
+            b->unref();
+        }
+        if (localFd_ >= 0)
+        {
+            ::close(localFd_);
+        }
+    }
+
+    /// @return a request from the pool or nullptr if all requests are in
+    /// use, the request must be passed to @ref send.
+    Buffer<CDIClientRequest> *alloc()
+    {
+        OSMutexLock l(&lock_);
+        if (freeRequests_.empty())
+        {
+            exhausted_++;
+            return nullptr;
+        }
+        Buffer<CDIClientRequest> *b = freeRequests_.back();
+        freeRequests_.pop_back();
+        return b;
+    }
+
+    /// @return a batch field list from the pool or nullptr if all are in
+    /// use, this must be attached to a request passed to @ref send.
+    CDIFieldBatch *alloc_batch()
+    {
+        OSMutexLock l(&lock_);
+        if (freeBatches_.empty())
+        {
+            exhausted_++;
+            return nullptr;
+        }
+        CDIFieldBatch *batch = freeBatches_.back();
+        freeBatches_.pop_back();
+        batch->count = 0;
+        return batch;
+    }
+
+    /// Returns a request from @ref alloc which will not be sent.
+    ///
+    /// @param b is the request to return.
+    void release(Buffer<CDIClientRequest> *b)
+    {
+        OSMutexLock l(&lock_);
+        recycle(b);
+    }
+
+    /// Queues a request from @ref alloc.
+    ///
+    /// @param b is the request to process.
+    void send(Buffer<CDIClientRequest> *b)
+    {
+        esp32io::AllocCounterScope alloc_scope;
+        OSMutexLock l(&lock_);
+        NodeState &state = nodes_[b->data()->target_node.id];
+        b->data()->next = nullptr;
+        if (state.tail)
+        {
+            state.tail->data()->next = b;
+        }
+        else
+        {
+            state.head = b;
+        }
+        state.tail = b;
+        state.queued++;
+        queued_++;
+        dispatch();
+    }
+
+    /// @return JSON statistics for the websocket "cdi-stats" request.
+    string stats()
+    {
+        OSMutexLock l(&lock_);
+        string nodes = "[";
+        for (auto &entry : nodes_)
+        {
+            const NodeState &state = entry.second;
+            if (nodes.size() > 1)
+            {
+                nodes += ",";
+            }
+            nodes += StringPrintf(
+                R"!^!({"node":"%s","queued":%" PRIu32 ",)!^!"
+                R"!^!("in_flight":%" PRIu32 ",)!^!"
+                R"!^!("requests":%" PRIu32 ","last_usec":%" PRIu32 ",)!^!"
+                R"!^!("avg_usec":%" PRIu32 ",)!^!"
+                R"!^!("max_usec":%" PRIu32 "})!^!"
+              , uint64_to_string_hex(entry.first, 12).c_str()
+              , state.queued, state.inFlight, state.requests
+              , state.lastUsec
+              , state.requests ? (uint32_t)(state.totalUsec / state.requests)
+                               : 0
+              , state.maxUsec);
+        }
+        nodes += "]";
+        return StringPrintf(
+            R"!^!({"res":"cdi-stats","workers":%zu,"window":%zu,)!^!"
+            R"!^!("pool":%zu,"pool_free":%zu,"batch_free":%zu,)!^!"
+            R"!^!("exhausted":%" PRIu32 ",)!^!"
+#if CONFIG_WS_ALLOC_COUNTER
+            R"!^!("allocs":%" PRIu32 ",)!^!"
+#endif // CONFIG_WS_ALLOC_COUNTER
+            R"!^!("queued":%zu,"in_flight":%zu,"remote_in_flight":%zu,)!^!"
+            R"!^!("remote_peak":%zu,"nodes":%s})!^!"
+          , workers_.size(), nodeWindow_, poolSize_, freeRequests_.size()
+          , freeBatches_.size(), exhausted_
+#if CONFIG_WS_ALLOC_COUNTER
+          , esp32io::alloc_count()
+#endif // CONFIG_WS_ALLOC_COUNTER
+          , queued_, inFlight_, remoteInFlight_, remotePeak_
+          , nodes.c_str());
+    }
+
+private:
+    /// A @ref CDIClient and the request it is processing.
+    class Worker : public Notifiable
+    {
+    public:
+        Worker(CDIScheduler *parent, Service *service
+             , esp32io::RemoteConfigRouter *router, openlcb::Node *node
+             , openlcb::DatagramService *dg_service
+             , const char *local_config, int *local_fd)
+            : parent_(parent)
+            , remote_(router, node, dg_service)
+            , client_(service, &remote_, node->node_id(), local_config
+                    , local_fd)
+        {
+        }
+
+        /// Called when the request in flight has completed.
+        void notify() override
+        {
+            parent_->complete(this);
+        }
+
+        CDIScheduler *parent_;
+
+        /// Memory config client for requests to remote nodes.
+        esp32io::RemoteConfigClient remote_;
+
+        CDIClient client_;
+
+        /// Target node of the request in flight.
+        openlcb::NodeID node_{0};
+
+        /// Request in flight.
+        Buffer<CDIClientRequest> *request_{nullptr};
+
+        /// Time the request in flight was started.
+        long long start_{0};
+
+        /// True when a request is in flight.
+        bool busy_{false};
+    };
+
+    /// Pending requests and latency statistics for a single node.
+    struct NodeState
+    {
+        /// First queued request, these are linked through
+        /// @ref CDIClientRequest::next.
+        Buffer<CDIClientRequest> *head{nullptr};
+
+        /// Last queued request.
+        Buffer<CDIClientRequest> *tail{nullptr};
+
+        uint32_t queued{0};
+        uint32_t inFlight{0};
+        uint32_t requests{0};
+        uint64_t totalUsec{0};
+        uint32_t lastUsec{0};
+        uint32_t maxUsec{0};
+    };
+
+    /// Maximum number of requests in flight for the local node.
+    const size_t nodeWindow_;
+
+    /// @ref openlcb::NodeID of the local node.
+    const openlcb::NodeID localNode_;
+
+    /// Routes memory config replies to the client waiting for them.
+    esp32io::RemoteConfigRouter router_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    /// Storage for the batch field list pool.
+    std::unique_ptr<CDIFieldBatch[]> batches_;
+
+    /// Requests which are not in use.
+    std::vector<Buffer<CDIClientRequest> *> freeRequests_;
+
+    /// Batch field lists which are not in use.
+    std::vector<CDIFieldBatch *> freeBatches_;
+
+    /// Number of requests in the pool.
+    size_t poolSize_;
+
+    /// Number of requests rejected because the pool was exhausted.
+    uint32_t exhausted_{0};
+
+    /// Pending requests and statistics by node.
+    std::map<openlcb::NodeID, NodeState> nodes_;
+
+    /// Protects the queues and statistics.
+    OSMutex lock_;
+
+    /// Number of requests waiting for a client.
+    size_t queued_{0};
+
+    /// Number of requests in flight.
+    size_t inFlight_{0};
+
+    /// Number of remote nodes with a request in flight.
+    size_t remoteInFlight_{0};
+
+    /// Largest number of remote nodes with a request in flight at once.
+    size_t remotePeak_{0};
+
+    /// Handle for the local configuration file, shared by all clients.
+    int localFd_{-1};
+
+    /// Starts queued requests on idle clients, @ref lock_ must be held.
+    void dispatch()
+    {
+        for (auto &worker : workers_)
+        {
+            if (!queued_)
+            {
+                return;
+            }
+            if (worker->busy_)
+            {
+                continue;
+            }
+            // Nodes are picked in node ID order, the local node can hold up
+            // to nodeWindow_ clients and each remote node one client.
+            for (auto &entry : nodes_)
+            {
+                NodeState &state = entry.second;
+                bool remote = entry.first != localNode_;
+                if (!state.head ||
+                    state.inFlight >= (remote ? 1 : nodeWindow_))
+                {
+                    continue;
+                }
+                if (remote)
+                {
+                    remoteInFlight_++;
+                    remotePeak_ = std::max(remotePeak_, remoteInFlight_);
+                }
+                Buffer<CDIClientRequest> *b = state.head;
+                state.head = b->data()->next;
+                if (!state.head)
+                {
+                    state.tail = nullptr;
+                }
+                state.queued--;
+                state.inFlight++;
+                queued_--;
+                inFlight_++;
+                worker->busy_ = true;
+                worker->node_ = entry.first;
+                worker->start_ = os_get_time_monotonic();
+                worker->request_ = b;
+                b->data()->done.reset(worker.get());
+                worker->client_.send(b->ref());
+                break;
+            }
+        }
+    }
+
+    /// Records the completion of a request and starts the next one.
+    ///
+    /// @param worker is the client that completed its request.
+    void complete(Worker *worker)
+    {
+        esp32io::AllocCounterScope alloc_scope;
+        OSMutexLock l(&lock_);
+        NodeState &state = nodes_[worker->node_];
+        uint32_t usec =
+            NSEC_TO_USEC(os_get_time_monotonic() - worker->start_);
+        state.inFlight--;
+        state.requests++;
+        state.totalUsec += usec;
+        state.lastUsec = usec;
+        state.maxUsec = std::max(state.maxUsec, usec);
+        inFlight_--;
+        if (worker->node_ != localNode_)
+        {
+            remoteInFlight_--;
+        }
+        worker->busy_ = false;
+        recycle(worker->request_);
+        worker->request_ = nullptr;
+        dispatch();
+    }
+
+    /// Returns a request and its batch field list to the pools, @ref lock_
+    /// must be held.
+    ///
+    /// @param b is the request to return.
+    void recycle(Buffer<CDIClientRequest> *b)
+    {
+        if (b->data()->batch)
+        {
+            freeBatches_.push_back(b->data()->batch);
+            b->data()->batch = nullptr;
+        }
+        freeRequests_.push_back(b);
+    }
+};
+
+#endif // CDI_SCHEDULER_HXX_
@@ -0,0 +1,319 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ConfigBackup.hxx
+ *
+ * Backup and restore of the node configuration as a single binary image.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CONFIG_BACKUP_HXX_
+#define CONFIG_BACKUP_HXX_
+
+#include "nvs_config.hxx"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+
+namespace esp32io
+{
+
+/// Header of a configuration backup image, this is followed by the content
+/// of the configuration file and (optionally) the @ref node_config_t.
+struct ConfigBackupHeader
+{
+    /// Set to @ref MAGIC.
+    uint32_t magic;
+
+    /// Version of the backup format.
+    uint16_t format;
+
+    /// CDI version of the configuration file.
+    uint16_t cdi_version;
+
+    /// Size of the configuration file.
+    uint32_t config_size;
+
+    /// Size of the node configuration, zero if not included.
+    uint32_t nvs_size;
+
+    /// Identifies a configuration backup image.
+    static constexpr uint32_t MAGIC = 0x47464345;
+
+    /// Current version of the backup format.
+    static constexpr uint16_t FORMAT = 1;
+} __attribute__((packed));
+
+/// @param size is the size of the configuration file.
+/// @param include_nvs will include the @ref node_config_t in the image.
+/// @return size of the configuration backup image.
+inline size_t config_backup_size(size_t size, bool include_nvs)
+{
+    return sizeof(ConfigBackupHeader) + size +
+           (include_nvs ? sizeof(node_config_t) : 0);
+}
+
+/// Creates a configuration backup image, the configuration file is read
+/// directly into @p image without intermediate copies.
+///
+/// @param path is the configuration file.
+/// @param size is the size of the configuration file.
+/// @param cdi_version is the CDI version of the configuration file.
+/// @param include_nvs will include the @ref node_config_t in the image.
+/// @param image will receive the backup image, this must hold
+/// @ref config_backup_size bytes.
+/// @return true if the image was created.
+inline bool config_backup(const char *path, size_t size, uint16_t cdi_version,
+                          bool include_nvs, uint8_t *image)
+{
+    node_config_t config;
+    if (include_nvs && load_config(&config) != ESP_OK)
+    {
+        return false;
+    }
+    ConfigBackupHeader header =
+    {
+        ConfigBackupHeader::MAGIC, ConfigBackupHeader::FORMAT, cdi_version,
+        (uint32_t)size, include_nvs ? (uint32_t)sizeof(node_config_t) : 0
+    };
+    memcpy(image, &header, sizeof(header));
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    size_t offs = 0;
+    while (offs < size)
+    {
+        ssize_t len = ::read(fd, image + sizeof(header) + offs, size - offs);
+        if (len <= 0)
+        {
+            break;
+        }
+        offs += len;
+    }
+    ::close(fd);
+    if (offs != size)
+    {
+        return false;
+    }
+    if (include_nvs)
+    {
+        // The one-shot flags are not part of the backup.
+        config.force_reset = false;
+        config.bootloader_req = false;
+        memcpy(image + sizeof(header) + size, &config, sizeof(node_config_t));
+    }
+    return true;
+}
+
+/// Receives a configuration backup image in chunks and applies it once it
+/// has been received and validated completely, an interrupted upload leaves
+/// the configuration unchanged.
+class ConfigRestore
+{
+public:
+    /// Constructor.
+    ///
+    /// @param path is the configuration file.
+    /// @param size is the size of the configuration file.
+    /// @param cdi_version is the CDI version of the configuration file.
+    ConfigRestore(const char *path, size_t size, uint16_t cdi_version)
+        : path_(path), size_(size), cdiVersion_(cdi_version)
+    {
+    }
+
+    /// Starts receiving a new image.
+    ///
+    /// @param total is the size of the image being received.
+    void begin(size_t total)
+    {
+        data_.clear();
+        data_.reserve(std::min(total, max_size()));
+        total_ = total;
+        error_ = nullptr;
+    }
+
+    /// Adds a chunk of the image.
+    ///
+    /// @param data is the chunk.
+    /// @param len is the length of the chunk.
+    /// @return false if the image is not valid, @ref error returns the
+    /// reason.
+    bool append(const uint8_t *data, size_t len)
+    {
+        if (data_.size() + len > max_size())
+        {
+            error_ = "image is too large";
+            return false;
+        }
+        bool had_header = data_.size() >= sizeof(ConfigBackupHeader);
+        data_.append((const char *)data, len);
+        if (!had_header && data_.size() >= sizeof(ConfigBackupHeader))
+        {
+            return check_header();
+        }
+        return true;
+    }
+
+    /// Applies the received image.
+    ///
+    /// @return false if the image is not valid or could not be written,
+    /// @ref error returns the reason.
+    bool finish()
+    {
+        if (data_.size() < sizeof(ConfigBackupHeader) || !check_header())
+        {
+            error_ = error_ ? error_ : "image is truncated";
+            return false;
+        }
+        const ConfigBackupHeader *header = this->header();
+        if (data_.size() != sizeof(ConfigBackupHeader) + header->config_size +
+                            header->nvs_size)
+        {
+            error_ = "image is truncated";
+            return false;
+        }
+        const char *config = data_.data() + sizeof(ConfigBackupHeader);
+        int fd = ::open(path_, O_WRONLY);
+        if (fd < 0)
+        {
+            error_ = "unable to open configuration";
+            return false;
+        }
+        ssize_t written = ::write(fd, config, header->config_size);
+        ::fsync(fd);
+        ::close(fd);
+        if (written != (ssize_t)header->config_size)
+        {
+            error_ = "unable to write configuration";
+            return false;
+        }
+        if (header->nvs_size)
+        {
+            node_config_t node;
+            memcpy(&node, config + header->config_size, sizeof(node_config_t));
+            node.force_reset = false;
+            node.bootloader_req = false;
+            if (save_config(&node) != ESP_OK)
+            {
+                error_ = "unable to write node configuration";
+                return false;
+            }
+        }
+        LOG(INFO, "[CfgBackup] Restored %" PRIu32 " bytes of configuration%s",
+            header->config_size, header->nvs_size ? " and node settings" : "");
+        data_.clear();
+        data_.shrink_to_fit();
+        return true;
+    }
+
+    /// @return reason for the last failure.
+    const char *error()
+    {
+        return error_ ? error_ : "unknown error";
+    }
+
+private:
+    /// Configuration file.
+    const char *path_;
+
+    /// Size of the configuration file.
+    const size_t size_;
+
+    /// CDI version of the configuration file.
+    const uint16_t cdiVersion_;
+
+    /// Received image.
+    std::string data_;
+
+    /// Size of the image being received.
+    size_t total_{0};
+
+    /// Reason for the last failure.
+    const char *error_{nullptr};
+
+    /// @return largest valid image.
+    size_t max_size()
+    {
+        return sizeof(ConfigBackupHeader) + size_ + sizeof(node_config_t);
+    }
+
+    /// @return header of the received image.
+    const ConfigBackupHeader *header()
+    {
+        return reinterpret_cast<const ConfigBackupHeader *>(data_.data());
+    }
+
+    /// Validates the header of the received image.
+    ///
+    /// @return true if the image can be applied to this node.
+    bool check_header()
+    {
+        const ConfigBackupHeader *header = this->header();
+        if (header->magic != ConfigBackupHeader::MAGIC ||
+            header->format != ConfigBackupHeader::FORMAT)
+        {
+            error_ = "not a configuration backup";
+        }
+        else if (header->cdi_version != cdiVersion_)
+        {
+            error_ = "CDI version mismatch";
+        }
+        else if (header->config_size != size_ ||
+                 (header->nvs_size &&
+                  header->nvs_size != sizeof(node_config_t)))
+        {
+            error_ = "configuration size mismatch";
+        }
+        else if (total_ && total_ != sizeof(ConfigBackupHeader) +
+                                     header->config_size + header->nvs_size)
+        {
+            error_ = "image size mismatch";
+        }
+        else
+        {
+            return true;
+        }
+        return false;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(ConfigRestore);
+};
+
+} // namespace esp32io
+
+#endif // CONFIG_BACKUP_HXX_
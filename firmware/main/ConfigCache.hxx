@@ -0,0 +1,577 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ConfigCache.hxx
+ *
+ * RAM image of the configuration file with write-behind flushing to a
+ * @ref ConfigStore.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CONFIG_CACHE_HXX_
+#define CONFIG_CACHE_HXX_
+
+#include "ConfigStore.hxx"
+
+#include <algorithm>
+#include <errno.h>
+#include <esp_err.h>
+#include <esp_vfs.h>
+#include <executor/Executor.hxx>
+#include <executor/Service.hxx>
+#include <executor/StateFlow.hxx>
+#include <fcntl.h>
+#include <os/OS.hxx>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/ConfigUpdateListener.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <utils/StringPrintf.hxx>
+#include <vector>
+
+#include "sdkconfig.h"
+
+namespace esp32io
+{
+
+/// Holds the configuration file in RAM and exposes it as a single file on a
+/// VFS mount point so that the OpenMRN stack (config_fd, the configuration
+/// memory space and the dynamic SNIP data) can use it without changes.
+///
+/// All reads and writes are served from the RAM image, or directly from the
+/// @ref ConfigStore when it is memory mapped and the image has not been
+/// modified since the last flush. Writes extend a dirty range which is
+/// written to the @ref ConfigStore in a single write when:
+/// - an update-complete command has been received,
+/// - no writes have been received for @p idle_msec, or
+/// - @ref flush is called (before a reboot).
+///
+/// Flushes triggered by an update-complete command or the idle timeout run
+/// on the @ref Service passed to the constructor, this should be a dedicated
+/// executor so that a flash erase does not stall the OpenLCB executor.
+class ConfigCache : public StateFlowBase, public DefaultConfigUpdateListener
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service used for flushing the image.
+    /// @param mount_point is the VFS path to expose the image under.
+    /// @param name is the file name of the image under @p mount_point.
+    /// @param store is the @ref ConfigStore holding the configuration.
+    /// @param size is the size of the configuration file.
+    /// @param idle_msec is the number of milliseconds without writes after
+    /// which the dirty range is flushed.
+    ConfigCache(Service *service, const char *mount_point, const char *name,
+                ConfigStore *store, size_t size, uint32_t idle_msec)
+        : StateFlowBase(service)
+        , DefaultConfigUpdateListener()
+        , name_(StringPrintf("/%s", name))
+        , store_(store)
+        , idleNsec_(MSEC_TO_NSEC(idle_msec))
+    {
+        load(size);
+        esp_vfs_t vfs;
+        memset(&vfs, 0, sizeof(vfs));
+        vfs.flags = ESP_VFS_FLAG_CONTEXT_PTR;
+        vfs.open_p = &ConfigCache::vfs_open;
+        vfs.close_p = &ConfigCache::vfs_close;
+        vfs.read_p = &ConfigCache::vfs_read;
+        vfs.write_p = &ConfigCache::vfs_write;
+        vfs.lseek_p = &ConfigCache::vfs_lseek;
+        vfs.fstat_p = &ConfigCache::vfs_fstat;
+        vfs.stat_p = &ConfigCache::vfs_stat;
+        vfs.fsync_p = &ConfigCache::vfs_fsync;
+        ESP_ERROR_CHECK(esp_vfs_register(mount_point, &vfs, this));
+        start_flow(STATE(wait_for_write));
+    }
+
+    /// Writes the dirty range (if any) to the @ref ConfigStore. This blocks
+    /// the caller until the data has been written.
+    void flush()
+    {
+        OSMutexLock flush_lock(&flushLock_);
+        size_t begin, end, size;
+        bool truncate;
+        {
+            OSMutexLock l(&lock_);
+            if (dirtyBegin_ >= dirtyEnd_ && !truncated_)
+            {
+                return;
+            }
+            truncate = truncated_;
+            begin = dirtyBegin_;
+            end = dirtyEnd_;
+            size = size_;
+            scratch_.assign(image_.begin(), image_.begin() + size_);
+            dirtyBegin_ = capacity_;
+            dirtyEnd_ = 0;
+            truncated_ = false;
+        }
+        ssize_t written =
+            store_->write(scratch_.data(), size, begin, end, truncate);
+        OSMutexLock l(&lock_);
+        if (written < 0)
+        {
+            dirtyBegin_ = std::min(dirtyBegin_, begin);
+            dirtyEnd_ = std::max(dirtyEnd_, end);
+            truncated_ |= truncate;
+            return;
+        }
+        flushes_++;
+        flushedBytes_ += written;
+        LOG(VERBOSE, "[CfgCache] Flushed %zd bytes to %s", written,
+            store_->name());
+        if (store_->mapped() && dirtyBegin_ >= dirtyEnd_ && !truncated_)
+        {
+            // The stored image matches the RAM image, serve reads from the
+            // mapped image again.
+            image_.clear();
+            image_.shrink_to_fit();
+        }
+    }
+
+    /// @return number of write calls received.
+    uint32_t writes()
+    {
+        return writes_;
+    }
+
+    /// @return number of writes made to the @ref ConfigStore.
+    uint32_t flushes()
+    {
+        return flushes_;
+    }
+
+    /// @return number of write calls which did not result in a write to the
+    /// @ref ConfigStore.
+    uint32_t writes_avoided()
+    {
+        return writes_ > flushes_ ? writes_ - flushes_ : 0;
+    }
+
+    /// @return number of bytes received via write calls.
+    uint32_t written_bytes()
+    {
+        return writtenBytes_;
+    }
+
+    /// @return number of bytes written to the @ref ConfigStore.
+    uint32_t flushed_bytes()
+    {
+        return flushedBytes_;
+    }
+
+    /// Processes a configuration update, this is called for the initial
+    /// load and for every update-complete command.
+    ///
+    /// @param fd is the configuration file descriptor.
+    /// @param initial_load is true during the first load of configuration.
+    /// @param done is the @ref BarrierNotifiable to notify on completion.
+    /// @return @ref UpdateAction based on the changes made.
+    UpdateAction apply_configuration(int fd, bool initial_load,
+                                     BarrierNotifiable *done) override
+    {
+        AutoNotify n(done);
+        if (!initial_load)
+        {
+            service()->executor()->add(new CallbackExecutable([this]()
+            {
+                flush();
+            }));
+        }
+        return UPDATED;
+    }
+
+    /// Resets the configuration to defaults, the image is flushed by the
+    /// idle timeout.
+    ///
+    /// @param fd is the configuration file descriptor.
+    void factory_reset(int fd) override
+    {
+    }
+
+private:
+    /// Maximum number of simultaneously open handles to the image.
+    static constexpr int MAX_HANDLES = 4;
+
+    /// Name of the image file (relative to the mount point).
+    const std::string name_;
+
+    /// Persistent storage for the configuration.
+    ConfigStore *store_;
+
+    /// Number of nanoseconds without writes after which the image is
+    /// flushed.
+    const long long idleNsec_;
+
+    /// Protects the image, dirty range and handles.
+    OSMutex lock_;
+
+    /// Serializes writes to the @ref ConfigStore.
+    OSMutex flushLock_;
+
+    /// Configuration image, this is empty when reads are served from the
+    /// mapped @ref ConfigStore.
+    std::vector<uint8_t> image_;
+
+    /// Copy of the image being written to the @ref ConfigStore.
+    std::vector<uint8_t> scratch_;
+
+    /// Maximum size of the configuration file.
+    size_t capacity_{0};
+
+    /// Current size of the configuration file.
+    size_t size_{0};
+
+    /// First dirty byte in the image.
+    size_t dirtyBegin_{0};
+
+    /// One past the last dirty byte in the image.
+    size_t dirtyEnd_{0};
+
+    /// Current position of each open handle, negative when not in use.
+    off_t handles_[MAX_HANDLES]{-1, -1, -1, -1};
+
+    /// Time of the last write.
+    long long lastWrite_{0};
+
+    /// True if the image exists (it was loaded from the @ref ConfigStore or
+    /// it was created).
+    bool exists_{false};
+
+    /// True if the image was truncated and must be rewritten in full.
+    bool truncated_{false};
+
+    /// True if the flush flow has been woken up for the current dirty range.
+    bool armed_{false};
+
+    /// Number of write calls received.
+    uint32_t writes_{0};
+
+    /// Number of writes made to the @ref ConfigStore.
+    uint32_t flushes_{0};
+
+    /// Number of bytes received via write calls.
+    uint32_t writtenBytes_{0};
+
+    /// Number of bytes written to the @ref ConfigStore.
+    uint32_t flushedBytes_{0};
+
+    /// @ref StateFlowTimer used for the idle timeout.
+    StateFlowTimer timer_{this};
+
+    /// Loads the image from the @ref ConfigStore, when the store is memory
+    /// mapped the image is not copied into RAM until it is modified.
+    ///
+    /// @param size is the size of the configuration file.
+    void load(size_t size)
+    {
+        exists_ = store_->exists();
+        size_ = store_->size();
+        capacity_ = std::max(size, size_);
+        if (!store_->mapped())
+        {
+            image_.resize(capacity_, 0xFF);
+            size_ = store_->read(0, image_.data(), size_);
+        }
+        dirtyBegin_ = capacity_;
+        LOG(INFO, "[CfgCache] Loaded %zu/%zu bytes from %s%s", size_,
+            capacity_, store_->name(), image_.empty() ? " (mapped)" : "");
+    }
+
+    /// @return the current image, @ref lock_ must be held.
+    const uint8_t *view()
+    {
+        return image_.empty() ? store_->mapped() : image_.data();
+    }
+
+    /// Copies the mapped image into RAM before it is modified, @ref lock_
+    /// must be held.
+    void materialize()
+    {
+        if (image_.empty())
+        {
+            image_.resize(capacity_, 0xFF);
+            memcpy(image_.data(), store_->mapped(), size_);
+        }
+    }
+
+    /// Waits for the first write after a flush.
+    Action wait_for_write()
+    {
+        return wait_and_call(STATE(idle_wait));
+    }
+
+    /// Sleeps until the image has not been written for the idle timeout.
+    Action idle_wait()
+    {
+        long long remaining;
+        {
+            OSMutexLock l(&lock_);
+            remaining = lastWrite_ + idleNsec_ - os_get_time_monotonic();
+        }
+        if (remaining > 0)
+        {
+            return sleep_and_call(&timer_, remaining, STATE(idle_wait));
+        }
+        flush();
+        {
+            OSMutexLock l(&lock_);
+            if (dirtyBegin_ < dirtyEnd_ || truncated_)
+            {
+                // The flush failed or a write arrived during the flush.
+                lastWrite_ = os_get_time_monotonic();
+                return call_immediately(STATE(idle_wait));
+            }
+            armed_ = false;
+        }
+        return call_immediately(STATE(wait_for_write));
+    }
+
+    /// Allocates a handle for an open call.
+    ///
+    /// @param path is the path relative to the mount point.
+    /// @param flags are the open flags.
+    /// @return handle or -1 with errno set.
+    int open(const char *path, int flags)
+    {
+        if (name_ != path)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        OSMutexLock l(&lock_);
+        if (!exists_ && !(flags & O_CREAT))
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        for (int fd = 0; fd < MAX_HANDLES; fd++)
+        {
+            if (handles_[fd] < 0)
+            {
+                handles_[fd] = 0;
+                exists_ = true;
+                if (flags & O_TRUNC)
+                {
+                    materialize();
+                    size_ = 0;
+                    truncated_ = true;
+                    touch();
+                }
+                return fd;
+            }
+        }
+        errno = ENFILE;
+        return -1;
+    }
+
+    /// Records a write and wakes up the flush flow, @ref lock_ must be held.
+    void touch()
+    {
+        lastWrite_ = os_get_time_monotonic();
+        if (!armed_)
+        {
+            armed_ = true;
+            notify();
+        }
+    }
+
+    /// @param fd is the handle to check.
+    /// @return true if @p fd is an open handle, otherwise errno is set.
+    bool valid(int fd)
+    {
+        if (fd < 0 || fd >= MAX_HANDLES || handles_[fd] < 0)
+        {
+            errno = EBADF;
+            return false;
+        }
+        return true;
+    }
+
+    /// Fills in the stat structure for the image.
+    ///
+    /// @param st is the structure to fill.
+    void fill_stat(struct stat *st)
+    {
+        memset(st, 0, sizeof(struct stat));
+        st->st_mode = S_IFREG | S_IRUSR | S_IWUSR;
+        st->st_size = size_;
+    }
+
+    /// VFS open callback.
+    static int vfs_open(void *ctx, const char *path, int flags, int mode)
+    {
+        return static_cast<ConfigCache *>(ctx)->open(path, flags);
+    }
+
+    /// VFS close callback.
+    static int vfs_close(void *ctx, int fd)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (!cache->valid(fd))
+        {
+            return -1;
+        }
+        cache->handles_[fd] = -1;
+        return 0;
+    }
+
+    /// VFS read callback.
+    static ssize_t vfs_read(void *ctx, int fd, void *dst, size_t size)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (!cache->valid(fd))
+        {
+            return -1;
+        }
+        size_t offs = cache->handles_[fd];
+        if (offs >= cache->size_)
+        {
+            return 0;
+        }
+        size = std::min(size, cache->size_ - offs);
+        memcpy(dst, cache->view() + offs, size);
+        cache->handles_[fd] += size;
+        return size;
+    }
+
+    /// VFS write callback.
+    static ssize_t vfs_write(void *ctx, int fd, const void *src, size_t size)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (!cache->valid(fd))
+        {
+            return -1;
+        }
+        size_t offs = cache->handles_[fd];
+        if (offs >= cache->capacity_)
+        {
+            errno = ENOSPC;
+            return -1;
+        }
+        size = std::min(size, cache->capacity_ - offs);
+        if (offs + size > cache->size_ ||
+            memcmp(cache->view() + offs, src, size))
+        {
+            cache->materialize();
+            memcpy(cache->image_.data() + offs, src, size);
+            cache->dirtyBegin_ = std::min(cache->dirtyBegin_, offs);
+            cache->dirtyEnd_ = std::max(cache->dirtyEnd_, offs + size);
+            cache->touch();
+        }
+        cache->size_ = std::max(cache->size_, offs + size);
+        cache->handles_[fd] += size;
+        cache->writes_++;
+        cache->writtenBytes_ += size;
+        return size;
+    }
+
+    /// VFS lseek callback.
+    static off_t vfs_lseek(void *ctx, int fd, off_t offset, int whence)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (!cache->valid(fd))
+        {
+            return -1;
+        }
+        off_t pos = offset;
+        if (whence == SEEK_CUR)
+        {
+            pos += cache->handles_[fd];
+        }
+        else if (whence == SEEK_END)
+        {
+            pos += cache->size_;
+        }
+        if (pos < 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        cache->handles_[fd] = pos;
+        return pos;
+    }
+
+    /// VFS fstat callback.
+    static int vfs_fstat(void *ctx, int fd, struct stat *st)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (!cache->valid(fd))
+        {
+            return -1;
+        }
+        cache->fill_stat(st);
+        return 0;
+    }
+
+    /// VFS stat callback.
+    static int vfs_stat(void *ctx, const char *path, struct stat *st)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        OSMutexLock l(&cache->lock_);
+        if (cache->name_ != path || !cache->exists_)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        cache->fill_stat(st);
+        return 0;
+    }
+
+    /// VFS fsync callback, this writes the dirty range to the @ref ConfigStore
+    /// before returning.
+    static int vfs_fsync(void *ctx, int fd)
+    {
+        ConfigCache *cache = static_cast<ConfigCache *>(ctx);
+        {
+            OSMutexLock l(&cache->lock_);
+            if (!cache->valid(fd))
+            {
+                return -1;
+            }
+        }
+        cache->flush();
+        return 0;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(ConfigCache);
+};
+
+} // namespace esp32io
+
+#endif // CONFIG_CACHE_HXX_
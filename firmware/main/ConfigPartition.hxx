@@ -0,0 +1,309 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ConfigPartition.hxx
+ *
+ * Configuration image stored in a memory-mapped raw flash partition.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CONFIG_PARTITION_HXX_
+#define CONFIG_PARTITION_HXX_
+
+#include "ConfigStore.hxx"
+
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <inttypes.h>
+#include <spi_flash_mmap.h>
+#include <string.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <vector>
+
+namespace esp32io
+{
+
+/// @ref ConfigStore which keeps the configuration image in a raw flash
+/// partition that is mapped into the address space, reads of a clean image
+/// are served directly from flash.
+///
+/// The partition is split into two slots, each holding a header and a copy
+/// of the image. A write erases the slot which is not active, writes the
+/// image and then the header. A slot is only used when the header and the
+/// CRC of the image are valid, so a power loss during a write leaves the
+/// previously active slot in use.
+class PartitionConfigStore : public ConfigStore
+{
+public:
+    /// Default label of the configuration partition.
+    static constexpr const char *DEFAULT_LABEL = "config";
+
+    /// Constructor.
+    ///
+    /// @param label is the label of the partition.
+    PartitionConfigStore(const char *label = DEFAULT_LABEL)
+    {
+        partition_ =
+            esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                     ESP_PARTITION_SUBTYPE_ANY, label);
+        if (!partition_)
+        {
+            LOG_ERROR("[CfgStore] Partition %s not found", label);
+            return;
+        }
+        slotSize_ = (partition_->size / 2) & ~(SPI_FLASH_SEC_SIZE - 1);
+        if (slotSize_ <= sizeof(SlotHeader))
+        {
+            LOG_ERROR("[CfgStore] Partition %s is too small", label);
+            partition_ = nullptr;
+            return;
+        }
+        const void *map;
+        if (esp_partition_mmap(partition_, 0, slotSize_ * 2,
+                               ESP_PARTITION_MMAP_DATA, &map,
+                               &mapHandle_) != ESP_OK)
+        {
+            LOG_ERROR("[CfgStore] Unable to map partition %s", label);
+            partition_ = nullptr;
+            return;
+        }
+        map_ = static_cast<const uint8_t *>(map);
+        for (size_t slot = 0; slot < 2; slot++)
+        {
+            const SlotHeader *header = slot_header(slot);
+            if (slot_valid(slot) &&
+                (active_ < 0 || header->sequence > sequence_))
+            {
+                active_ = slot;
+                sequence_ = header->sequence;
+            }
+        }
+        LOG(INFO, "[CfgStore] %s: %zu byte slots, active slot: %d (seq:%"
+                  PRIu32 ")", label, slotSize_, active_, sequence_);
+    }
+
+    /// Erases the configuration partition, this is used for a factory reset
+    /// and must be called before a @ref PartitionConfigStore is created.
+    ///
+    /// @param label is the label of the partition.
+    static void erase(const char *label = DEFAULT_LABEL)
+    {
+        const esp_partition_t *partition =
+            esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                     ESP_PARTITION_SUBTYPE_ANY, label);
+        if (partition)
+        {
+            LOG(INFO, "[CfgStore] Erasing partition %s", label);
+            ESP_ERROR_CHECK(
+                esp_partition_erase_range(partition, 0, partition->size));
+        }
+    }
+
+    /// @return true if the partition was found and mapped.
+    bool valid()
+    {
+        return partition_ != nullptr;
+    }
+
+    /// @return label of the partition.
+    const char *name() override
+    {
+        return partition_ ? partition_->label : "config";
+    }
+
+    /// @return true if a valid image is stored in the partition.
+    bool exists() override
+    {
+        return active_ >= 0;
+    }
+
+    /// @return size of the stored image.
+    size_t size() override
+    {
+        return active_ >= 0 ? slot_header(active_)->length : 0;
+    }
+
+    /// @return pointer to the stored image in the mapped partition.
+    const uint8_t *mapped() override
+    {
+        return active_ >= 0 ? slot_data(active_) : nullptr;
+    }
+
+    /// Copies from the stored image.
+    ///
+    /// @param offset is the offset to start reading from.
+    /// @param dst is the buffer to read into.
+    /// @param len is the number of bytes to read.
+    /// @return number of bytes read.
+    size_t read(size_t offset, uint8_t *dst, size_t len) override
+    {
+        size_t stored = size();
+        if (offset >= stored)
+        {
+            return 0;
+        }
+        len = std::min(len, stored - offset);
+        memcpy(dst, mapped() + offset, len);
+        return len;
+    }
+
+    /// Writes the full image into the inactive slot and makes it active.
+    ///
+    /// @param image is a copy of the full configuration image.
+    /// @param size is the size of the configuration image.
+    /// @param begin is not used, the full image is always written.
+    /// @param end is not used, the full image is always written.
+    /// @param truncate is not used, the full image is always written.
+    /// @return number of bytes written or -1 on failure.
+    ssize_t write(const uint8_t *image, size_t size, size_t begin,
+                  size_t end, bool truncate) override
+    {
+        if (!partition_ || size > slotSize_ - sizeof(SlotHeader))
+        {
+            return -1;
+        }
+        size_t slot = active_ == 0 ? 1 : 0;
+        size_t offset = slot * slotSize_;
+        SlotHeader header;
+        header.magic = SLOT_MAGIC;
+        header.sequence = sequence_ + 1;
+        header.length = size;
+        header.crc = esp_rom_crc32_le(0, image, size);
+        esp_err_t res = esp_partition_erase_range(partition_, offset,
+                                                  slotSize_);
+        if (res == ESP_OK)
+        {
+            res = esp_partition_write(partition_, offset + sizeof(SlotHeader),
+                                      image, size);
+        }
+        if (res == ESP_OK)
+        {
+            res = esp_partition_write(partition_, offset, &header,
+                                      sizeof(SlotHeader));
+        }
+        if (res != ESP_OK || !slot_valid(slot))
+        {
+            LOG_ERROR("[CfgStore] Write to %s slot %zu failed: %s",
+                      partition_->label, slot, esp_err_to_name(res));
+            return -1;
+        }
+        active_ = slot;
+        sequence_ = header.sequence;
+        return size + sizeof(SlotHeader);
+    }
+
+    /// Copies the image from another @ref ConfigStore, this is used to
+    /// carry over the configuration when switching to the partition.
+    ///
+    /// @param source is the @ref ConfigStore to copy from.
+    /// @return true if the image was copied.
+    bool import_from(ConfigStore *source)
+    {
+        std::vector<uint8_t> image(source->size());
+        if (source->read(0, image.data(), image.size()) != image.size() ||
+            write(image.data(), image.size(), 0, image.size(), true) < 0)
+        {
+            return false;
+        }
+        LOG(INFO, "[CfgStore] Imported %zu bytes from %s", image.size(),
+            source->name());
+        return true;
+    }
+
+private:
+    /// Identifies a valid slot header.
+    static constexpr uint32_t SLOT_MAGIC = 0x43464731;
+
+    /// Header stored at the start of each slot.
+    struct SlotHeader
+    {
+        /// Set to @ref SLOT_MAGIC when the slot has been written.
+        uint32_t magic;
+
+        /// Incremented on each write, the valid slot with the highest
+        /// sequence number is active.
+        uint32_t sequence;
+
+        /// Length of the image.
+        uint32_t length;
+
+        /// CRC32 of the image.
+        uint32_t crc;
+    };
+
+    /// Partition holding the slots.
+    const esp_partition_t *partition_{nullptr};
+
+    /// Handle for the mapped partition.
+    esp_partition_mmap_handle_t mapHandle_;
+
+    /// Start of the mapped partition.
+    const uint8_t *map_{nullptr};
+
+    /// Size of each slot.
+    size_t slotSize_{0};
+
+    /// Index of the active slot, negative if no slot is valid.
+    int active_{-1};
+
+    /// Sequence number of the active slot.
+    uint32_t sequence_{0};
+
+    /// @param slot is the index of the slot.
+    /// @return header of the slot.
+    const SlotHeader *slot_header(size_t slot)
+    {
+        return reinterpret_cast<const SlotHeader *>(map_ + slot * slotSize_);
+    }
+
+    /// @param slot is the index of the slot.
+    /// @return image stored in the slot.
+    const uint8_t *slot_data(size_t slot)
+    {
+        return map_ + slot * slotSize_ + sizeof(SlotHeader);
+    }
+
+    /// @param slot is the index of the slot.
+    /// @return true if the slot holds a complete image.
+    bool slot_valid(size_t slot)
+    {
+        const SlotHeader *header = slot_header(slot);
+        return header->magic == SLOT_MAGIC &&
+               header->length <= slotSize_ - sizeof(SlotHeader) &&
+               header->crc == esp_rom_crc32_le(0, slot_data(slot),
+                                               header->length);
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(PartitionConfigStore);
+};
+
+} // namespace esp32io
+
+#endif // CONFIG_PARTITION_HXX_
@@ -0,0 +1,216 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ConfigStore.hxx
+ *
+ * Persistent storage for the configuration image held by the ConfigCache.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CONFIG_STORE_HXX_
+#define CONFIG_STORE_HXX_
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/logging.h>
+
+namespace esp32io
+{
+
+/// Persistent storage for the configuration image held by the
+/// @ref ConfigCache.
+class ConfigStore
+{
+public:
+    /// Destructor.
+    virtual ~ConfigStore()
+    {
+    }
+
+    /// @return name of the storage, used in log messages.
+    virtual const char *name() = 0;
+
+    /// @return true if the storage holds a configuration image.
+    virtual bool exists() = 0;
+
+    /// @return size of the stored configuration image.
+    virtual size_t size() = 0;
+
+    /// @return pointer to the stored configuration image when it is mapped
+    /// into the address space, otherwise nullptr. The pointer is only valid
+    /// until the next call to @ref write.
+    virtual const uint8_t *mapped()
+    {
+        return nullptr;
+    }
+
+    /// Reads from the stored configuration image.
+    ///
+    /// @param offset is the offset to start reading from.
+    /// @param dst is the buffer to read into.
+    /// @param len is the number of bytes to read.
+    /// @return number of bytes read.
+    virtual size_t read(size_t offset, uint8_t *dst, size_t len) = 0;
+
+    /// Persists the configuration image.
+    ///
+    /// @param image is a copy of the full configuration image.
+    /// @param size is the size of the configuration image.
+    /// @param begin is the first byte which has changed.
+    /// @param end is one past the last byte which has changed.
+    /// @param truncate is true if the image was truncated, in which case
+    /// the full image must be written.
+    /// @return number of bytes written to flash or a negative value on
+    /// failure.
+    virtual ssize_t write(const uint8_t *image, size_t size, size_t begin,
+                          size_t end, bool truncate) = 0;
+};
+
+/// @ref ConfigStore which keeps the configuration image in a file on the
+/// persistent filesystem, only the changed range is written.
+class FileConfigStore : public ConfigStore
+{
+public:
+    /// Constructor.
+    ///
+    /// @param path is the file holding the configuration image.
+    FileConfigStore(const char *path) : path_(path)
+    {
+        struct stat statbuf;
+        if (!::stat(path_, &statbuf))
+        {
+            exists_ = true;
+            size_ = statbuf.st_size;
+        }
+    }
+
+    /// @return path of the file.
+    const char *name() override
+    {
+        return path_;
+    }
+
+    /// @return true if the file exists.
+    bool exists() override
+    {
+        return exists_;
+    }
+
+    /// @return size of the file.
+    size_t size() override
+    {
+        return size_;
+    }
+
+    /// Reads from the file.
+    ///
+    /// @param offset is the offset to start reading from.
+    /// @param dst is the buffer to read into.
+    /// @param len is the number of bytes to read.
+    /// @return number of bytes read.
+    size_t read(size_t offset, uint8_t *dst, size_t len) override
+    {
+        int fd = ::open(path_, O_RDONLY);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        size_t count = 0;
+        ::lseek(fd, offset, SEEK_SET);
+        while (count < len)
+        {
+            ssize_t res = ::read(fd, dst + count, len - count);
+            if (res <= 0)
+            {
+                break;
+            }
+            count += res;
+        }
+        ::close(fd);
+        return count;
+    }
+
+    /// Writes the changed range to the file.
+    ///
+    /// @param image is a copy of the full configuration image.
+    /// @param size is the size of the configuration image.
+    /// @param begin is the first byte which has changed.
+    /// @param end is one past the last byte which has changed.
+    /// @param truncate is true if the file must be rewritten.
+    /// @return number of bytes written or -1 on failure.
+    ssize_t write(const uint8_t *image, size_t size, size_t begin,
+                  size_t end, bool truncate) override
+    {
+        // The file can not have gaps, extend the range down to the current
+        // end of the file when needed.
+        begin = truncate ? 0 : std::min(begin, size_);
+        end = truncate ? size : std::min(end, size);
+        int flags = O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0);
+        int fd = ::open(path_, flags, S_IRUSR | S_IWUSR);
+        if (fd < 0)
+        {
+            LOG_ERROR("[CfgStore] Unable to open %s: %d", path_, errno);
+            return -1;
+        }
+        ssize_t written = 0;
+        if (end > begin)
+        {
+            ::lseek(fd, begin, SEEK_SET);
+            written = ::write(fd, image + begin, end - begin);
+        }
+        ::close(fd);
+        if (written != (ssize_t)(end - begin))
+        {
+            LOG_ERROR("[CfgStore] Short write to %s: %zd/%zu", path_,
+                      written, end - begin);
+            return -1;
+        }
+        exists_ = true;
+        size_ = truncate ? end : std::max(size_, end);
+        return written;
+    }
+
+private:
+    /// Path to the file.
+    const char *path_;
+
+    /// Current size of the file.
+    size_t size_{0};
+
+    /// True if the file exists.
+    bool exists_{false};
+};
+
+} // namespace esp32io
+
+#endif // CONFIG_STORE_HXX_
@@ -0,0 +1,131 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ConfiguredEventRange.hxx
+ *
+ * Event range for a bank of IO pins or servo outputs, configured via CDI.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef CONFIGURED_EVENT_RANGE_HXX_
+#define CONFIGURED_EVENT_RANGE_HXX_
+
+#include "EventIndex.hxx"
+#include "IoConfig.hxx"
+
+#include <openlcb/Node.hxx>
+#include <utils/ConfigUpdateListener.hxx>
+
+namespace esp32io
+{
+
+/// @ref EventRange which is enabled and placed based on an
+/// @ref EventRangeConfig.
+///
+/// The default base event is taken from the node's own event space at a
+/// fixed offset above the events assigned sequentially by a factory reset, so
+/// the range is aligned and does not overlap the individually configured
+/// events.
+class ConfiguredEventRange : public DefaultConfigUpdateListener
+                           , public EventRange
+{
+public:
+    /// Constructor.
+    ///
+    /// @param node is the @ref openlcb::Node which owns the events.
+    /// @param cfg is the @ref EventRangeConfig for the bank.
+    /// @param count is the number of targets in the bank.
+    /// @param default_offset is the offset of the default base event within
+    /// the node's event space, this must be a multiple of @ref span().
+    ConfiguredEventRange(openlcb::Node *node, const EventRangeConfig &cfg,
+                         size_t count, uint16_t default_offset)
+        : DefaultConfigUpdateListener()
+        , EventRange(count)
+        , node_(node)
+        , cfg_(cfg)
+        , defaultOffset_(default_offset)
+    {
+        HASSERT((default_offset & (span() - 1)) == 0);
+    }
+
+    /// Processes a configuration update.
+    ///
+    /// @param fd is the configuration file descriptor.
+    /// @param initial_load is true during the first load of configuration.
+    /// @param done is the @ref BarrierNotifiable to notify on completion.
+    /// @return @ref UpdateAction based on the changes made.
+    UpdateAction apply_configuration(int fd, bool initial_load,
+                                     BarrierNotifiable *done) override
+    {
+        AutoNotify n(done);
+        const bool range = cfg_.mode().read(fd) == (uint8_t)EventMode::RANGE;
+        const openlcb::EventId base = cfg_.base_event().read(fd);
+        const bool was_active = active();
+        const openlcb::EventId old_base = this->base();
+        set_base(range, base);
+        if (active() != was_active || (active() && this->base() != old_base))
+        {
+            return initial_load ? UPDATED : REINIT_NEEDED;
+        }
+        return UPDATED;
+    }
+
+    /// Resets the configuration to defaults.
+    ///
+    /// @param fd is the configuration file descriptor.
+    void factory_reset(int fd) override
+    {
+        CDI_FACTORY_RESET(cfg_.mode);
+        reset_base_event(fd);
+    }
+
+    /// Resets the base event to the default for this node, this is used
+    /// after the event IDs have been reset.
+    ///
+    /// @param fd is the configuration file descriptor.
+    void reset_base_event(int fd)
+    {
+        cfg_.base_event().write(fd,
+            (node_->node_id() << 16) | defaultOffset_);
+    }
+
+private:
+    /// Node which owns the events.
+    openlcb::Node *node_;
+
+    /// Configuration for the bank.
+    const EventRangeConfig cfg_;
+
+    /// Offset of the default base event within the node's event space.
+    const uint16_t defaultOffset_;
+};
+
+} // namespace esp32io
+
+#endif // CONFIGURED_EVENT_RANGE_HXX_
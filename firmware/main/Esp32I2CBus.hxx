@@ -0,0 +1,175 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file Esp32I2CBus.hxx
+ *
+ * ESP32 I2C master implementation of the I2CBus interface.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef ESP32_I2C_BUS_HXX_
+#define ESP32_I2C_BUS_HXX_
+
+#include "I2CBus.hxx"
+
+#include <driver/i2c.h>
+#include <esp_check.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+
+/// @ref I2CBus implementation using the ESP-IDF I2C master driver.
+class Esp32I2CBus : public I2CBus
+{
+public:
+    /// Constructor.
+    ///
+    /// @param port is the I2C port to use.
+    /// @param sda is the I2C SDA pin.
+    /// @param scl is the I2C SCL pin.
+    Esp32I2CBus(i2c_port_t port, gpio_num_t sda, gpio_num_t scl)
+        : port_(port)
+        , sda_(sda)
+        , scl_(scl)
+    {
+    }
+
+    /// Initializes the I2C driver at standard mode (100kHz) speed.
+    /// @return ESP_OK if the driver was initialized successfully, other values
+    /// for failures.
+    esp_err_t hw_init()
+    {
+        LOG(INFO, "[I2C] Configuring I2C (scl:%d, sda:%d)", scl_, sda_);
+        return configure(I2C_BUS_SPEED);
+    }
+
+    /// Writes a block of data to a device.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param data is the data to write, including any register address.
+    /// @param len is the number of bytes to write.
+    /// @return write status.
+    esp_err_t write(uint8_t address, const uint8_t *data, size_t len) override
+    {
+        return i2c_master_write_to_device(port_, address, data, len,
+                                          MAX_I2C_WAIT_TICKS);
+    }
+
+    /// Reads a block of data from a device register.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param reg is the register address to read from.
+    /// @param data is the buffer to receive the data.
+    /// @param len is the number of bytes to read.
+    /// @return read status.
+    esp_err_t read(uint8_t address, uint8_t reg, uint8_t *data,
+                   size_t len) override
+    {
+        return i2c_master_write_read_device(port_, address, &reg, 1, data, len,
+                                            MAX_I2C_WAIT_TICKS);
+    }
+
+    /// Changes the bus clock speed by reinstalling the I2C driver.
+    ///
+    /// @param speed is the new bus speed in Hz.
+    /// @return ESP_OK if the bus speed was changed, any other value indicates
+    /// failure.
+    ///
+    /// NOTE: This must not be called while a transaction is in progress.
+    esp_err_t set_speed(uint32_t speed) override
+    {
+        ESP_RETURN_ON_ERROR(i2c_driver_delete(port_), TAG,
+            "Failed to remove I2C driver");
+        return configure(speed);
+    }
+
+    /// Checks if a device acknowledges its address.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @return ESP_OK if the device responds, any other value indicates
+    /// failure.
+    esp_err_t ping(uint8_t address) override
+    {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+        i2c_master_stop(cmd);
+        esp_err_t err = i2c_master_cmd_begin(port_, cmd, MAX_I2C_WAIT_TICKS);
+        i2c_cmd_link_delete(cmd);
+        return err;
+    }
+
+private:
+    /// Log tag to use for this class.
+    static constexpr const char *const TAG = "I2C";
+
+    /// Maximum number of ticks to wait for an I2C transaction to complete.
+    static constexpr TickType_t MAX_I2C_WAIT_TICKS = pdMS_TO_TICKS(100);
+
+    /// Standard mode I2C Bus speed.
+    static constexpr uint32_t I2C_BUS_SPEED = 100000;
+
+    /// I2C port to use.
+    const i2c_port_t port_;
+
+    /// SDA pin to use for I2C communication.
+    const gpio_num_t sda_;
+
+    /// SCL pin to use for I2C communication.
+    const gpio_num_t scl_;
+
+    /// Configures the I2C peripheral and installs the I2C driver.
+    ///
+    /// @param speed is the bus speed in Hz.
+    /// @return ESP_OK if the driver was installed, other values for failures.
+    esp_err_t configure(uint32_t speed)
+    {
+        i2c_config_t i2c_config =
+        {
+            .mode = I2C_MODE_MASTER,
+            .sda_io_num = sda_,
+            .scl_io_num = scl_,
+            .sda_pullup_en = GPIO_PULLUP_ENABLE,
+            .scl_pullup_en = GPIO_PULLUP_ENABLE,
+            .master =
+            {
+                .clk_speed = speed
+            },
+            .clk_flags = I2C_SCLK_SRC_FLAG_FOR_NOMAL
+        };
+
+        ESP_RETURN_ON_ERROR(i2c_param_config(port_, &i2c_config), TAG,
+            "Failed to configure I2C bus");
+        ESP_RETURN_ON_ERROR(i2c_driver_install(port_, I2C_MODE_MASTER, 0, 0, 0),
+            TAG, "Failed to install I2C driver");
+        return ESP_OK;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(Esp32I2CBus);
+};
+
+#endif // ESP32_I2C_BUS_HXX_
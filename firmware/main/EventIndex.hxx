@@ -0,0 +1,770 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file EventIndex.hxx
+ *
+ * Consolidated event handler for all IO pins and servo outputs.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef EVENT_INDEX_HXX_
+#define EVENT_INDEX_HXX_
+
+#include <executor/StateFlow.hxx>
+#include <openlcb/Defs.hxx>
+#include <openlcb/EventHandler.hxx>
+#include <openlcb/Node.hxx>
+#include <openlcb/WriteHelper.hxx>
+#include <utils/format_utils.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <algorithm>
+#include <vector>
+
+#include "TxPacer.hxx"
+
+namespace esp32io
+{
+
+class EventIndex;
+class EventRange;
+
+/// Object whose events are handled by an @ref EventIndex. Each target has an
+/// "on" and an "off" event which are either produced or consumed.
+class EventTarget
+{
+public:
+    /// Destructor.
+    virtual ~EventTarget()
+    {
+    }
+
+    /// Adds the events of this target via @ref EventIndex::add.
+    ///
+    /// @param index is the @ref EventIndex being built.
+    virtual void add_events(EventIndex *index) = 0;
+
+    /// @return the current state of this target, @ref openlcb::EventState::VALID
+    /// when the "on" event is the active one.
+    virtual openlcb::EventState event_state() = 0;
+
+    /// Called when a consumed event is received.
+    ///
+    /// @param on is true for the "on" event.
+    virtual void event_received(bool on)
+    {
+    }
+
+    /// Called when the @ref EventRange this target belongs to has been
+    /// enabled, disabled or moved.
+    virtual void range_changed()
+    {
+        invalidate_events();
+    }
+
+protected:
+    /// Notifies the owning @ref EventIndex that the events of this target
+    /// have changed, this must be called from the OpenLCB executor.
+    inline void invalidate_events();
+
+    /// @param on selects the "on" or "off" event.
+    /// @param configured is the event from the configuration of the target.
+    /// @return the event assigned by the @ref EventRange when it is active,
+    /// otherwise @param configured.
+    inline openlcb::EventId target_event(bool on,
+                                         openlcb::EventId configured);
+
+private:
+    friend class EventIndex;
+    friend class EventRange;
+
+    /// @ref EventIndex this target is registered with.
+    EventIndex *index_{nullptr};
+
+    /// @ref EventRange this target belongs to, if any.
+    EventRange *range_{nullptr};
+
+    /// Position of this target in @ref range_.
+    uint16_t rangeSlot_{0};
+};
+
+/// Contiguous block of events shared by a bank of @ref EventTarget objects.
+///
+/// When the range is active each target is assigned two consecutive events
+/// starting from the base event, the "on" event at an even offset and the
+/// "off" event at the following odd offset. The range is identified with a
+/// single event range message and a received event is mapped to its target
+/// by subtracting the base event. The range covers twice the number of
+/// targets rounded up to a power of two so that it can be encoded as an
+/// OpenLCB event range.
+class EventRange
+{
+public:
+    /// Constructor.
+    ///
+    /// @param count is the number of targets in the range.
+    EventRange(size_t count) : slots_(count)
+    {
+        while (span_ < count * 2)
+        {
+            span_ <<= 1;
+        }
+    }
+
+    /// Adds a target to the range.
+    ///
+    /// @param target is the @ref EventTarget to add.
+    /// @param slot is the position of the target in the range.
+    void add_target(EventTarget *target, size_t slot)
+    {
+        HASSERT(slot < slots_.size());
+        slots_[slot].target = target;
+        target->range_ = this;
+        target->rangeSlot_ = slot;
+    }
+
+    /// Enables, disables or moves the range, this must be called from the
+    /// OpenLCB executor.
+    ///
+    /// @param active is true to use the range events.
+    /// @param base is the first event of the range, the low bits are
+    /// cleared if it is not aligned to the range size.
+    void set_base(bool active, openlcb::EventId base)
+    {
+        if (base & (span_ - 1))
+        {
+            LOG(WARNING, "[EventRange] Base event %s is not aligned to %zu "
+                         "events, using %s",
+                uint64_to_string_hex(base).c_str(), span_,
+                uint64_to_string_hex(base & ~(span_ - 1)).c_str());
+            base &= ~(span_ - 1);
+        }
+        if (active == active_ && base == base_)
+        {
+            return;
+        }
+        active_ = active;
+        base_ = base;
+        for (Slot &slot : slots_)
+        {
+            if (slot.target)
+            {
+                slot.target->range_changed();
+            }
+        }
+    }
+
+    /// @return true if the range events are used.
+    bool active()
+    {
+        return active_;
+    }
+
+    /// @return the first event of the range.
+    openlcb::EventId base()
+    {
+        return base_;
+    }
+
+    /// @return the number of events covered by the range.
+    size_t span()
+    {
+        return span_;
+    }
+
+    /// @return the range encoded as an OpenLCB event range identifier, the
+    /// low bits of the identifier are the inverse of the first bit above the
+    /// range.
+    openlcb::EventId encoded()
+    {
+        return (base_ & span_) ? base_ : (base_ | (span_ - 1));
+    }
+
+private:
+    friend class EventIndex;
+
+    /// Position of a target in the range.
+    struct Slot
+    {
+        /// @ref EventTarget using the position, may be nullptr.
+        EventTarget *target{nullptr};
+
+        /// Combination of @ref EventIndex::FLAG_PRODUCER and
+        /// @ref EventIndex::FLAG_CONSUMER.
+        uint8_t flags{0};
+    };
+
+    /// Positions of the targets.
+    std::vector<Slot> slots_;
+
+    /// Number of events covered by the range.
+    size_t span_{2};
+
+    /// First event of the range.
+    openlcb::EventId base_{0};
+
+    /// True if the range events are used.
+    bool active_{false};
+
+    /// @param event is the event ID to look up.
+    /// @return the @ref Slot for @param event or nullptr when the event is
+    /// not part of the active range.
+    Slot *find(openlcb::EventId event)
+    {
+        openlcb::EventId offset = event - base_;
+        if (!active_ || offset >= slots_.size() * 2)
+        {
+            return nullptr;
+        }
+        return &slots_[offset >> 1];
+    }
+
+    /// @return the combined flags of all targets.
+    uint8_t flags()
+    {
+        uint8_t flags = 0;
+        for (const Slot &slot : slots_)
+        {
+            flags |= slot.flags;
+        }
+        return flags;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(EventRange);
+};
+
+/// Single event handler for all @ref EventTarget objects of the node.
+///
+/// Rather than registering one handler per event with the OpenLCB event
+/// registry, this handler is registered once for the full event ID space
+/// and keeps a compact table of all events sorted by event ID. Incoming
+/// events are dispatched with a binary search of the table. The table is
+/// rebuilt on the next lookup after any target has changed its events.
+class EventIndex : public openlcb::SimpleEventHandler
+{
+public:
+    /// Flag for the "on" event of a target.
+    static constexpr uint8_t FLAG_ON = 0x01;
+
+    /// Flag for events which are produced by the target.
+    static constexpr uint8_t FLAG_PRODUCER = 0x02;
+
+    /// Flag for events which are consumed by the target.
+    static constexpr uint8_t FLAG_CONSUMER = 0x04;
+
+    /// Constructor.
+    ///
+    /// @param node is the @ref openlcb::Node which owns the events.
+    EventIndex(openlcb::Node *node)
+        : node_(node)
+        , identifyFlow_(this)
+    {
+        // The registry ignores the low "mask" bits of the event ID, two
+        // entries are needed to cover the full 64-bit event ID space.
+        openlcb::EventRegistry::instance()->register_handler(
+            openlcb::EventRegistryEntry(this, 0, 0), 63);
+        openlcb::EventRegistry::instance()->register_handler(
+            openlcb::EventRegistryEntry(this, 1ULL << 63, 1), 63);
+    }
+
+    /// Destructor.
+    ~EventIndex()
+    {
+        openlcb::EventRegistry::instance()->unregister_handler(this);
+    }
+
+    /// Registers a target.
+    ///
+    /// @param target is the @ref EventTarget to register.
+    void register_target(EventTarget *target)
+    {
+        target->index_ = this;
+        targets_.push_back(target);
+        dirty_ = true;
+    }
+
+    /// Registers a range, the targets of the range must also be registered
+    /// with @ref register_target.
+    ///
+    /// @param range is the @ref EventRange to register.
+    void register_range(EventRange *range)
+    {
+        ranges_.push_back(range);
+        dirty_ = true;
+    }
+
+    /// Sends the identified messages for all events if the node has already
+    /// been initialized, this is used when targets are registered after the
+    /// node has started.
+    void identify_all()
+    {
+        rebuild();
+        if (node_->is_initialized() && identifyFlow_.is_terminated())
+        {
+            identifyFlow_.start(
+                identifyDone_.reset(EmptyNotifiable::DefaultInstance()));
+        }
+    }
+
+    /// Marks the table for rebuilding.
+    void invalidate()
+    {
+        dirty_ = true;
+    }
+
+    /// Adds an event to the table, this is only used by
+    /// @ref EventTarget::add_events.
+    ///
+    /// @param event is the event ID.
+    /// @param target is the @ref EventTarget which owns the event.
+    /// @param flags is a combination of the FLAG_* values.
+    void add(openlcb::EventId event, EventTarget *target, uint8_t flags)
+    {
+        if (target->range_ && target->range_->active())
+        {
+            // The range provides the events of the target.
+            target->range_->slots_[target->rangeSlot_].flags |=
+                flags & (FLAG_PRODUCER | FLAG_CONSUMER);
+            return;
+        }
+        entries_.push_back({event, target, flags});
+    }
+
+    /// @return the number of events in the table.
+    size_t size()
+    {
+        rebuild();
+        return entries_.size();
+    }
+
+    /// @return the number of bytes used by the table.
+    size_t memory_usage()
+    {
+        return entries_.capacity() * sizeof(Entry) +
+               targets_.capacity() * sizeof(EventTarget *);
+    }
+
+    /// @return the @ref TxPacer used for the identify replies.
+    TxPacer *pacer()
+    {
+        return &pacer_;
+    }
+
+    /// Delivers an event to all targets which consume it.
+    ///
+    /// @param event is the event ID.
+    /// @return the number of targets the event was delivered to.
+    size_t deliver(openlcb::EventId event)
+    {
+        size_t count = 0;
+        const Entry *first = find(event);
+        for (EventRange *range : ranges_)
+        {
+            EventRange::Slot *slot = range->find(event);
+            if (slot && (slot->flags & FLAG_CONSUMER))
+            {
+                slot->target->event_received(!((event - range->base()) & 1));
+                count++;
+            }
+        }
+        for (const Entry *match = first;
+             match != end() && match->event == event; match++)
+        {
+            if (match->flags & FLAG_CONSUMER)
+            {
+                match->target->event_received(match->flags & FLAG_ON);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /// Sends an event report from the node.
+    ///
+    /// @param helper is the @ref openlcb::WriteHelper to send with.
+    /// @param node is the @ref openlcb::Node to send from.
+    /// @param event is the event ID to produce.
+    /// @param done is notified when the event has been sent.
+    static void produce(openlcb::WriteHelper *helper, openlcb::Node *node,
+                        openlcb::EventId event, BarrierNotifiable *done)
+    {
+        helper->WriteAsync(node, openlcb::Defs::MTI_EVENT_REPORT,
+                           openlcb::WriteHelper::global(),
+                           openlcb::eventid_to_buffer(event), done);
+    }
+
+    /// Delivers a received event to the consuming targets.
+    ///
+    /// @param entry is the registry entry which matched the event.
+    /// @param event is the received event.
+    /// @param done is notified when processing is complete.
+    void handle_event_report(const openlcb::EventRegistryEntry &entry,
+                             openlcb::EventReport *event,
+                             BarrierNotifiable *done) override
+    {
+        AutoNotify n(done);
+        deliver(event->event);
+    }
+
+    /// Responds to an identify consumer request.
+    ///
+    /// @param entry is the registry entry which matched the event.
+    /// @param event is the event being identified.
+    /// @param done is notified when processing is complete.
+    void handle_identify_consumer(const openlcb::EventRegistryEntry &entry,
+                                  openlcb::EventReport *event,
+                                  BarrierNotifiable *done) override
+    {
+        identify(event, FLAG_CONSUMER, done);
+    }
+
+    /// Responds to an identify producer request.
+    ///
+    /// @param entry is the registry entry which matched the event.
+    /// @param event is the event being identified.
+    /// @param done is notified when processing is complete.
+    void handle_identify_producer(const openlcb::EventRegistryEntry &entry,
+                                  openlcb::EventReport *event,
+                                  BarrierNotifiable *done) override
+    {
+        identify(event, FLAG_PRODUCER, done);
+    }
+
+    /// Responds to an identify events request by sending the identified
+    /// message for every event in the table.
+    ///
+    /// @param entry is the registry entry which matched the request.
+    /// @param event is the identify request.
+    /// @param done is notified when all messages have been sent.
+    void handle_identify_global(const openlcb::EventRegistryEntry &entry,
+                                openlcb::EventReport *event,
+                                BarrierNotifiable *done) override
+    {
+        // This handler is registered twice, only respond once.
+        if (entry.user_arg != 0 ||
+            (event->dst_node && event->dst_node != node_))
+        {
+            return done->notify();
+        }
+        rebuild();
+        if (identifyFlow_.is_terminated())
+        {
+            identifyFlow_.start(done->new_child());
+        }
+        done->notify();
+    }
+
+private:
+    /// Entry in the event table.
+    struct Entry
+    {
+        /// Event ID.
+        openlcb::EventId event;
+
+        /// @ref EventTarget which owns the event.
+        EventTarget *target;
+
+        /// Combination of the FLAG_* values.
+        uint8_t flags;
+
+        /// Orders entries by event ID.
+        bool operator<(const Entry &other) const
+        {
+            return event < other.event;
+        }
+    };
+
+    /// Sends the identified messages for all entries in the table, one
+    /// message at a time.
+    class IdentifyFlow : public StateFlowBase
+    {
+    public:
+        /// Constructor.
+        ///
+        /// @param parent is the owning @ref EventIndex.
+        IdentifyFlow(EventIndex *parent)
+            : StateFlowBase(parent->node_->iface())
+            , parent_(parent)
+        {
+        }
+
+        /// Starts sending the identified messages.
+        ///
+        /// @param done is notified once all messages have been sent.
+        void start(BarrierNotifiable *done)
+        {
+            done_ = done;
+            next_ = 0;
+            parent_->pacer_.begin();
+            start_flow(STATE(send_next));
+        }
+
+    private:
+        /// Owning @ref EventIndex.
+        EventIndex *parent_;
+
+        /// Notified once all messages have been sent.
+        BarrierNotifiable *done_{nullptr};
+
+        /// Index of the next entry to identify.
+        size_t next_{0};
+
+        /// Helper used for sending the messages.
+        openlcb::WriteHelper helper_;
+
+        /// Notified when a message has been sent.
+        BarrierNotifiable n_;
+
+        /// @ref StateFlowTimer used for pacing the messages.
+        StateFlowTimer timer_{this};
+
+        /// Sends the identified message for the next entry, followed by the
+        /// range identified messages for the active ranges.
+        Action send_next()
+        {
+            size_t count = parent_->entries_.size();
+            size_t total = count + parent_->ranges_.size() * 2;
+            while (next_ >= count && next_ < total &&
+                   !parent_->range_type(next_ - count))
+            {
+                next_++;
+            }
+            if (next_ >= total)
+            {
+                parent_->pacer_.end("EventIndex");
+                done_->notify();
+                done_ = nullptr;
+                return exit();
+            }
+            long long delay = parent_->pacer_.next_delay();
+            if (delay)
+            {
+                return sleep_and_call(&timer_, delay, STATE(send_next));
+            }
+            if (next_ < count)
+            {
+                const Entry &entry = parent_->entries_[next_++];
+                parent_->send_identified(&helper_, entry, n_.reset(this));
+            }
+            else
+            {
+                size_t range = next_++ - count;
+                parent_->send_range_identified(
+                    &helper_, parent_->ranges_[range >> 1],
+                    parent_->range_type(range), n_.reset(this));
+            }
+            return wait_and_call(STATE(send_next));
+        }
+    };
+
+    /// Node which owns the events.
+    openlcb::Node *node_;
+
+    /// Registered targets.
+    std::vector<EventTarget *> targets_;
+
+    /// Registered ranges.
+    std::vector<EventRange *> ranges_;
+
+    /// Event table, sorted by event ID.
+    std::vector<Entry> entries_;
+
+    /// True when the table needs to be rebuilt.
+    bool dirty_{true};
+
+    /// Number of times the table has been rebuilt.
+    uint32_t rebuilds_{0};
+
+    /// Paces the messages sent by @ref identifyFlow_.
+    TxPacer pacer_;
+
+    /// Sends the identified messages for @ref handle_identify_global.
+    IdentifyFlow identifyFlow_;
+
+    /// Notified when @ref identifyFlow_ started by @ref identify_all has
+    /// completed.
+    BarrierNotifiable identifyDone_;
+
+    /// Rebuilds the event table if any target has changed its events.
+    void rebuild()
+    {
+        if (!dirty_)
+        {
+            return;
+        }
+        dirty_ = false;
+        rebuilds_++;
+        entries_.clear();
+        for (EventRange *range : ranges_)
+        {
+            for (EventRange::Slot &slot : range->slots_)
+            {
+                slot.flags = 0;
+            }
+        }
+        for (EventTarget *target : targets_)
+        {
+            target->add_events(this);
+        }
+        std::sort(entries_.begin(), entries_.end());
+        entries_.shrink_to_fit();
+        LOG(VERBOSE, "[EventIndex] %zu events indexed (rebuild %" PRIu32 ")",
+            entries_.size(), rebuilds_);
+    }
+
+    /// @return pointer to the first entry for @param event, or the first
+    /// entry with a larger event ID when there is no match.
+    const Entry *find(openlcb::EventId event)
+    {
+        rebuild();
+        Entry key{event, nullptr, 0};
+        return entries_.data() +
+               (std::lower_bound(entries_.begin(), entries_.end(), key) -
+                entries_.begin());
+    }
+
+    /// @return pointer past the last entry of the table.
+    const Entry *end()
+    {
+        return entries_.data() + entries_.size();
+    }
+
+    /// Responds to an identify producer or consumer request for a single
+    /// event.
+    ///
+    /// @param event is the event being identified.
+    /// @param type is @ref FLAG_PRODUCER or @ref FLAG_CONSUMER.
+    /// @param done is notified when processing is complete.
+    void identify(openlcb::EventReport *event, uint8_t type,
+                  BarrierNotifiable *done)
+    {
+        AutoNotify n(done);
+        const Entry *first = find(event->event);
+        for (EventRange *range : ranges_)
+        {
+            EventRange::Slot *slot = range->find(event->event);
+            if (slot && (slot->flags & type))
+            {
+                uint8_t flags = slot->flags & type;
+                if (!((event->event - range->base()) & 1))
+                {
+                    flags |= FLAG_ON;
+                }
+                send_identified(event->event_write_helper<1>(),
+                                {event->event, slot->target, flags},
+                                done->new_child());
+                return;
+            }
+        }
+        for (const Entry *match = first;
+             match != end() && match->event == event->event; match++)
+        {
+            if (match->flags & type)
+            {
+                // Only one response is sent even when several targets
+                // share the event.
+                send_identified(event->event_write_helper<1>(), *match,
+                                done->new_child());
+                return;
+            }
+        }
+    }
+
+    /// Sends the producer or consumer identified message for an entry.
+    ///
+    /// @param helper is the @ref openlcb::WriteHelper to send with.
+    /// @param entry is the @ref Entry to identify.
+    /// @param done is notified when the message has been sent.
+    void send_identified(openlcb::WriteHelper *helper, const Entry &entry,
+                         BarrierNotifiable *done)
+    {
+        openlcb::EventState state = entry.target->event_state();
+        if (!(entry.flags & FLAG_ON))
+        {
+            state = openlcb::invert_event_state(state);
+        }
+        openlcb::Defs::MTI mti = (entry.flags & FLAG_PRODUCER)
+                               ? openlcb::Defs::MTI_PRODUCER_IDENTIFIED_VALID
+                               : openlcb::Defs::MTI_CONSUMER_IDENTIFIED_VALID;
+        mti = (openlcb::Defs::MTI)(mti + (int)state);
+        helper->WriteAsync(node_, mti, openlcb::WriteHelper::global(),
+                           openlcb::eventid_to_buffer(entry.event), done);
+    }
+
+    /// @param message is the index of a range identified message, two
+    /// messages are reserved for each range.
+    /// @return @ref FLAG_PRODUCER or @ref FLAG_CONSUMER when the message
+    /// needs to be sent, zero otherwise.
+    uint8_t range_type(size_t message)
+    {
+        EventRange *range = ranges_[message >> 1];
+        uint8_t type = (message & 1) ? FLAG_CONSUMER : FLAG_PRODUCER;
+        return range->active() && (range->flags() & type) ? type : 0;
+    }
+
+    /// Sends the producer or consumer range identified message for a range.
+    ///
+    /// @param helper is the @ref openlcb::WriteHelper to send with.
+    /// @param range is the @ref EventRange to identify.
+    /// @param type is @ref FLAG_PRODUCER or @ref FLAG_CONSUMER.
+    /// @param done is notified when the message has been sent.
+    void send_range_identified(openlcb::WriteHelper *helper,
+                               EventRange *range, uint8_t type,
+                               BarrierNotifiable *done)
+    {
+        openlcb::Defs::MTI mti = (type & FLAG_PRODUCER)
+                               ? openlcb::Defs::MTI_PRODUCER_IDENTIFIED_RANGE
+                               : openlcb::Defs::MTI_CONSUMER_IDENTIFIED_RANGE;
+        helper->WriteAsync(node_, mti, openlcb::WriteHelper::global(),
+                           openlcb::eventid_to_buffer(range->encoded()), done);
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(EventIndex);
+};
+
+void EventTarget::invalidate_events()
+{
+    if (index_)
+    {
+        index_->invalidate();
+    }
+}
+
+openlcb::EventId EventTarget::target_event(bool on,
+                                           openlcb::EventId configured)
+{
+    if (range_ && range_->active())
+    {
+        return range_->base() + (rangeSlot_ * 2) + (on ? 0 : 1);
+    }
+    return configured;
+}
+
+} // namespace esp32io
+
+#endif // EVENT_INDEX_HXX_
@@ -0,0 +1,192 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file EventIndexBenchmark.hxx
+ *
+ * Micro-benchmark of per-object event registration and the consolidated
+ * event index.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef EVENT_INDEX_BENCHMARK_HXX_
+#define EVENT_INDEX_BENCHMARK_HXX_
+
+#include "EventIndex.hxx"
+
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <openlcb/EventHandlerTemplates.hxx>
+#include <utils/logging.h>
+#include <memory>
+#include <vector>
+
+namespace esp32io
+{
+
+/// Measures the heap used and the CPU cycles needed for looking up received
+/// events with one registered @ref openlcb::BitEventConsumer per pair of
+/// events (as used by the previous per-pin and per-servo objects) and with
+/// the consolidated @ref EventIndex. The results are written to the log.
+///
+/// For the per-object path only the registry lookup is measured (iterating
+/// the registry entries that match the event), for the @ref EventIndex the
+/// binary search and the delivery to the target are measured.
+///
+/// @param node is the @ref openlcb::Node to register the events on.
+/// @param count is the number of events to register.
+/// @param iterations is the number of lookups to average over.
+///
+/// NOTE: This must be called before the node's @ref EventIndex is created as
+/// the benchmark index is registered for all events while it exists.
+inline void benchmark_event_index(openlcb::Node *node, size_t count = 68,
+                                  size_t iterations = 1000)
+{
+    static constexpr openlcb::EventId BASE_EVENT = 0x0501010118FF0000ULL;
+
+    /// Event interface / target used for both paths.
+    class BenchBit : public openlcb::BitEventInterface, public EventTarget
+    {
+    public:
+        BenchBit(openlcb::Node *node, openlcb::EventId event_on,
+                 openlcb::EventId event_off)
+            : BitEventInterface(event_on, event_off)
+            , node_(node)
+        {
+        }
+
+        openlcb::EventState get_current_state() override
+        {
+            return openlcb::EventState::UNKNOWN;
+        }
+
+        void set_state(bool new_value) override
+        {
+            received++;
+        }
+
+        openlcb::Node *node() override
+        {
+            return node_;
+        }
+
+        void add_events(EventIndex *index) override
+        {
+            index->add(event_on(), this,
+                       EventIndex::FLAG_CONSUMER | EventIndex::FLAG_ON);
+            index->add(event_off(), this, EventIndex::FLAG_CONSUMER);
+        }
+
+        openlcb::EventState event_state() override
+        {
+            return openlcb::EventState::UNKNOWN;
+        }
+
+        void event_received(bool on) override
+        {
+            received++;
+        }
+
+        uint32_t received{0};
+
+    private:
+        openlcb::Node *node_;
+    };
+
+    const size_t pairs = count / 2;
+    std::vector<std::unique_ptr<BenchBit>> bits;
+    bits.reserve(pairs);
+    for (size_t idx = 0; idx < pairs; idx++)
+    {
+        bits.emplace_back(new BenchBit(node, BASE_EVENT + (idx * 2) + 1,
+                                       BASE_EVENT + (idx * 2)));
+    }
+
+    // Per-object registration.
+    size_t heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    std::vector<std::unique_ptr<openlcb::BitEventConsumer>> consumers;
+    consumers.reserve(pairs);
+    for (size_t idx = 0; idx < pairs; idx++)
+    {
+        consumers.emplace_back(new openlcb::BitEventConsumer(bits[idx].get()));
+    }
+    size_t per_object_heap = heap - heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    openlcb::EventIterator *iterator =
+        openlcb::EventRegistry::instance()->create_iterator();
+    openlcb::EventReport report;
+    uint32_t matches = 0;
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (size_t pass = 0; pass < iterations; pass++)
+    {
+        report.event = BASE_EVENT + (pass % (pairs * 2));
+        report.mask = 1;
+        iterator->init_iteration(&report);
+        while (iterator->next_entry())
+        {
+            matches++;
+        }
+        iterator->clear_iteration();
+    }
+    uint32_t per_object = esp_cpu_get_cycle_count() - start;
+    delete iterator;
+    consumers.clear();
+
+    // Consolidated event index.
+    heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t index_size = 0;
+    size_t index_heap = 0;
+    uint32_t delivered = 0;
+    uint32_t indexed = 0;
+    {
+        EventIndex index(node);
+        for (auto &bit : bits)
+        {
+            index.register_target(bit.get());
+        }
+        index_size = index.size();
+        index_heap = heap - heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        start = esp_cpu_get_cycle_count();
+        for (size_t pass = 0; pass < iterations; pass++)
+        {
+            delivered += index.deliver(BASE_EVENT + (pass % (pairs * 2)));
+        }
+        indexed = esp_cpu_get_cycle_count() - start;
+    }
+
+    LOG(INFO, "[EventIndex-Bench] %zu events, %zu lookups: per-object %zu "
+        "bytes, %" PRIu32 " cycles/lookup (%" PRIu32 " matches), index %zu "
+        "bytes (%zu entries), %" PRIu32 " cycles/lookup (%" PRIu32
+        " matches)", pairs * 2, iterations, per_object_heap,
+        per_object / iterations, matches, index_heap, index_size,
+        indexed / iterations, delivered);
+}
+
+} // namespace esp32io
+
+#endif // EVENT_INDEX_BENCHMARK_HXX_
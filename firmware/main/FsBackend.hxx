@@ -0,0 +1,72 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file FsBackend.hxx
+ *
+ * Interface for the persistent filesystem implementations.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef FS_BACKEND_HXX_
+#define FS_BACKEND_HXX_
+
+#include <stddef.h>
+
+/// Persistent filesystem implementation which can be mounted under a VFS
+/// path. Implementations for SPIFFS and LittleFS are provided by fs.cpp.
+class FsBackend
+{
+public:
+    /// Destructor.
+    virtual ~FsBackend()
+    {
+    }
+
+    /// @return name of the filesystem, used in log messages.
+    virtual const char *name() = 0;
+
+    /// Mounts the filesystem.
+    ///
+    /// @param format will format the partition if it does not contain a
+    /// valid filesystem of this type.
+    /// @return true if the filesystem was mounted.
+    virtual bool mount(bool format) = 0;
+
+    /// Unmounts the filesystem.
+    virtual void unmount() = 0;
+
+    /// Retrieves the space used on the filesystem.
+    ///
+    /// @param total will receive the size of the filesystem in bytes.
+    /// @param used will receive the number of bytes used.
+    /// @return true if the usage was retrieved.
+    virtual bool usage(size_t *total, size_t *used) = 0;
+};
+
+#endif // FS_BACKEND_HXX_
@@ -0,0 +1,231 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file FsBenchmark.hxx
+ *
+ * Benchmark for the persistent filesystem implementations.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef FS_BENCHMARK_HXX_
+#define FS_BENCHMARK_HXX_
+
+#include "FsBackend.hxx"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <os/os.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <utils/logging.h>
+#include <vector>
+
+#ifndef ESP_PLATFORM
+#include <sys/statvfs.h>
+
+/// @ref FsBackend for running @ref benchmark_fs on Linux. The filesystem is
+/// mounted and unmounted by running shell commands, for example mounting a
+/// file-backed image with littlefs-fuse or a loop device.
+class HostFsBackend : public FsBackend
+{
+public:
+    /// Constructor.
+    ///
+    /// @param path is the directory the filesystem is mounted on.
+    /// @param mount_cmd is the command used to mount the filesystem.
+    /// @param unmount_cmd is the command used to unmount the filesystem.
+    HostFsBackend(const char *path, const char *mount_cmd,
+                  const char *unmount_cmd)
+        : path_(path), mountCmd_(mount_cmd), unmountCmd_(unmount_cmd)
+    {
+    }
+
+    /// @return name of the filesystem.
+    const char *name() override
+    {
+        return "host";
+    }
+
+    /// Mounts the filesystem, formatting is not supported.
+    ///
+    /// @param format is ignored.
+    /// @return true if the mount command succeeded.
+    bool mount(bool format) override
+    {
+        return system(mountCmd_) == 0;
+    }
+
+    /// Unmounts the filesystem.
+    void unmount() override
+    {
+        if (system(unmountCmd_) != 0)
+        {
+            LOG_ERROR("[FS] %s failed", unmountCmd_);
+        }
+    }
+
+    /// Retrieves the space used on the filesystem.
+    ///
+    /// @param total will receive the size of the filesystem in bytes.
+    /// @param used will receive the number of bytes used.
+    /// @return true if the usage was retrieved.
+    bool usage(size_t *total, size_t *used) override
+    {
+        struct statvfs buf;
+        if (statvfs(path_, &buf))
+        {
+            return false;
+        }
+        *total = buf.f_blocks * buf.f_frsize;
+        *used = (buf.f_blocks - buf.f_bfree) * buf.f_frsize;
+        return true;
+    }
+
+private:
+    /// Directory the filesystem is mounted on.
+    const char *path_;
+
+    /// Command used to mount the filesystem.
+    const char *mountCmd_;
+
+    /// Command used to unmount the filesystem.
+    const char *unmountCmd_;
+};
+#endif // ESP_PLATFORM
+
+/// Accumulates the duration of a repeated operation.
+struct FsBenchmarkStat
+{
+    /// Number of samples.
+    uint32_t count{0};
+
+    /// Sum of all samples in microseconds.
+    uint64_t total{0};
+
+    /// Longest sample in microseconds.
+    uint32_t max{0};
+
+    /// Adds a sample.
+    ///
+    /// @param start is the value of @ref os_get_time_monotonic before the
+    /// operation.
+    void add(long long start)
+    {
+        uint32_t usec = NSEC_TO_USEC(os_get_time_monotonic() - start);
+        count++;
+        total += usec;
+        max = std::max(max, usec);
+    }
+
+    /// Writes the result to the log.
+    ///
+    /// @param fs is the name of the filesystem.
+    /// @param op is the name of the operation.
+    void log(const char *fs, const char *op)
+    {
+        LOG(INFO, "[FS] %s %s: %" PRIu32 " samples, avg %" PRIu64 " usec, "
+                  "max %" PRIu32 " usec", fs, op, count,
+            count ? total / count : 0, max);
+    }
+};
+
+/// Measures the mount time of a filesystem, the latency of random 64-byte
+/// writes to a file the size of the configuration file and the latency of
+/// fsync after each write. The results are written to the log.
+///
+/// @param backend is the @ref FsBackend to measure, it must be mounted and
+/// will be mounted when this returns.
+/// @param path is the directory the filesystem is mounted on.
+/// @param file_size is the size of the test file.
+/// @param iterations is the number of writes to measure.
+/// @param mounts is the number of mount cycles to measure.
+///
+/// NOTE: The test file is removed when the benchmark completes, no other
+/// files on the filesystem are modified.
+inline void benchmark_fs(FsBackend *backend, const char *path,
+                         size_t file_size = 2048, size_t iterations = 100,
+                         size_t mounts = 5)
+{
+    static constexpr size_t WRITE_SIZE = 64;
+    FsBenchmarkStat mount_stat, write_stat, fsync_stat;
+    for (size_t cycle = 0; cycle < mounts; cycle++)
+    {
+        backend->unmount();
+        long long start = os_get_time_monotonic();
+        if (!backend->mount(false))
+        {
+            LOG_ERROR("[FS] %s remount failed", backend->name());
+            return;
+        }
+        mount_stat.add(start);
+    }
+
+    std::string file = std::string(path) + "/fsbench";
+    int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        LOG_ERROR("[FS] Unable to create %s", file.c_str());
+        return;
+    }
+    std::vector<uint8_t> data(std::max(file_size, WRITE_SIZE), 0xFF);
+    if (::write(fd, data.data(), data.size()) != (ssize_t)data.size())
+    {
+        LOG_ERROR("[FS] Unable to initialize %s", file.c_str());
+        ::close(fd);
+        ::unlink(file.c_str());
+        return;
+    }
+    ::fsync(fd);
+    for (size_t pass = 0; pass < iterations; pass++)
+    {
+        off_t offs = rand() % (data.size() - WRITE_SIZE + 1);
+        std::fill_n(data.begin(), WRITE_SIZE, (uint8_t)pass);
+        long long start = os_get_time_monotonic();
+        ::lseek(fd, offs, SEEK_SET);
+        ::write(fd, data.data(), WRITE_SIZE);
+        write_stat.add(start);
+        start = os_get_time_monotonic();
+        ::fsync(fd);
+        fsync_stat.add(start);
+    }
+    ::close(fd);
+    ::unlink(file.c_str());
+
+    size_t total = 0, used = 0;
+    backend->usage(&total, &used);
+    LOG(INFO, "[FS] %s benchmark, %zu/%zu bytes used", backend->name(), used,
+        total);
+    mount_stat.log(backend->name(), "mount");
+    write_stat.log(backend->name(), "64-byte write");
+    fsync_stat.log(backend->name(), "fsync");
+}
+
+#endif // FS_BENCHMARK_HXX_
@@ -0,0 +1,88 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file I2CBus.hxx
+ *
+ * Abstract interface for an I2C bus master.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef I2C_BUS_HXX_
+#define I2C_BUS_HXX_
+
+#include <esp_err.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Minimal I2C bus master interface used by the I2C device drivers. This has
+/// no dependency on the ESP-IDF I2C driver so that device drivers can be used
+/// with an alternate (ie: simulated) bus implementation.
+class I2CBus
+{
+public:
+    /// Destructor.
+    virtual ~I2CBus()
+    {
+    }
+
+    /// Writes a block of data to a device.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param data is the data to write, including any register address.
+    /// @param len is the number of bytes to write.
+    /// @return ESP_OK if the device acknowledged all bytes, ESP_ERR_TIMEOUT if
+    /// the bus is busy or stuck, any other value indicates a NACK or failure.
+    virtual esp_err_t write(uint8_t address, const uint8_t *data,
+                            size_t len) = 0;
+
+    /// Reads a block of data from a device register.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param reg is the register address to read from.
+    /// @param data is the buffer to receive the data.
+    /// @param len is the number of bytes to read.
+    /// @return ESP_OK if the data was read, any other value indicates failure.
+    virtual esp_err_t read(uint8_t address, uint8_t reg, uint8_t *data,
+                           size_t len) = 0;
+
+    /// Changes the bus clock speed.
+    ///
+    /// @param speed is the new bus speed in Hz.
+    /// @return ESP_OK if the bus speed was changed, any other value indicates
+    /// failure.
+    virtual esp_err_t set_speed(uint32_t speed) = 0;
+
+    /// Checks if a device acknowledges its address.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @return ESP_OK if the device responds, ESP_ERR_TIMEOUT if the bus is
+    /// busy or stuck, any other value indicates no device present.
+    virtual esp_err_t ping(uint8_t address) = 0;
+};
+
+#endif // I2C_BUS_HXX_
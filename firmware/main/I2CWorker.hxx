@@ -0,0 +1,127 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file I2CWorker.hxx
+ *
+ * Asynchronous I2C command queue.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef I2C_WORKER_HXX_
+#define I2C_WORKER_HXX_
+
+#include "I2CBus.hxx"
+
+#include <executor/CallableFlow.hxx>
+#include <string>
+#include <utils/logging.h>
+
+/// Request structure for the @ref I2CWorker.
+struct I2CRequest : public CallableFlowRequestBase
+{
+    enum WriteCmd
+    {
+        WRITE
+    };
+
+    /// Prepares a write request.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param payload is the data to write, including any register address.
+    void reset(WriteCmd, uint8_t address, std::string payload)
+    {
+        reset_base();
+        cmd = CMD_WRITE;
+        this->address = address;
+        this->payload = std::move(payload);
+    }
+
+    enum Command : uint8_t
+    {
+        CMD_WRITE
+    };
+
+    /// Command to execute.
+    Command cmd;
+
+    /// I2C address of the device.
+    uint8_t address;
+
+    /// Data to be written to the device.
+    std::string payload;
+};
+
+/// Executes I2C transactions on behalf of other flows. This is expected to be
+/// attached to a dedicated @ref Service (and executor thread) so that a slow,
+/// stuck or NACKing device does not block the caller's executor. The result of
+/// the transaction is reported back via the resultCode of the request, which
+/// will contain the esp_err_t from the @ref I2CBus.
+class I2CWorker : public CallableFlow<I2CRequest>
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service to execute the I2C transactions on.
+    /// @param bus is the @ref I2CBus to use for all transactions.
+    I2CWorker(Service *service, I2CBus *bus)
+        : CallableFlow<I2CRequest>(service)
+        , bus_(bus)
+    {
+    }
+
+    /// @return the @ref I2CBus used by this worker.
+    I2CBus *bus()
+    {
+        return bus_;
+    }
+
+private:
+    /// @ref I2CBus to use for all transactions.
+    I2CBus *bus_;
+
+    /// Executes the requested I2C transaction.
+    Action entry() override
+    {
+        switch (request()->cmd)
+        {
+            case I2CRequest::CMD_WRITE:
+            {
+                esp_err_t res =
+                    bus_->write(request()->address,
+                                (const uint8_t *)request()->payload.data(),
+                                request()->payload.size());
+                LOG(VERBOSE, "[I2C] write(%02x, %zu): %d", request()->address,
+                    request()->payload.size(), res);
+                return return_with_error(res);
+            }
+        }
+        return return_with_error(ESP_ERR_NOT_SUPPORTED);
+    }
+};
+
+#endif // I2C_WORKER_HXX_
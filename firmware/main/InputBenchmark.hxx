@@ -0,0 +1,118 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file InputBenchmark.hxx
+ *
+ * Micro-benchmark of the per-pin and bit-parallel input debounce paths.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef INPUT_BENCHMARK_HXX_
+#define INPUT_BENCHMARK_HXX_
+
+#include "ParallelInputEngine.hxx"
+
+#include <esp_cpu.h>
+#include <os/Gpio.hxx>
+#include <utils/logging.h>
+
+namespace esp32io
+{
+
+/// Measures the CPU cycles needed for one debounce pass over all inputs using
+/// the per-pin path (one virtual @ref Gpio::read and one debouncer per pin,
+/// as used by the previous polled producers) and the bit-parallel
+/// @ref VerticalDebouncer used by @ref ParallelInputEngine. The results are
+/// written to the log.
+///
+/// @param pins is the array of @ref Gpio for all inputs, in input number
+/// order.
+/// @param map is the @ref GpioInputMap for the inputs.
+/// @param iterations is the number of passes to average over.
+///
+/// NOTE: This does not touch the active input engine, a separate
+/// @ref VerticalDebouncer is used for measuring the bit-parallel path.
+inline void benchmark_inputs(const Gpio *const *pins, const GpioInputMap &map,
+                             size_t iterations = 1000)
+{
+    struct PinDebouncer
+    {
+        uint8_t count;
+        uint8_t threshold;
+        bool state;
+    } debouncers[InputEngine::MAX_INPUTS];
+    for (size_t index = 0; index < map.count; index++)
+    {
+        debouncers[index] = {0, 3, false};
+    }
+    VerticalDebouncer parallel_debouncer;
+    parallel_debouncer.configure(map.mask, 3, true,
+                                 ParallelInputEngine::read_raw());
+
+    uint32_t changes = 0;
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (size_t pass = 0; pass < iterations; pass++)
+    {
+        for (size_t index = 0; index < map.count; index++)
+        {
+            PinDebouncer &debouncer = debouncers[index];
+            bool level = pins[index]->read() == Gpio::SET;
+            if (level == debouncer.state)
+            {
+                debouncer.count = 0;
+            }
+            else if (++debouncer.count >= debouncer.threshold)
+            {
+                debouncer.state = level;
+                debouncer.count = 0;
+                changes++;
+            }
+        }
+    }
+    uint32_t per_pin = esp_cpu_get_cycle_count() - start;
+
+    start = esp_cpu_get_cycle_count();
+    for (size_t pass = 0; pass < iterations; pass++)
+    {
+        if (parallel_debouncer.process(
+                ParallelInputEngine::read_raw() & map.mask))
+        {
+            changes++;
+        }
+    }
+    uint32_t parallel = esp_cpu_get_cycle_count() - start;
+
+    LOG(INFO, "[Input-Bench] %zu inputs, %zu passes: per-pin %" PRIu32
+        " cycles/pass, bit-parallel %" PRIu32 " cycles/pass (%" PRIu32
+        " changes)", map.count, iterations, per_pin / iterations,
+        parallel / iterations, changes);
+}
+
+} // namespace esp32io
+
+#endif // INPUT_BENCHMARK_HXX_
@@ -0,0 +1,211 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file InputEngine.hxx
+ *
+ * Common interface for the debounced input engines.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef INPUT_ENGINE_HXX_
+#define INPUT_ENGINE_HXX_
+
+#include <executor/Notifiable.hxx>
+#include <utils/Atomic.hxx>
+#include <utils/macros.h>
+
+namespace esp32io
+{
+
+/// Base class for the input engines. An input engine samples a set of input
+/// pins, debounces them and publishes the debounced transitions as bit masks
+/// indexed by the input number.
+///
+/// Transitions are consumed by a single listener (typically a state flow on
+/// the OpenLCB executor). The listener is only notified after it has
+/// drained all previous transitions via @ref take_changes and declared that
+/// it is waiting via @ref wait_for_changes, it is never woken up for inputs
+/// that did not change.
+class InputEngine : protected Atomic
+{
+public:
+    /// Maximum number of inputs supported by an engine.
+    static constexpr size_t MAX_INPUTS = 32;
+
+    /// Destructor.
+    virtual ~InputEngine()
+    {
+    }
+
+    /// Configures the debounce behavior of an input.
+    ///
+    /// @param index is the input number.
+    /// @param debounce_ms is the time in milliseconds that the input must be
+    /// stable before a transition is published.
+    /// @param enabled is true if transitions should be published for this
+    /// input.
+    ///
+    /// NOTE: When an input is enabled its current level is accepted as the
+    /// debounced level without publishing a transition.
+    virtual void configure(size_t index, uint16_t debounce_ms,
+                           bool enabled) = 0;
+
+    /// Sets the listener to notify when transitions are available.
+    ///
+    /// @param listener is the @ref Notifiable to notify.
+    void set_listener(Notifiable *listener)
+    {
+        AtomicHolder h(this);
+        listener_ = listener;
+    }
+
+    /// @param index is the input number.
+    /// @return the debounced level of the input.
+    bool level(size_t index)
+    {
+        return levels_ & (1U << index);
+    }
+
+    /// Retrieves and clears the pending transitions.
+    ///
+    /// @return bit mask of the inputs which have changed.
+    uint32_t take_changes()
+    {
+        AtomicHolder h(this);
+        uint32_t changes = pending_;
+        pending_ = 0;
+        return changes;
+    }
+
+    /// Marks the listener as waiting for transitions. The listener will be
+    /// notified exactly once, either when the next transition is published
+    /// or by @ref wakeup_listener.
+    ///
+    /// @return true if the listener should wait for the notification, false
+    /// if transitions are already pending and should be taken instead.
+    bool wait_for_changes()
+    {
+        AtomicHolder h(this);
+        if (pending_)
+        {
+            return false;
+        }
+        listenerWaiting_ = true;
+        return true;
+    }
+
+    /// Notifies the listener if it is waiting, this is used for wakeups that
+    /// are not caused by an input transition.
+    void wakeup_listener()
+    {
+        Notifiable *listener = nullptr;
+        {
+            AtomicHolder h(this);
+            if (listenerWaiting_ && listener_)
+            {
+                listenerWaiting_ = false;
+                listener = listener_;
+            }
+        }
+        if (listener)
+        {
+            listener->notify();
+        }
+    }
+
+    /// @return number of debounced transitions published.
+    uint32_t transition_count()
+    {
+        return transitions_;
+    }
+
+protected:
+    /// Publishes debounced transitions and notifies the listener if it is
+    /// waiting for transitions.
+    ///
+    /// @param changed is the bit mask of inputs which have changed.
+    /// @param levels is the bit mask of the new input levels, only bits set
+    /// in @param changed are used.
+    void publish(uint32_t changed, uint32_t levels)
+    {
+        Notifiable *listener = nullptr;
+        {
+            AtomicHolder h(this);
+            levels_ = (levels_ & ~changed) | (levels & changed);
+            pending_ |= changed;
+            transitions_ += __builtin_popcount(changed);
+            if (pending_ && listenerWaiting_ && listener_)
+            {
+                listenerWaiting_ = false;
+                listener = listener_;
+            }
+        }
+        if (listener)
+        {
+            listener->notify();
+        }
+    }
+
+    /// Sets the debounced level of an input without publishing a transition.
+    ///
+    /// @param index is the input number.
+    /// @param level is the debounced level.
+    void set_level(size_t index, bool level)
+    {
+        AtomicHolder h(this);
+        if (level)
+        {
+            levels_ |= (1U << index);
+        }
+        else
+        {
+            levels_ &= ~(1U << index);
+        }
+        pending_ &= ~(1U << index);
+    }
+
+private:
+    /// Listener to notify when transitions are available.
+    Notifiable *listener_{nullptr};
+
+    /// True when the listener is waiting to be notified.
+    bool listenerWaiting_{false};
+
+    /// Debounced levels of all inputs.
+    uint32_t levels_{0};
+
+    /// Inputs which have changed since the last call to @ref take_changes.
+    uint32_t pending_{0};
+
+    /// Number of debounced transitions published.
+    uint32_t transitions_{0};
+};
+
+} // namespace esp32io
+
+#endif // INPUT_ENGINE_HXX_
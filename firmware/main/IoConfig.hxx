@@ -0,0 +1,352 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file IoConfig.hxx
+ *
+ * CDI configuration for the input only and configurable IO pins.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef IO_CONFIG_HXX_
+#define IO_CONFIG_HXX_
+
+#include <openlcb/ConfigRepresentation.hxx>
+
+namespace esp32io
+{
+
+/// Default debounce time for inputs, in milliseconds.
+static constexpr uint16_t DEFAULT_DEBOUNCE_MSEC = 90;
+
+/// Maximum debounce time for inputs, in milliseconds.
+static constexpr uint16_t MAX_DEBOUNCE_MSEC = 60000;
+
+/// Default number of events which may be produced in a burst when rate
+/// limiting is enabled.
+static constexpr uint8_t DEFAULT_RATE_BURST = 4;
+
+/// Maximum event rate limit, in events per minute.
+static constexpr uint16_t MAX_RATE_LIMIT = 6000;
+
+/// Behavior of an input when its event rate limit has been reached.
+enum class RateLimitMode : uint8_t
+{
+    /// Transitions are discarded.
+    DROP = 0,
+
+    /// Transitions are held back and only the latest state is produced when
+    /// the rate limit allows another event.
+    COLLAPSE = 1,
+};
+
+/// Map values for @ref RateLimitMode.
+#define RATE_LIMIT_MODE_MAP                                                    \
+    "<relation><property>0</property><value>Drop</value></relation>"           \
+    "<relation><property>1</property><value>Collapse to latest</value>"        \
+    "</relation>"
+
+/// Maximum analog threshold, in ADC counts.
+static constexpr uint16_t MAX_ANALOG_THRESHOLD = 4095;
+
+/// Default analog on threshold, in ADC counts.
+static constexpr uint16_t DEFAULT_ANALOG_ON = 1000;
+
+/// Default analog off threshold, in ADC counts.
+static constexpr uint16_t DEFAULT_ANALOG_OFF = 800;
+
+/// Input mode of an input only pin.
+enum class InputMode : uint8_t
+{
+    /// The pin is a debounced digital input.
+    DIGITAL = 0,
+
+    /// The pin is sampled by the ADC and compared to the analog thresholds.
+    ANALOG = 1,
+};
+
+/// CDI configuration for a single input only pin.
+CDI_GROUP(InputConfig);
+CDI_GROUP_ENTRY(description, openlcb::StringConfigEntry<15>,
+                Name("Description"),
+                Description("User name of this input."));
+CDI_GROUP_ENTRY(debounce, openlcb::Uint16ConfigEntry,
+                Name("Debounce time"),
+                Description("Amount of time, in milliseconds, that the input "
+                            "must remain stable before the event is produced. "
+                            "Usually 50-100 works well in a non-noisy "
+                            "environment. In high noise (train wheels for "
+                            "example) a setting between 250 -- 500 makes for "
+                            "a slower response time but a more stable "
+                            "signal."),
+                Min(0), Max(MAX_DEBOUNCE_MSEC), Default(DEFAULT_DEBOUNCE_MSEC));
+CDI_GROUP_ENTRY(event_on, openlcb::EventConfigEntry,
+                Name("Event On"),
+                Description("This event will be produced when the input goes "
+                            "to HIGH."));
+CDI_GROUP_ENTRY(event_off, openlcb::EventConfigEntry,
+                Name("Event Off"),
+                Description("This event will be produced when the input goes "
+                            "to LOW."));
+CDI_GROUP_ENTRY(rate_limit, openlcb::Uint16ConfigEntry,
+                Name("Event rate limit"),
+                Description("Maximum number of events per minute that will be "
+                            "produced by this input, short bursts up to the "
+                            "burst size are allowed. A value of zero disables "
+                            "rate limiting."),
+                Min(0), Max(MAX_RATE_LIMIT), Default(0));
+CDI_GROUP_ENTRY(rate_burst, openlcb::Uint8ConfigEntry,
+                Name("Event burst size"),
+                Description("Number of events that can be produced back to "
+                            "back before the event rate limit applies."),
+                Min(1), Max(255), Default(DEFAULT_RATE_BURST));
+CDI_GROUP_ENTRY(rate_mode, openlcb::Uint8ConfigEntry,
+                Name("Rate limit mode"),
+                Description("Drop discards transitions that exceed the rate "
+                            "limit. Collapse to latest produces the most "
+                            "recent state of the input once the rate limit "
+                            "allows another event."),
+                Default((uint8_t)RateLimitMode::COLLAPSE),
+                MapValues(RATE_LIMIT_MODE_MAP));
+CDI_GROUP_ENTRY(input_mode, openlcb::Uint8ConfigEntry,
+                Name("Input mode"),
+                Description("Analog is only supported by Input 9 and Input "
+                            "10, the input is sampled by the ADC and "
+                            "compared to the analog thresholds rather than "
+                            "being used as a digital input."),
+                Default((uint8_t)InputMode::DIGITAL),
+                MapValues("<relation><property>0</property>"
+                          "<value>Digital</value></relation>"
+                          "<relation><property>1</property>"
+                          "<value>Analog</value></relation>"));
+CDI_GROUP_ENTRY(analog_on, openlcb::Uint16ConfigEntry,
+                Name("Analog on threshold"),
+                Description("Used for analog mode only. Filtered ADC reading "
+                            "(0 - 4095, approximately 0 - 3.1V) at or above "
+                            "which the on event is produced."),
+                Min(0), Max(MAX_ANALOG_THRESHOLD), Default(DEFAULT_ANALOG_ON));
+CDI_GROUP_ENTRY(analog_off, openlcb::Uint16ConfigEntry,
+                Name("Analog off threshold"),
+                Description("Used for analog mode only. Filtered ADC reading "
+                            "at or below which the off event is produced, "
+                            "this must be lower than the on threshold."),
+                Min(0), Max(MAX_ANALOG_THRESHOLD), Default(DEFAULT_ANALOG_OFF));
+CDI_GROUP_END();
+
+/// Direction setting of a configurable IO pin.
+enum class IoDirection : uint8_t
+{
+    /// The pin is driven by the received events.
+    OUTPUT = 0,
+
+    /// The pin produces events when the input changes.
+    INPUT = 1,
+
+    /// The pin is counted by the pulse counter peripheral and produces
+    /// events based on the pulse count.
+    PULSE_COUNTER = 2,
+
+    /// The pin is sampled by the ADC and produces events when the analog
+    /// thresholds are crossed.
+    ANALOG = 3,
+};
+
+/// Event generation mode of a pulse counter pin.
+enum class PulseMode : uint8_t
+{
+    /// The on event is produced every time the threshold number of pulses
+    /// has been counted, the off event is produced once no pulses have been
+    /// counted for the window time.
+    COUNT = 0,
+
+    /// The on event is produced when at least the threshold number of pulses
+    /// are counted within the window time, the off event is produced when
+    /// the count in a window drops below the threshold.
+    RATE = 1,
+};
+
+/// Maximum pulse count threshold, limited by the 16-bit hardware counter.
+static constexpr uint16_t MAX_PULSE_THRESHOLD = 32767;
+
+/// Default pulse counter window time in milliseconds.
+static constexpr uint16_t DEFAULT_PULSE_WINDOW_MSEC = 1000;
+
+/// Minimum pulse counter window time in milliseconds.
+static constexpr uint16_t MIN_PULSE_WINDOW_MSEC = 10;
+
+/// Default pulse counter glitch filter in nanoseconds.
+static constexpr uint16_t DEFAULT_PULSE_FILTER_NSEC = 1000;
+
+/// Maximum pulse counter glitch filter in nanoseconds, limited by the
+/// hardware filter (1023 APB clock cycles).
+static constexpr uint16_t MAX_PULSE_FILTER_NSEC = 12000;
+
+/// CDI configuration for a single configurable IO pin.
+CDI_GROUP(IoConfig);
+CDI_GROUP_ENTRY(direction, openlcb::Uint8ConfigEntry,
+                Name("Configuration"),
+                Default((uint8_t)IoDirection::INPUT),
+                MapValues("<relation><property>0</property>"
+                          "<value>Output</value></relation>"
+                          "<relation><property>1</property>"
+                          "<value>Input</value></relation>"
+                          "<relation><property>2</property>"
+                          "<value>Pulse counter</value></relation>"
+                          "<relation><property>3</property>"
+                          "<value>Analog input</value></relation>"));
+CDI_GROUP_ENTRY(debounce, openlcb::Uint16ConfigEntry,
+                Name("Debounce time"),
+                Description("Used for inputs only. Amount of time, in "
+                            "milliseconds, that the input must remain stable "
+                            "before the event is produced. Usually 50-100 "
+                            "works well in a non-noisy environment. In high "
+                            "noise (train wheels for example) a setting "
+                            "between 250 -- 500 makes for a slower response "
+                            "time but a more stable signal."),
+                Min(0), Max(MAX_DEBOUNCE_MSEC), Default(DEFAULT_DEBOUNCE_MSEC));
+CDI_GROUP_ENTRY(description, openlcb::StringConfigEntry<20>,
+                Name("Description"),
+                Description("User name of this line."));
+CDI_GROUP_ENTRY(event_on, openlcb::EventConfigEntry,
+                Name("Event On"),
+                Description("This event ID will turn the output on / be "
+                            "produced when the input goes on."));
+CDI_GROUP_ENTRY(event_off, openlcb::EventConfigEntry,
+                Name("Event Off"),
+                Description("This event ID will turn the output off / be "
+                            "produced when the input goes off."));
+CDI_GROUP_ENTRY(rate_limit, openlcb::Uint16ConfigEntry,
+                Name("Event rate limit"),
+                Description("Used for inputs only. Maximum number of events "
+                            "per minute that will be produced by this input, "
+                            "short bursts up to the burst size are allowed. A "
+                            "value of zero disables rate limiting."),
+                Min(0), Max(MAX_RATE_LIMIT), Default(0));
+CDI_GROUP_ENTRY(rate_burst, openlcb::Uint8ConfigEntry,
+                Name("Event burst size"),
+                Description("Used for inputs only. Number of events that can "
+                            "be produced back to back before the event rate "
+                            "limit applies."),
+                Min(1), Max(255), Default(DEFAULT_RATE_BURST));
+CDI_GROUP_ENTRY(rate_mode, openlcb::Uint8ConfigEntry,
+                Name("Rate limit mode"),
+                Description("Used for inputs only. Drop discards transitions "
+                            "that exceed the rate limit. Collapse to latest "
+                            "produces the most recent state of the input once "
+                            "the rate limit allows another event."),
+                Default((uint8_t)RateLimitMode::COLLAPSE),
+                MapValues(RATE_LIMIT_MODE_MAP));
+CDI_GROUP_ENTRY(pulse_mode, openlcb::Uint8ConfigEntry,
+                Name("Pulse counter mode"),
+                Description("Used for pulse counter only. Count produces the "
+                            "on event every time the threshold number of "
+                            "pulses has been counted and the off event once "
+                            "no pulses have been counted for the window time. "
+                            "Rate produces the on event when at least the "
+                            "threshold number of pulses are counted within "
+                            "the window time and the off event when the rate "
+                            "drops below the threshold."),
+                Default((uint8_t)PulseMode::COUNT),
+                MapValues("<relation><property>0</property>"
+                          "<value>Count</value></relation>"
+                          "<relation><property>1</property>"
+                          "<value>Rate</value></relation>"));
+CDI_GROUP_ENTRY(pulse_threshold, openlcb::Uint16ConfigEntry,
+                Name("Pulse count threshold"),
+                Description("Used for pulse counter only. Number of pulses "
+                            "(rising edges) required to produce the on "
+                            "event."),
+                Min(1), Max(MAX_PULSE_THRESHOLD), Default(1));
+CDI_GROUP_ENTRY(pulse_window, openlcb::Uint16ConfigEntry,
+                Name("Pulse window time"),
+                Description("Used for pulse counter only. Time, in "
+                            "milliseconds, of the counting window."),
+                Min(MIN_PULSE_WINDOW_MSEC), Max(60000),
+                Default(DEFAULT_PULSE_WINDOW_MSEC));
+CDI_GROUP_ENTRY(pulse_filter, openlcb::Uint16ConfigEntry,
+                Name("Pulse glitch filter"),
+                Description("Used for pulse counter only. Pulses shorter "
+                            "than this time, in nanoseconds, are ignored by "
+                            "the hardware. A value of zero disables the "
+                            "filter."),
+                Min(0), Max(MAX_PULSE_FILTER_NSEC),
+                Default(DEFAULT_PULSE_FILTER_NSEC));
+CDI_GROUP_ENTRY(analog_on, openlcb::Uint16ConfigEntry,
+                Name("Analog on threshold"),
+                Description("Used for analog input only, this is only "
+                            "supported by IO 11 and IO 12. Filtered ADC "
+                            "reading (0 - 4095, approximately 0 - 3.1V) at or "
+                            "above which the on event is produced."),
+                Min(0), Max(MAX_ANALOG_THRESHOLD), Default(DEFAULT_ANALOG_ON));
+CDI_GROUP_ENTRY(analog_off, openlcb::Uint16ConfigEntry,
+                Name("Analog off threshold"),
+                Description("Used for analog input only. Filtered ADC reading "
+                            "at or below which the off event is produced, "
+                            "this must be lower than the on threshold."),
+                Min(0), Max(MAX_ANALOG_THRESHOLD), Default(DEFAULT_ANALOG_OFF));
+CDI_GROUP_END();
+
+/// Event allocation mode for a bank of IO pins or servo outputs.
+enum class EventMode : uint8_t
+{
+    /// Each pin or output uses the events from its own configuration.
+    INDIVIDUAL = 0,
+
+    /// The pins or outputs use a contiguous block of events starting at the
+    /// configured base event.
+    RANGE = 1,
+};
+
+/// CDI configuration for the event allocation of a bank of IO pins or servo
+/// outputs.
+CDI_GROUP(EventRangeConfig);
+CDI_GROUP_ENTRY(mode, openlcb::Uint8ConfigEntry,
+                Name("Event mode"),
+                Description("Individual uses the events configured for each "
+                            "entry. Range assigns two events to each entry "
+                            "starting from the base event, the first is the "
+                            "on event and the second is the off event. The "
+                            "bank is identified with a single event range "
+                            "message."),
+                Default((uint8_t)EventMode::INDIVIDUAL),
+                MapValues("<relation><property>0</property>"
+                          "<value>Individual</value></relation>"
+                          "<relation><property>1</property>"
+                          "<value>Range</value></relation>"));
+CDI_GROUP_ENTRY(base_event, openlcb::EventConfigEntry,
+                Name("Base event"),
+                Description("Used for range mode only. First event of the "
+                            "range, this must be a multiple of the range "
+                            "size which is twice the number of entries "
+                            "rounded up to a power of two. A factory reset "
+                            "assigns an aligned base event from the node's "
+                            "own events."));
+CDI_GROUP_END();
+
+} // namespace esp32io
+
+#endif // IO_CONFIG_HXX_
@@ -0,0 +1,733 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file IoPin.hxx
+ *
+ * Event producers and consumers for the input only and configurable IO pins.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef IO_PIN_HXX_
+#define IO_PIN_HXX_
+
+#include "AnalogInputEngine.hxx"
+#include "EventIndex.hxx"
+#include "InputEngine.hxx"
+#include "IoConfig.hxx"
+#include "OutputBank.hxx"
+#include "PulseCounter.hxx"
+
+#include <executor/StateFlow.hxx>
+#include <executor/Timer.hxx>
+#include <openlcb/Node.hxx>
+#include <openlcb/WriteHelper.hxx>
+#include <os/Gpio.hxx>
+#include <utils/ConfigUpdateListener.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <algorithm>
+#include <memory>
+#include <os/os.h>
+
+namespace esp32io
+{
+
+class InputDispatcher;
+
+/// Common interface of all IO pins used by the @ref InputDispatcher, the
+/// events of the pin are handled by the @ref EventIndex.
+///
+/// Each pin carries an optional event rate limit implemented as a token
+/// bucket (in its virtual scheduling form): every produced event advances
+/// the theoretical arrival time by one interval and an event is allowed
+/// while the theoretical arrival time is no more than (burst - 1) intervals
+/// ahead of the current time.
+class IoPin : public EventTarget
+{
+public:
+    /// @return true if this pin produces events for input transitions.
+    virtual bool is_input() = 0;
+
+    /// @param level is the input level.
+    /// @return the event to produce for @param level.
+    virtual openlcb::EventId input_event(bool level) = 0;
+
+    /// @return number of events produced by this pin.
+    uint32_t event_count()
+    {
+        return events_;
+    }
+
+    /// @return number of transitions which were not produced due to the
+    /// event rate limit.
+    uint32_t suppressed_count()
+    {
+        return suppressed_;
+    }
+
+protected:
+    /// Configures the event rate limit.
+    ///
+    /// @param per_minute is the maximum number of events per minute, zero
+    /// disables the rate limit.
+    /// @param burst is the number of events that can be produced back to
+    /// back.
+    /// @param mode is the @ref RateLimitMode to use for transitions that
+    /// exceed the rate limit.
+    /// @param level is the current level of the input.
+    void configure_rate_limit(uint16_t per_minute, uint8_t burst,
+                              RateLimitMode mode, bool level)
+    {
+        interval_ = per_minute ? SEC_TO_NSEC(60) / per_minute : 0;
+        tolerance_ = interval_ * (std::max<uint8_t>(burst, 1) - 1);
+        tat_ = 0;
+        mode_ = mode;
+        lastSent_ = level;
+    }
+
+private:
+    friend class InputDispatcher;
+
+    /// Takes a token from the bucket.
+    ///
+    /// @param now is the current time in nanoseconds.
+    /// @param retry_at will be set to the time when the next token is
+    /// available if there are no tokens available.
+    /// @return true if the event can be produced.
+    bool take_token(long long now, long long *retry_at)
+    {
+        if (!interval_)
+        {
+            return true;
+        }
+        if (tat_ - tolerance_ > now)
+        {
+            *retry_at = tat_ - tolerance_;
+            return false;
+        }
+        tat_ = std::max(tat_, now) + interval_;
+        return true;
+    }
+
+    /// Time between events in nanoseconds, zero when not rate limited.
+    long long interval_{0};
+
+    /// Time the bucket may run ahead of the current time.
+    long long tolerance_{0};
+
+    /// Theoretical arrival time of the next event.
+    long long tat_{0};
+
+    /// Behavior when the rate limit has been reached.
+    RateLimitMode mode_{RateLimitMode::COLLAPSE};
+
+    /// Last state that an event was produced for.
+    bool lastSent_{false};
+
+    /// Number of events produced by this pin.
+    uint32_t events_{0};
+
+    /// Number of transitions not produced due to the rate limit.
+    uint32_t suppressed_{0};
+};
+
+/// Event producer / consumer for a single IO pin. The pin is configured via
+/// either @ref InputConfig (input only) or @ref IoConfig (configurable
+/// direction).
+///
+/// Inputs are not polled, the debounced level is maintained by an
+/// @ref InputEngine and transitions are delivered by the @ref InputDispatcher.
+/// Configurable IO pins can alternatively be counted by a @ref PulseCounter
+/// and pins with an ADC1 channel can be sampled by an
+/// @ref AnalogInputEngine, analog transitions are delivered by a second
+/// @ref InputDispatcher.
+template <class Config>
+class ConfiguredIoPin : public IoPin, public DefaultConfigUpdateListener
+{
+public:
+    /// Constructor.
+    ///
+    /// @param node is the @ref openlcb::Node which owns the events.
+    /// @param cfg is the configuration for this pin.
+    /// @param gpio is the @ref Gpio for this pin.
+    /// @param engine is the @ref InputEngine which debounces this pin.
+    /// @param index is the pin number of this pin in @param engine and
+    /// @param outputs.
+    /// @param outputs is the @ref OutputBank which drives this pin, this may
+    /// be nullptr for input only pins.
+    /// @param pin_num is the GPIO pin number, used for the pulse counter
+    /// mode.
+    /// @param analog is the @ref AnalogInputEngine which samples this pin in
+    /// analog mode, this may be nullptr.
+    ConfiguredIoPin(openlcb::Node *node, const Config &cfg, const Gpio *gpio,
+                    InputEngine *engine, size_t index,
+                    OutputBank *outputs = nullptr,
+                    gpio_num_t pin_num = GPIO_NUM_NC,
+                    AnalogInputEngine *analog = nullptr)
+        : DefaultConfigUpdateListener()
+        , node_(node)
+        , cfg_(cfg)
+        , gpio_(gpio)
+        , engine_(engine)
+        , outputs_(outputs)
+        , analog_(analog)
+        , index_(index)
+        , pinNum_(pin_num)
+    {
+    }
+
+    /// @return true if this pin is configured as a digital or analog input.
+    bool is_input() override
+    {
+        return configured_ && (direction_ == IoDirection::INPUT ||
+                               direction_ == IoDirection::ANALOG);
+    }
+
+    /// @param level is the input level.
+    /// @return the event to produce for @param level.
+    openlcb::EventId input_event(bool level) override
+    {
+        return target_event(level, level ? eventOn_ : eventOff_);
+    }
+
+    /// Updates the pulse counter events when the range this pin belongs to
+    /// has changed.
+    void range_changed() override
+    {
+        if (counter_)
+        {
+            counter_->set_events(node_, target_event(true, eventOn_),
+                                 target_event(false, eventOff_));
+        }
+        invalidate_events();
+    }
+
+    /// Adds the events of this pin, outputs consume the events and all other
+    /// configurations produce them.
+    ///
+    /// @param index is the @ref EventIndex being built.
+    void add_events(EventIndex *index) override
+    {
+        if (!configured_)
+        {
+            return;
+        }
+        uint8_t type = direction_ == IoDirection::OUTPUT
+                     ? EventIndex::FLAG_CONSUMER : EventIndex::FLAG_PRODUCER;
+        index->add(eventOn_, this, type | EventIndex::FLAG_ON);
+        index->add(eventOff_, this, type);
+    }
+
+    /// @return the current state of the pin, for inputs this is the
+    /// debounced level, for analog inputs the threshold state and for pulse
+    /// counters the counter state.
+    openlcb::EventState event_state() override
+    {
+        bool state;
+        if (direction_ == IoDirection::OUTPUT)
+        {
+            state = outputs_->read(index_);
+        }
+        else if (direction_ == IoDirection::PULSE_COUNTER)
+        {
+            state = counter_ && counter_->active();
+        }
+        else if (direction_ == IoDirection::ANALOG)
+        {
+            state = analog_->level(index_);
+        }
+        else
+        {
+            state = engine_->level(index_);
+        }
+        return state ? openlcb::EventState::VALID
+                     : openlcb::EventState::INVALID;
+    }
+
+    /// Drives the output pin, the change is applied by the @ref OutputBank
+    /// together with any other outputs changed in the same executor pass.
+    ///
+    /// @param on is the new state of the pin.
+    void event_received(bool on) override
+    {
+        if (direction_ == IoDirection::OUTPUT)
+        {
+            outputs_->write(index_, on);
+        }
+    }
+
+    /// Processes a configuration update.
+    ///
+    /// @param fd is the configuration file descriptor.
+    /// @param initial_load is true during the first load of configuration.
+    /// @param done is the @ref BarrierNotifiable to notify on completion.
+    /// @return @ref UpdateAction based on the changes made.
+    UpdateAction apply_configuration(int fd, bool initial_load,
+                                     BarrierNotifiable *done) override
+    {
+        AutoNotify n(done);
+        IoDirection direction = read_direction(cfg_, fd);
+        const uint16_t debounce = cfg_.debounce().read(fd);
+        const openlcb::EventId event_on = cfg_.event_on().read(fd);
+        const openlcb::EventId event_off = cfg_.event_off().read(fd);
+        const uint16_t rate_limit = cfg_.rate_limit().read(fd);
+        const uint8_t rate_burst = cfg_.rate_burst().read(fd);
+        const RateLimitMode rate_mode =
+            (RateLimitMode)cfg_.rate_mode().read(fd);
+        const PulseCounterSettings pulse = read_pulse_settings(cfg_, fd);
+        const uint16_t analog_on = cfg_.analog_on().read(fd);
+        const uint16_t analog_off = cfg_.analog_off().read(fd);
+
+        if (direction == IoDirection::ANALOG &&
+            (!analog_ || !analog_->supported(index_)))
+        {
+            LOG(WARNING, "[IO] GPIO %d does not support analog mode, using "
+                         "it as a digital input", pinNum_);
+            direction = IoDirection::INPUT;
+        }
+
+        if (counter_ &&
+            (direction != IoDirection::PULSE_COUNTER || pulse != pulse_))
+        {
+            // The PCNT unit can not be reconfigured or released while it is
+            // counting.
+            return REBOOT_NEEDED;
+        }
+
+        if (direction_ == IoDirection::ANALOG &&
+            direction != IoDirection::ANALOG)
+        {
+            // The pin remains connected to the ADC until the node restarts.
+            return REBOOT_NEEDED;
+        }
+
+        if (direction == IoDirection::OUTPUT)
+        {
+            HASSERT(outputs_);
+            engine_->configure(index_, debounce, false);
+            gpio_->set_direction(Gpio::Direction::DOUTPUT);
+        }
+        else if (direction == IoDirection::ANALOG)
+        {
+            engine_->configure(index_, debounce, false);
+            if (direction_ == IoDirection::OUTPUT)
+            {
+                gpio_->set_direction(Gpio::Direction::DINPUT);
+            }
+            analog_->set_thresholds(index_, analog_on, analog_off);
+            analog_->configure(index_, debounce, true);
+        }
+        else if (direction == IoDirection::PULSE_COUNTER)
+        {
+            engine_->configure(index_, debounce, false);
+            if (direction_ == IoDirection::OUTPUT)
+            {
+                gpio_->set_direction(Gpio::Direction::DINPUT);
+            }
+            if (!counter_)
+            {
+                HASSERT(pinNum_ != GPIO_NUM_NC);
+                pulse_ = pulse;
+                counter_.reset(new PulseCounter(node_->iface(), pinNum_));
+                if (counter_->start(pulse) != ESP_OK)
+                {
+                    LOG_ERROR("[IO] Unable to use GPIO %d as pulse counter",
+                              pinNum_);
+                }
+            }
+        }
+        else
+        {
+            if (direction_ == IoDirection::OUTPUT)
+            {
+                gpio_->set_direction(Gpio::Direction::DINPUT);
+            }
+            engine_->configure(index_, debounce, true);
+        }
+        configure_rate_limit(rate_limit, rate_burst, rate_mode,
+                             direction == IoDirection::ANALOG
+                                 ? analog_->level(index_)
+                                 : engine_->level(index_));
+
+        if (!configured_ || direction != direction_ ||
+            event_on != eventOn_ || event_off != eventOff_)
+        {
+            configured_ = true;
+            direction_ = direction;
+            eventOn_ = event_on;
+            eventOff_ = event_off;
+            if (counter_)
+            {
+                counter_->set_events(node_, target_event(true, event_on),
+                                     target_event(false, event_off));
+            }
+            invalidate_events();
+            return initial_load ? UPDATED : REINIT_NEEDED;
+        }
+        return UPDATED;
+    }
+
+    /// Resets the configuration to defaults.
+    ///
+    /// @param fd is the configuration file descriptor.
+    void factory_reset(int fd) override
+    {
+        reset_direction(cfg_, fd);
+        reset_pulse_settings(cfg_, fd);
+        CDI_FACTORY_RESET(cfg_.debounce);
+        CDI_FACTORY_RESET(cfg_.analog_on);
+        CDI_FACTORY_RESET(cfg_.analog_off);
+        CDI_FACTORY_RESET(cfg_.rate_limit);
+        CDI_FACTORY_RESET(cfg_.rate_burst);
+        CDI_FACTORY_RESET(cfg_.rate_mode);
+    }
+
+private:
+    /// Node which owns the events of this pin.
+    openlcb::Node *node_;
+
+    /// Configuration for this pin.
+    const Config cfg_;
+
+    /// @ref Gpio for this pin.
+    const Gpio *gpio_;
+
+    /// @ref InputEngine which debounces this pin.
+    InputEngine *engine_;
+
+    /// @ref OutputBank which drives this pin.
+    OutputBank *outputs_;
+
+    /// @ref AnalogInputEngine which samples this pin in analog mode.
+    AnalogInputEngine *analog_;
+
+    /// Pin number of this pin in @ref engine_ and @ref outputs_.
+    const size_t index_;
+
+    /// GPIO pin number of this pin.
+    const gpio_num_t pinNum_;
+
+    /// Current direction of this pin.
+    IoDirection direction_{IoDirection::INPUT};
+
+    /// True once the configuration has been loaded.
+    bool configured_{false};
+
+    /// Event for the on (HIGH) state.
+    openlcb::EventId eventOn_{0};
+
+    /// Event for the off (LOW) state.
+    openlcb::EventId eventOff_{0};
+
+    /// Pulse counter, only used when configured as a pulse counter. Once
+    /// created this is kept until the node restarts.
+    std::unique_ptr<PulseCounter> counter_;
+
+    /// Pulse counter settings used when @ref counter_ was started.
+    PulseCounterSettings pulse_;
+
+    /// @return @ref IoDirection::ANALOG when the input only pin is in
+    /// analog mode, @ref IoDirection::INPUT otherwise.
+    static IoDirection read_direction(const InputConfig &cfg, int fd)
+    {
+        return cfg.input_mode().read(fd) == (uint8_t)InputMode::ANALOG
+             ? IoDirection::ANALOG : IoDirection::INPUT;
+    }
+
+    /// @return the configured direction of the pin, unknown values are
+    /// treated as @ref IoDirection::INPUT.
+    static IoDirection read_direction(const IoConfig &cfg, int fd)
+    {
+        IoDirection direction = (IoDirection)cfg.direction().read(fd);
+        if (direction == IoDirection::OUTPUT ||
+            direction == IoDirection::PULSE_COUNTER ||
+            direction == IoDirection::ANALOG)
+        {
+            return direction;
+        }
+        return IoDirection::INPUT;
+    }
+
+    /// @return default settings as input only pins do not support the pulse
+    /// counter.
+    static PulseCounterSettings read_pulse_settings(const InputConfig &cfg,
+                                                    int fd)
+    {
+        return PulseCounterSettings();
+    }
+
+    /// @return the configured pulse counter settings of the pin.
+    static PulseCounterSettings read_pulse_settings(const IoConfig &cfg,
+                                                    int fd)
+    {
+        PulseCounterSettings settings;
+        settings.mode = (PulseMode)cfg.pulse_mode().read(fd);
+        settings.threshold = cfg.pulse_threshold().read(fd);
+        settings.window_ms = cfg.pulse_window().read(fd);
+        settings.filter_ns = cfg.pulse_filter().read(fd);
+        return settings;
+    }
+
+    /// Resets the input mode of the pin to the default.
+    static void reset_direction(const InputConfig &cfg, int fd)
+    {
+        CDI_FACTORY_RESET(cfg.input_mode);
+    }
+
+    /// Resets the direction of the pin to the default.
+    static void reset_direction(const IoConfig &cfg, int fd)
+    {
+        CDI_FACTORY_RESET(cfg.direction);
+    }
+
+    /// No-op as input only pins do not have pulse counter settings.
+    static void reset_pulse_settings(const InputConfig &cfg, int fd)
+    {
+    }
+
+    /// Resets the pulse counter settings of the pin to the defaults.
+    static void reset_pulse_settings(const IoConfig &cfg, int fd)
+    {
+        CDI_FACTORY_RESET(cfg.pulse_mode);
+        CDI_FACTORY_RESET(cfg.pulse_threshold);
+        CDI_FACTORY_RESET(cfg.pulse_window);
+        CDI_FACTORY_RESET(cfg.pulse_filter);
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(ConfiguredIoPin);
+};
+
+/// Input only pin.
+typedef ConfiguredIoPin<InputConfig> ConfiguredInputPin;
+
+/// Configurable direction IO pin.
+typedef ConfiguredIoPin<IoConfig> ConfiguredGpioPin;
+
+/// Delivers debounced input transitions from an @ref InputEngine to the
+/// event producers of the configured input pins. This flow sleeps until the
+/// engine publishes a transition and produces one event per changed input.
+///
+/// Pins which exceed their event rate limit either drop the transition or,
+/// when collapsing, are retried once the rate limit allows another event. As
+/// the current level is produced only the latest state is sent regardless of
+/// how many transitions happened in between.
+class InputDispatcher : public StateFlowBase
+{
+public:
+    /// Constructor.
+    ///
+    /// @param node is the @ref openlcb::Node to send events from.
+    /// @param engine is the @ref InputEngine which provides the transitions.
+    InputDispatcher(openlcb::Node *node, InputEngine *engine)
+        : StateFlowBase(node->iface())
+        , node_(node)
+        , engine_(engine)
+        , retryTimer_(this)
+    {
+    }
+
+    /// Registers an IO pin for an input number.
+    ///
+    /// @param index is the input number in the @ref InputEngine.
+    /// @param pin is the @ref IoPin to deliver transitions to.
+    void register_pin(size_t index, IoPin *pin)
+    {
+        HASSERT(index < InputEngine::MAX_INPUTS);
+        pins_[index] = pin;
+    }
+
+    /// Starts delivering transitions, this should be called after all pins
+    /// have been registered.
+    void start()
+    {
+        engine_->set_listener(this);
+        start_flow(STATE(wait_for_changes));
+    }
+
+    /// @return number of events produced for input transitions.
+    uint32_t event_count()
+    {
+        return events_;
+    }
+
+    /// @return number of transitions not produced due to event rate limits.
+    uint32_t suppressed_count()
+    {
+        return suppressed_;
+    }
+
+private:
+    /// Timer used to retry inputs which were held back by their rate limit.
+    class RetryTimer : public ::Timer
+    {
+    public:
+        /// Constructor.
+        ///
+        /// @param parent is the owning @ref InputDispatcher.
+        RetryTimer(InputDispatcher *parent)
+            : ::Timer(parent->service()->executor()->active_timers())
+            , parent_(parent)
+        {
+        }
+
+        /// Moves the deferred inputs to the retry set and wakes up the
+        /// dispatcher.
+        ///
+        /// @return @ref NONE as the timer is restarted on demand.
+        long long timeout() override
+        {
+            parent_->retry_ |= parent_->deferred_;
+            parent_->deferred_ = 0;
+            parent_->retryPending_ = false;
+            parent_->engine_->wakeup_listener();
+            return NONE;
+        }
+
+    private:
+        /// Owning @ref InputDispatcher.
+        InputDispatcher *parent_;
+    };
+
+    /// Node to send events from.
+    openlcb::Node *node_;
+
+    /// @ref InputEngine which provides the transitions.
+    InputEngine *engine_;
+
+    /// Registered pins, indexed by input number.
+    IoPin *pins_[InputEngine::MAX_INPUTS]{};
+
+    /// Inputs which have changed and have not yet been delivered.
+    uint32_t changes_{0};
+
+    /// Inputs held back by their rate limit which are waiting for
+    /// @ref retryTimer_.
+    uint32_t deferred_{0};
+
+    /// Inputs held back by their rate limit which are ready to be retried.
+    uint32_t retry_{0};
+
+    /// Number of events produced for input transitions.
+    uint32_t events_{0};
+
+    /// Number of transitions not produced due to event rate limits.
+    uint32_t suppressed_{0};
+
+    /// True when @ref retryTimer_ is running.
+    bool retryPending_{false};
+
+    /// Wakes up this flow when deferred inputs can be retried.
+    RetryTimer retryTimer_;
+
+    /// Helper used for sending the events.
+    openlcb::WriteHelper helper_;
+
+    /// Notified when the event has been sent.
+    BarrierNotifiable n_;
+
+    /// Collects the pending transitions from the engine, if there are none
+    /// this will wait until the engine notifies this flow.
+    Action wait_for_changes()
+    {
+        changes_ = engine_->take_changes() | retry_;
+        retry_ = 0;
+        if (changes_)
+        {
+            return call_immediately(STATE(dispatch));
+        }
+        if (engine_->wait_for_changes())
+        {
+            return wait_and_call(STATE(wait_for_changes));
+        }
+        return call_immediately(STATE(wait_for_changes));
+    }
+
+    /// Produces the event for the next changed input.
+    Action dispatch()
+    {
+        while (changes_)
+        {
+            size_t index = __builtin_ctz(changes_);
+            changes_ &= ~(1U << index);
+            IoPin *pin = pins_[index];
+            if (!pin || !pin->is_input())
+            {
+                continue;
+            }
+            bool level = engine_->level(index);
+            if (level == pin->lastSent_)
+            {
+                // The input returned to the last produced state before the
+                // event was produced.
+                continue;
+            }
+            long long retry_at;
+            if (!pin->take_token(os_get_time_monotonic(), &retry_at))
+            {
+                pin->suppressed_++;
+                suppressed_++;
+                if (pin->mode_ == RateLimitMode::COLLAPSE)
+                {
+                    defer(index, retry_at);
+                }
+                continue;
+            }
+            deferred_ &= ~(1U << index);
+            pin->lastSent_ = level;
+            pin->events_++;
+            events_++;
+            EventIndex::produce(&helper_, node_, pin->input_event(level),
+                                n_.reset(this));
+            return wait_and_call(STATE(dispatch));
+        }
+        return call_immediately(STATE(wait_for_changes));
+    }
+
+    /// Holds back an input until its rate limit allows another event.
+    ///
+    /// @param index is the input number.
+    /// @param retry_at is the time when the input can be retried.
+    void defer(size_t index, long long retry_at)
+    {
+        deferred_ |= (1U << index);
+        if (!retryPending_)
+        {
+            retryPending_ = true;
+            retryTimer_.start(
+                std::max<long long>(retry_at - os_get_time_monotonic(), 0));
+        }
+        // When the timer is already running the input will be retried when
+        // it expires and deferred again if it is still too early.
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(InputDispatcher);
+};
+
+} // namespace esp32io
+
+#endif // IO_PIN_HXX_
@@ -0,0 +1,278 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file IsrInputEngine.hxx
+ *
+ * Edge interrupt driven input engine with time based debounce.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef ISR_INPUT_ENGINE_HXX_
+#define ISR_INPUT_ENGINE_HXX_
+
+#include "InputEngine.hxx"
+
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <executor/StateFlow.hxx>
+#include <freertos/FreeRTOS.h>
+#include <limits>
+#include <utils/logging.h>
+
+namespace esp32io
+{
+
+/// @ref InputEngine which uses GPIO edge interrupts to detect input changes.
+///
+/// The interrupt handler only records the time of the most recent edge for
+/// the pin and marks the pin as settling. The first edge on an idle engine
+/// wakes up the debounce flow, which sleeps until the earliest pin is expected
+/// to have been stable for its debounce time. A pin is accepted once no edges
+/// have been seen for the debounce time, and a transition is published only
+/// when the settled level differs from the previously accepted level. Edges
+/// which arrive while the flow is sleeping do not wake it up.
+///
+/// The debounce flow should run on a dedicated executor so that the OpenLCB
+/// executor is only woken up by @ref InputEngine::publish.
+///
+/// NOTE: GPIO36 and GPIO39 can report spurious edges when the ADC or WiFi
+/// are active (ESP32 errata 3.11), these are filtered out by the level check
+/// after the debounce time has elapsed.
+class IsrInputEngine : public InputEngine, public StateFlowBase
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service that will execute the debounce
+    /// flow.
+    /// @param pins is the array of GPIO pins, the index into this array is
+    /// the input number.
+    /// @param count is the number of entries in @param pins.
+    IsrInputEngine(Service *service, const gpio_num_t *pins, size_t count)
+        : StateFlowBase(service)
+        , count_(count)
+    {
+        HASSERT(count <= MAX_INPUTS);
+        for (size_t index = 0; index < count_; index++)
+        {
+            pins_[index].engine = this;
+            pins_[index].gpio = pins[index];
+            pins_[index].mask = 1U << index;
+        }
+    }
+
+    /// Installs the GPIO interrupt handlers, all interrupts remain disabled
+    /// until the input is enabled via @ref configure.
+    ///
+    /// @return ESP_OK if the interrupt handlers were installed, any other
+    /// value indicates failure.
+    esp_err_t hw_init()
+    {
+        // the ISR service may have already been installed by another driver.
+        esp_err_t res = gpio_install_isr_service(0);
+        if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+        {
+            LOG_ERROR("[ISR-Input] Failed to install GPIO ISR service: %s",
+                      esp_err_to_name(res));
+            return res;
+        }
+        for (size_t index = 0; index < count_; index++)
+        {
+            gpio_intr_disable(pins_[index].gpio);
+            gpio_set_intr_type(pins_[index].gpio, GPIO_INTR_ANYEDGE);
+            res = gpio_isr_handler_add(pins_[index].gpio, edge_isr,
+                                       &pins_[index]);
+            if (res != ESP_OK)
+            {
+                LOG_ERROR("[ISR-Input] Failed to add ISR for GPIO %d: %s",
+                          pins_[index].gpio, esp_err_to_name(res));
+                return res;
+            }
+        }
+        LOG(INFO, "[ISR-Input] %zu inputs registered", count_);
+        start_flow(STATE(evaluate));
+        return ESP_OK;
+    }
+
+    /// Configures the debounce behavior of an input.
+    ///
+    /// @param index is the input number.
+    /// @param debounce_ms is the time in milliseconds that the input must be
+    /// stable before a transition is published.
+    /// @param enabled is true if the edge interrupt should be enabled.
+    void configure(size_t index, uint16_t debounce_ms, bool enabled) override
+    {
+        HASSERT(index < count_);
+        Pin &pin = pins_[index];
+        gpio_intr_disable(pin.gpio);
+        portENTER_CRITICAL(&lock_);
+        pin.debounceUs = debounce_ms * 1000U;
+        settling_ &= ~pin.mask;
+        portEXIT_CRITICAL(&lock_);
+        if (enabled)
+        {
+            // The interrupt is enabled before reading the level so that an
+            // edge in between is debounced rather than lost.
+            gpio_intr_enable(pin.gpio);
+            bool level = gpio_get_level(pin.gpio);
+            portENTER_CRITICAL(&lock_);
+            stable_ = level ? (stable_ | pin.mask) : (stable_ & ~pin.mask);
+            portEXIT_CRITICAL(&lock_);
+            set_level(index, level);
+        }
+    }
+
+    /// @return number of edge interrupts received.
+    uint32_t edge_count()
+    {
+        return edges_;
+    }
+
+private:
+    /// Per-pin state.
+    struct Pin
+    {
+        /// Owning engine, used by the interrupt handler.
+        IsrInputEngine *engine;
+
+        /// GPIO pin number.
+        gpio_num_t gpio;
+
+        /// Bit for this pin in the engine bit masks.
+        uint32_t mask;
+
+        /// Debounce time in microseconds.
+        uint32_t debounceUs{DEFAULT_DEBOUNCE_USEC};
+
+        /// Time of the most recent edge, from esp_timer_get_time().
+        int64_t lastEdge{0};
+    };
+
+    /// Debounce time used until the input has been configured.
+    static constexpr uint32_t DEFAULT_DEBOUNCE_USEC = 90000;
+
+    /// Per-pin state, indexed by input number.
+    Pin pins_[MAX_INPUTS];
+
+    /// Number of inputs in use.
+    const size_t count_;
+
+    /// Lock protecting the state shared with the interrupt handler.
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    /// Inputs which have seen an edge and have not yet settled.
+    uint32_t settling_{0};
+
+    /// Accepted levels of all inputs.
+    uint32_t stable_{0};
+
+    /// True when the debounce flow is waiting for the next edge.
+    bool idle_{false};
+
+    /// Number of edge interrupts received.
+    uint32_t edges_{0};
+
+    /// Timer used for waiting until the next input settles.
+    StateFlowTimer timer_{this};
+
+    /// GPIO edge interrupt handler.
+    ///
+    /// @param arg is the @ref Pin which generated the interrupt.
+    static void edge_isr(void *arg)
+    {
+        Pin *pin = static_cast<Pin *>(arg);
+        IsrInputEngine *engine = pin->engine;
+        int64_t now = esp_timer_get_time();
+        bool wakeup = false;
+        portENTER_CRITICAL_ISR(&engine->lock_);
+        pin->lastEdge = now;
+        engine->settling_ |= pin->mask;
+        engine->edges_++;
+        if (engine->idle_)
+        {
+            engine->idle_ = false;
+            wakeup = true;
+        }
+        portEXIT_CRITICAL_ISR(&engine->lock_);
+        if (wakeup)
+        {
+            engine->notify_from_isr();
+        }
+    }
+
+    /// Accepts the level of all inputs which have been stable for their
+    /// debounce time and waits for the next input to settle or the next edge.
+    Action evaluate()
+    {
+        int64_t now = esp_timer_get_time();
+        int64_t next = std::numeric_limits<int64_t>::max();
+        uint32_t changed = 0;
+        uint32_t levels;
+        portENTER_CRITICAL(&lock_);
+        uint32_t settling = settling_;
+        while (settling)
+        {
+            size_t index = __builtin_ctz(settling);
+            settling &= ~(1U << index);
+            Pin &pin = pins_[index];
+            int64_t deadline = pin.lastEdge + pin.debounceUs;
+            if (now < deadline)
+            {
+                next = std::min(next, deadline);
+                continue;
+            }
+            settling_ &= ~pin.mask;
+            bool level = gpio_get_level(pin.gpio);
+            if (level != ((stable_ & pin.mask) != 0))
+            {
+                stable_ ^= pin.mask;
+                changed |= pin.mask;
+            }
+        }
+        levels = stable_;
+        bool idle = idle_ = (settling_ == 0);
+        portEXIT_CRITICAL(&lock_);
+
+        if (changed)
+        {
+            publish(changed, levels);
+        }
+        if (!idle)
+        {
+            return sleep_and_call(&timer_, USEC_TO_NSEC(next - now),
+                                  STATE(evaluate));
+        }
+        return wait_and_call(STATE(evaluate));
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(IsrInputEngine);
+};
+
+} // namespace esp32io
+
+#endif // ISR_INPUT_ENGINE_HXX_
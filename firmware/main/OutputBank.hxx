@@ -0,0 +1,186 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file OutputBank.hxx
+ *
+ * Batched GPIO output updates.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef OUTPUT_BANK_HXX_
+#define OUTPUT_BANK_HXX_
+
+#include <driver/gpio.h>
+#include <executor/StateFlow.hxx>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+
+namespace esp32io
+{
+
+/// Collects GPIO output changes and applies them together.
+///
+/// Output changes are not written to the pin immediately, instead they are
+/// accumulated in pending set and clear masks. The first change within an
+/// executor pass schedules a flush which writes all pending changes using
+/// the GPIO_OUT_W1TS / GPIO_OUT_W1TC registers (and GPIO_OUT1_W1TS /
+/// GPIO_OUT1_W1TC for GPIO 32 and above), so all outputs changed by a group
+/// of events switch at the same time.
+///
+/// NOTE: All methods must be called from the executor of the @ref Service
+/// provided in the constructor.
+class OutputBank : public StateFlowBase
+{
+public:
+    /// Maximum number of pins supported.
+    static constexpr size_t MAX_PINS = 32;
+
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service that will flush pending changes.
+    /// @param pins is the array of GPIO pins, the index into this array is
+    /// the pin number used by @ref write.
+    /// @param count is the number of entries in @param pins.
+    OutputBank(Service *service, const gpio_num_t *pins, size_t count)
+        : StateFlowBase(service)
+        , count_(count)
+    {
+        HASSERT(count <= MAX_PINS);
+        for (size_t index = 0; index < count_; index++)
+        {
+            masks_[index] = 1ULL << pins[index];
+        }
+    }
+
+    /// Requests a change of an output pin.
+    ///
+    /// @param index is the pin number.
+    /// @param value is the new state of the pin.
+    void write(size_t index, bool value)
+    {
+        HASSERT(index < count_);
+        uint64_t mask = masks_[index];
+        updates_++;
+        if (value)
+        {
+            state_ |= mask;
+            pendingSet_ |= mask;
+            pendingClear_ &= ~mask;
+        }
+        else
+        {
+            state_ &= ~mask;
+            pendingClear_ |= mask;
+            pendingSet_ &= ~mask;
+        }
+        if (!flushPending_)
+        {
+            flushPending_ = true;
+            start_flow(STATE(flush));
+        }
+    }
+
+    /// @param index is the pin number.
+    /// @return the last requested state of the pin.
+    bool read(size_t index)
+    {
+        HASSERT(index < count_);
+        return state_ & masks_[index];
+    }
+
+    /// @return number of output changes requested via @ref write.
+    uint32_t update_count()
+    {
+        return updates_;
+    }
+
+    /// @return number of times pending changes have been written.
+    uint32_t flush_count()
+    {
+        return flushes_;
+    }
+
+private:
+    /// GPIO bit mask for each pin number.
+    uint64_t masks_[MAX_PINS];
+
+    /// Number of pins in use.
+    const size_t count_;
+
+    /// Last requested state of all pins.
+    uint64_t state_{0};
+
+    /// Pins to be set by the next flush.
+    uint64_t pendingSet_{0};
+
+    /// Pins to be cleared by the next flush.
+    uint64_t pendingClear_{0};
+
+    /// True when a flush has been scheduled.
+    bool flushPending_{false};
+
+    /// Number of output changes requested via @ref write.
+    uint32_t updates_{0};
+
+    /// Number of times pending changes have been written.
+    uint32_t flushes_{0};
+
+    /// Writes all pending changes to the GPIO registers.
+    Action flush()
+    {
+        if ((uint32_t)pendingSet_)
+        {
+            REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)pendingSet_);
+        }
+        if ((uint32_t)pendingClear_)
+        {
+            REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)pendingClear_);
+        }
+        if (pendingSet_ >> 32)
+        {
+            REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(pendingSet_ >> 32));
+        }
+        if (pendingClear_ >> 32)
+        {
+            REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(pendingClear_ >> 32));
+        }
+        pendingSet_ = 0;
+        pendingClear_ = 0;
+        flushPending_ = false;
+        flushes_++;
+        return exit();
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(OutputBank);
+};
+
+} // namespace esp32io
+
+#endif // OUTPUT_BANK_HXX_
@@ -32,17 +32,31 @@
  * @date 6 Feburary 2021
  */
 
-#include <driver/i2c.h>
+#include "I2CBus.hxx"
+#include "I2CWorker.hxx"
+
 #include <esp_check.h>
+#include <executor/StateFlow.hxx>
 #include <freertos_drivers/common/PWM.hxx>
 #include <os/OS.hxx>
 #include <sys/ioctl.h>
 #include <utils/Atomic.hxx>
+#include <vector>
 
 class PCA9685PWMBit;
 
-/// Aggregate of 16 PWM channels for a PCA9685 I2C connected device.
-class PCA9685PWM
+/// Aggregate of PWM channels for all PCA9685 I2C connected devices found on
+/// the I2C bus. Each device provides 16 channels, channel numbers are assigned
+/// sequentially in order of increasing device address.
+///
+/// Duty cycle updates are not written to the device immediately, instead they
+/// are applied to a shadow copy of the LEDn_ON/LEDn_OFF registers and the
+/// modified channels are tracked in a dirty bitmap. The first update within an
+/// executor pass schedules a flush which will write all pending changes using
+/// the fewest possible auto-increment burst writes. The burst writes are
+/// handed to an @ref I2CWorker so the caller's executor is never blocked on
+/// I2C traffic.
+class PCA9685PWM : public StateFlowBase
 {
 public:
     /// Maximum number of PWM channels supported by the PCA9685.
@@ -51,107 +65,168 @@ public:
     /// Maximum number of PWM counts supported by the PCA9685.
     static constexpr size_t MAX_PWM_COUNTS = 4096;
 
+    /// First I2C address which can be used by a PCA9685.
+    static constexpr uint8_t FIRST_ADDRESS = 0x40;
+
+    /// Last I2C address which can be used by a PCA9685.
+    static constexpr uint8_t LAST_ADDRESS = 0x7F;
+
+    /// Default LED All Call I2C address, all PCA9685 devices will respond to
+    /// this address after power on.
+    static constexpr uint8_t ALL_CALL_ADDRESS = 0x70;
+
     /// Constructor.
-    PCA9685PWM(uint8_t sda, uint8_t scl, uint8_t address, uint16_t frequency)
-        : addr_(address)
-        , sda_(static_cast<gpio_num_t>(sda))
-        , scl_(static_cast<gpio_num_t>(scl))
+    ///
+    /// @param service is the @ref Service that will flush pending updates.
+    /// @param worker is the @ref I2CWorker used for channel updates.
+    /// @param frequency is the PWM frequency to configure.
+    /// @param max_devices is the maximum number of devices to use.
+    /// @param bus_speed is the I2C bus speed to use when all devices on the
+    /// bus are PCA9685 devices.
+    PCA9685PWM(Service *service, I2CWorker *worker, uint16_t frequency,
+               size_t max_devices, uint32_t bus_speed)
+        : StateFlowBase(service)
+        , worker_(worker)
+        , bus_(worker->bus())
         , frequency_(frequency)
+        , maxDevices_(max_devices)
+        , busSpeed_(bus_speed)
     {
-        duty_.fill(0);
     }
 
-    /// Initialize device.
-    /// @return ESP_OK if the hardware was initialized successfully, other
-    /// values for failures.
-    esp_err_t hw_init()
+    /// @return number of PWM channels available on all discovered devices.
+    size_t num_channels()
     {
-        i2c_config_t i2c_config =
-        {
-            .mode = I2C_MODE_MASTER,
-            .sda_io_num = sda_,
-            .scl_io_num = scl_,
-            .sda_pullup_en = GPIO_PULLUP_ENABLE,
-            .scl_pullup_en = GPIO_PULLUP_ENABLE,
-            .master =
-            {
-                .clk_speed = I2C_BUS_SPEED
-            },
-            .clk_flags = I2C_SCLK_SRC_FLAG_FOR_NOMAL
-        };
+        return devices_.size() * NUM_CHANNELS;
+    }
+
+    /// @return number of I2C write transactions issued for channel updates.
+    uint32_t transaction_count()
+    {
+        return transactions_;
+    }
+
+    /// @return number of bytes (register address included) written to the
+    /// device for channel updates.
+    uint32_t byte_count()
+    {
+        return bytes_;
+    }
+
+    /// @return number of channel updates requested via @ref PCA9685PWMBit.
+    uint32_t update_count()
+    {
+        return updates_;
+    }
+
+    /// @return number of I2C write transactions which have failed.
+    uint32_t error_count()
+    {
+        return errors_;
+    }
 
+    /// Initialize all PCA9685 devices on the I2C bus.
+    ///
+    /// The I2C bus is scanned for devices, any device in the PCA9685 address
+    /// range which identifies as a PCA9685 will be initialized. When no other
+    /// devices are present on the bus the bus speed will be increased.
+    ///
+    /// @return ESP_OK if at least one device was initialized successfully,
+    /// other values for failures.
+    ///
+    /// NOTE: The @ref I2CBus must be initialized before calling this method.
+    /// This method uses the bus directly and is intended to be called before
+    /// the executor has been started.
+    esp_err_t hw_init()
+    {
         // ensure the PWM frequency is within normal range.
         if (frequency_ > (INTERNAL_CLOCK_FREQUENCY / (4096 * 4)))
         {
-            ESP_LOGE(TAG, "[%02x] Invalid PWM frequency provided: %d", addr_,
-                     frequency_);
+            ESP_LOGE(TAG, "Invalid PWM frequency provided: %d", frequency_);
             return ESP_ERR_INVALID_ARG;
         }
 
-        LOG(INFO, "[PCA9685] Configuring I2C (scl:%d, sda:%d)", scl_, sda_);
-        ESP_RETURN_ON_ERROR(i2c_param_config(I2C_PORT, &i2c_config), TAG,
-            "Failed to configure I2C bus");
-        ESP_RETURN_ON_ERROR(i2c_driver_install(I2C_PORT, I2C_MODE_MASTER, 0, 0, 0),
-            TAG, "Failed to install I2C driver");
-
-        if (ping_device(addr_) != ESP_OK)
+        // Scan the I2C bus and dump the output of devices that respond
+        std::string scanresults =
+            "     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n"
+            "00:         ";
+        scanresults.reserve(256);
+        std::vector<uint8_t> found;
+        bool other_devices = false;
+        for (uint8_t addr = 3; addr < 0x78; addr++)
         {
-            // Scan the I2C bus and dump the output of devices that respond
-            std::string scanresults =
-                "     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n"
-                "00:         ";
-            scanresults.reserve(256);
-            for (uint8_t addr = 3; addr < 0x78; addr++)
+            if (addr % 16 == 0)
             {
-                if (addr % 16 == 0)
-                {
-                    scanresults += "\n" + int64_to_string_hex(addr) + ":";
-                }
-                esp_err_t ret = ping_device(addr);
-                if (ret == ESP_OK)
-                {
-                    scanresults += int64_to_string_hex(addr);
-                }
-                else if (ret == ESP_ERR_TIMEOUT)
+                scanresults += "\n" + int64_to_string_hex(addr) + ":";
+            }
+            esp_err_t ret = bus_->ping(addr);
+            if (ret == ESP_OK)
+            {
+                scanresults += int64_to_string_hex(addr);
+                if (is_pca9685(addr))
                 {
-                    scanresults += " ??";
+                    found.push_back(addr);
                 }
-                else
+                else if (addr != ALL_CALL_ADDRESS)
                 {
-                    scanresults += " --";
+                    other_devices = true;
                 }
             }
-            LOG(WARNING, "[PCA9685] I2C devices:\n%s", scanresults.c_str());
-            return ESP_ERR_NOT_FOUND;    
+            else if (ret == ESP_ERR_TIMEOUT)
+            {
+                scanresults += " ??";
+            }
+            else
+            {
+                scanresults += " --";
+            }
+        }
+        LOG(INFO, "[PCA9685] I2C devices:\n%s", scanresults.c_str());
+        if (found.empty())
+        {
+            LOG(WARNING, "[PCA9685] No devices found!");
+            return ESP_ERR_NOT_FOUND;
         }
 
-        MODE1_REGISTER mode1;
-        mode1.auto_increment = 1;
-        mode1.sleep = 1;
-        mode1.all_call = 0;
-        LOG(VERBOSE, "[%02x] Configuring MODE1 register: %02x", addr_,
-            mode1.value);
-        ESP_RETURN_ON_ERROR(register_write(REGISTERS::MODE1, mode1.value), TAG,
-            "Failed to write MODE1 register");
-
-        uint8_t prescaler =
-            (INTERNAL_CLOCK_FREQUENCY / (4096 * frequency_)) - 1;
-        ESP_LOGD(TAG, "[%02x] Configuring pre-scaler register: %d", addr_,
-                 prescaler);
-        ESP_RETURN_ON_ERROR(register_write(REGISTERS::PRE_SCALE, prescaler),
-            TAG, "Failed to write PRESCALE register");
-
-        /* if using internal clock */
-        mode1.sleep = 0;
-        ESP_RETURN_ON_ERROR(register_write(REGISTERS::MODE1, mode1.value), TAG,
-            "Failed to write MODE1 register");
+        // The bus is scanned at standard speed, only increase the speed when
+        // all devices on the bus are known to support it.
+        if (!other_devices)
+        {
+            LOG(INFO, "[PCA9685] Increasing I2C bus speed to %" PRIu32 " Hz",
+                busSpeed_);
+            ESP_RETURN_ON_ERROR(bus_->set_speed(busSpeed_), TAG,
+                "Failed to set I2C bus speed");
+        }
+        else
+        {
+            LOG(WARNING,
+                "[PCA9685] Non-PCA9685 device(s) found, bus speed unchanged");
+        }
 
-        MODE2_REGISTER mode2;
-        mode2.output_check = 1;
-        ESP_RETURN_ON_ERROR(register_write(REGISTERS::MODE2, mode2.value), TAG,
-            "Failed to write MODE2 register");
+        for (uint8_t addr : found)
+        {
+            if (devices_.size() >= maxDevices_)
+            {
+                LOG(WARNING, "[PCA9685] Ignoring device at %02x, limit of %zu "
+                    "devices reached", addr, maxDevices_);
+                continue;
+            }
+            if (init_device(addr) == ESP_OK)
+            {
+                devices_.emplace_back(addr);
+            }
+        }
+        if (devices_.empty())
+        {
+            return ESP_FAIL;
+        }
+        LOG(INFO, "[PCA9685] %zu device(s) initialized, %zu channels",
+            devices_.size(), num_channels());
 
-        // Device is ready to use
+        // Devices are ready to use, flush any updates that arrived before the
+        // devices were initialized.
+        ready_ = true;
+        schedule_flush();
         return ESP_OK;
     }
 
@@ -167,32 +242,56 @@ private:
     /// Default internal clock frequency, 25MHz.
     static constexpr uint32_t INTERNAL_CLOCK_FREQUENCY = 25000000;
 
-    /// Maximum number of ticks to wait for an I2C transaction to complete.
-    static constexpr TickType_t MAX_I2C_WAIT_TICKS = pdMS_TO_TICKS(100);
-
-    /// I2C port to use.
-    static constexpr i2c_port_t I2C_PORT = I2C_NUM_0;
-
-    /// I2C Bus speed.
-    static constexpr uint32_t I2C_BUS_SPEED = 100000;
+    /// Maximum number of clean channels that will be included in a burst write
+    /// to join two runs of dirty channels. Re-writing a single clean channel
+    /// costs four bytes which is cheaper than the START, address, register
+    /// and STOP overhead of an additional I2C transaction.
+    static constexpr size_t BURST_MERGE_GAP = 1;
 
-    /// I2C address of the device
-    const uint8_t addr_;
+    /// Bitmap value with all channels of a device set.
+    static constexpr uint16_t ALL_CHANNELS = 0xFFFF;
 
-    /// SDA pin to use for I2C communication.
-    const gpio_num_t sda_;
+    /// @ref I2CWorker used for channel updates.
+    I2CWorker *worker_;
 
-    /// SCL pin to use for I2C communication.
-    const gpio_num_t scl_;
+    /// @ref I2CBus used for device initialization.
+    I2CBus *bus_;
 
     /// Desired PWM frequency.
     const uint16_t frequency_;
 
+    /// Maximum number of devices to initialize.
+    const size_t maxDevices_;
+
+    /// I2C bus speed to use when only PCA9685 devices are on the bus.
+    const uint32_t busSpeed_;
+
     /// Allow access to private members
     friend PCA9685PWMBit;
 
-    /// local cache of the duty cycles
-    std::array<uint16_t, NUM_CHANNELS> duty_;
+    /// Set to true once the devices have been initialized.
+    bool ready_{false};
+
+    /// Set to true when the flush flow has been scheduled.
+    bool flushPending_{false};
+
+    /// Index of the device with an in-flight burst write.
+    size_t inflightDevice_{0};
+
+    /// Bitmap of channels included in the in-flight burst write.
+    uint16_t inflight_{0};
+
+    /// Number of I2C write transactions issued for channel updates.
+    uint32_t transactions_{0};
+
+    /// Number of bytes written to the device for channel updates.
+    uint32_t bytes_{0};
+
+    /// Number of channel updates requested.
+    uint32_t updates_{0};
+
+    /// Number of I2C write transactions which have failed.
+    uint32_t errors_{0};
 
     /// Device register offsets.
     enum REGISTERS
@@ -203,10 +302,17 @@ private:
         /// MODE2 register address.
         MODE2 = 0x01,
 
+        /// LED All Call I2C address register.
+        ALLCALLADR = 0x05,
+
         /// OUTPUT 0 first register address. This is used as a starting offset
         /// for all other output registers.
         LED0_ON_L = 0x6,
 
+        /// First register of the ALL_LED_ON/ALL_LED_OFF registers, writes to
+        /// these registers apply to all outputs of the device.
+        ALL_LED_ON_L = 0xFA,
+
         /// Register address used to turn off all outputs.
         ALL_OFF = 0xFC,
 
@@ -310,72 +416,167 @@ private:
         Off off;
     };
 
+    /// State of a single PCA9685 device.
+    struct Device
+    {
+        /// Constructor.
+        ///
+        /// @param address is the I2C address of the device.
+        Device(uint8_t address) : address(address)
+        {
+            duty.fill(0);
+            // At power on all outputs are in the full OFF state, mirror that
+            // in the shadow registers so only real changes are written.
+            for (auto &reg : shadow)
+            {
+                reg.off.full_off = 1;
+            }
+        }
+
+        /// I2C address of the device.
+        uint8_t address;
+
+        /// Bitmap of channels which have pending changes in @ref shadow.
+        uint16_t dirty{0};
+
+        /// Set when a write to the device failed during the current flush,
+        /// the device is skipped for the rest of the flush.
+        bool failed{false};
+
+        /// local cache of the duty cycles
+        std::array<uint16_t, NUM_CHANNELS> duty;
+
+        /// Shadow copy of the LEDn_ON/LEDn_OFF registers for all channels,
+        /// this is laid out identically to the device registers to allow
+        /// burst writes.
+        std::array<OUTPUT_STATE_REGISTER, NUM_CHANNELS> shadow;
+    };
+
+    /// All initialized devices, ordered by I2C address.
+    std::vector<Device> devices_;
 
-    /// Detect if the PCA9685 device is present or not.
-    /// @param address I2C device address to ping.
-    /// @return ESP_OK if the device responds, any other value indicates failure.
-    esp_err_t ping_device(uint8_t address)
+    /// Checks if the device at the provided address is a PCA9685.
+    ///
+    /// @param address is the I2C address to check.
+    /// @return true if the device is a PCA9685, false otherwise.
+    bool is_pca9685(uint8_t address)
     {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        esp_err_t err = i2c_master_cmd_begin(I2C_PORT, cmd, MAX_I2C_WAIT_TICKS);
-        i2c_cmd_link_delete(cmd);
-        return err;
+        if (address < FIRST_ADDRESS || address > LAST_ADDRESS ||
+            address == ALL_CALL_ADDRESS)
+        {
+            return false;
+        }
+        // The ALLCALLADR register defaults to the All Call address and is not
+        // modified by this driver, use it to identify the device.
+        uint8_t value = 0;
+        if (bus_->read(address, REGISTERS::ALLCALLADR, &value, 1) != ESP_OK)
+        {
+            return false;
+        }
+        return value == (ALL_CALL_ADDRESS << 1);
+    }
+
+    /// Configures a single device.
+    ///
+    /// @param address is the I2C address of the device.
+    /// @return ESP_OK if the device was configured, other values for failures.
+    esp_err_t init_device(uint8_t address)
+    {
+        MODE1_REGISTER mode1;
+        mode1.auto_increment = 1;
+        mode1.sleep = 1;
+        mode1.all_call = 0;
+        LOG(VERBOSE, "[%02x] Configuring MODE1 register: %02x", address,
+            mode1.value);
+        ESP_RETURN_ON_ERROR(
+            register_write(address, REGISTERS::MODE1, mode1.value), TAG,
+            "Failed to write MODE1 register");
+
+        uint8_t prescaler =
+            (INTERNAL_CLOCK_FREQUENCY / (4096 * frequency_)) - 1;
+        ESP_LOGD(TAG, "[%02x] Configuring pre-scaler register: %d", address,
+                 prescaler);
+        ESP_RETURN_ON_ERROR(
+            register_write(address, REGISTERS::PRE_SCALE, prescaler), TAG,
+            "Failed to write PRESCALE register");
+
+        /* if using internal clock */
+        mode1.sleep = 0;
+        ESP_RETURN_ON_ERROR(
+            register_write(address, REGISTERS::MODE1, mode1.value), TAG,
+            "Failed to write MODE1 register");
+
+        MODE2_REGISTER mode2;
+        mode2.output_check = 1;
+        ESP_RETURN_ON_ERROR(
+            register_write(address, REGISTERS::MODE2, mode2.value), TAG,
+            "Failed to write MODE2 register");
+
+        // Return all outputs to the power on (full OFF) state which matches
+        // the initial shadow registers, the device may not have been reset
+        // if only the ESP32 was restarted.
+        OUTPUT_STATE_REGISTER all_off;
+        all_off.off.full_off = 1;
+        uint8_t payload[sizeof(OUTPUT_STATE_REGISTER) + 1];
+        payload[0] = REGISTERS::ALL_LED_ON_L;
+        memcpy(payload + 1, &all_off, sizeof(OUTPUT_STATE_REGISTER));
+        ESP_RETURN_ON_ERROR(bus_->write(address, payload, sizeof(payload)),
+            TAG, "Failed to write ALL_LED registers");
+
+        return ESP_OK;
     }
 
     /// Set the pwm duty cycle
-    /// @param channel channel index (0 through 15)
+    /// @param channel channel index (0 through @ref num_channels() - 1)
     /// @param counts counts for PWM duty cycle
-    esp_err_t set_pwm_duty(size_t channel, uint16_t counts)
+    ///
+    /// NOTE: This must be called from the executor of the @ref Service
+    /// provided in the constructor.
+    void set_pwm_duty(size_t channel, uint16_t counts)
     {
-        HASSERT(channel < NUM_CHANNELS);
-
-        duty_[channel] = counts;
-        return write_pwm_duty(channel, counts);
+        HASSERT(channel < num_channels());
+
+        Device &device = devices_[channel / NUM_CHANNELS];
+        size_t index = channel % NUM_CHANNELS;
+        updates_++;
+        // The duty cycle is compared rather than the register values since
+        // the shadow may hold the common phase written via ALL_LED.
+        if (device.duty[index] != counts)
+        {
+            device.duty[index] = counts;
+            device.shadow[index] = encode_pwm_duty(index, counts);
+            device.dirty |= (1 << index);
+            schedule_flush();
+        }
     }
 
     /// Get the pwm duty cycle
-    /// @param channel channel index (0 through 15)
+    /// @param channel channel index (0 through @ref num_channels() - 1)
     /// @return counts for PWM duty cycle
     uint16_t get_pwm_duty(size_t channel)
     {
-        HASSERT(channel < NUM_CHANNELS);
-        return duty_[channel];
+        HASSERT(channel < num_channels());
+        return devices_[channel / NUM_CHANNELS].duty[channel % NUM_CHANNELS];
     }
 
     /// Write to an I2C register.
+    /// @param address I2C address of the device
     /// @param reg Register to write to
     /// @param data data to write
     /// @return returns write status
-    esp_err_t register_write(REGISTERS reg, uint8_t data)
+    esp_err_t register_write(uint8_t address, REGISTERS reg, uint8_t data)
     {
         uint8_t payload[] = {reg, data};
-        return i2c_master_write_to_device(I2C_PORT, addr_, payload,
-                                          sizeof(payload), MAX_I2C_WAIT_TICKS);
+        return bus_->write(address, payload, sizeof(payload));
     }
 
-    /// Write to multiple sequential I2C registers.
-    /// @param reg Register to start write to
-    /// @param data array of data to write
-    /// @param count number of data registers to write in sequence
-    /// @return returns write status
-    esp_err_t register_write_multiple(REGISTERS reg, void *data, size_t count)
-    {
-        uint8_t payload[count + 1];
-        payload[0] = addr_;
-        memcpy(payload + 1, data, count);
-        return i2c_master_write_to_device(I2C_PORT, addr_, payload,
-                                          sizeof(payload), MAX_I2C_WAIT_TICKS);
-    }
-
-    /// Set the pwm duty cycle
-    /// @param channel channel index (0 through 15)
+    /// Converts a duty cycle into the LEDn_ON/LEDn_OFF register values.
+    /// @param channel channel index on the device (0 through 15), this
+    /// selects the phase of the ON time.
     /// @param counts counts for PWM duty cycle
-    esp_err_t write_pwm_duty(size_t channel, uint16_t counts)
+    /// @return register values in device (little-endian) byte order.
+    OUTPUT_STATE_REGISTER encode_pwm_duty(size_t channel, uint16_t counts)
     {
-
         OUTPUT_STATE_REGISTER reg_value;
         if (counts >= MAX_PWM_COUNTS)
         {
@@ -394,14 +595,132 @@ private:
             reg_value.on.counts = (channel * 256);
             reg_value.off.counts = (counts + (channel * 256)) % 0x1000;
         }
-        REGISTERS output_register =
-            (REGISTERS)(REGISTERS::LED0_ON_L + (channel << 2));
-        ESP_LOGV(TAG, "[%02x:%d] Setting PWM to %d:%d", addr_, channel,
-                 reg_value.on.value, reg_value.off.value);
+        ESP_LOGV(TAG, "[%d] Setting PWM to %d:%d", channel, reg_value.on.value,
+                 reg_value.off.value);
         reg_value.on.value = htole16(reg_value.on.value);
         reg_value.off.value = htole16(reg_value.off.value);
-        return register_write_multiple((REGISTERS)output_register, &reg_value,
-                                       sizeof(OUTPUT_STATE_REGISTER));
+        return reg_value;
+    }
+
+    /// Schedules the flush of pending updates if it is not already pending.
+    void schedule_flush()
+    {
+        if (ready_ && !flushPending_)
+        {
+            flushPending_ = true;
+            start_flow(STATE(flush));
+        }
+    }
+
+    /// Checks if all channels of a device have the same duty cycle.
+    ///
+    /// @param device is the @ref Device to check.
+    /// @return true if all channels share the same duty cycle.
+    bool all_channels_equal(Device &device)
+    {
+        for (size_t channel = 1; channel < NUM_CHANNELS; channel++)
+        {
+            if (device.duty[channel] != device.duty[0])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Writes the next burst of dirty channels to the devices. Adjacent dirty
+    /// channels (and those separated by at most @ref BURST_MERGE_GAP clean
+    /// channels) are combined into a single auto-increment burst write. When
+    /// all channels of a device are dirty and have the same duty cycle the
+    /// ALL_LED registers are used instead, this gives up the per-channel
+    /// phase stagger since all outputs share the one register value.
+    ///
+    /// A device which fails a write is skipped for the rest of the flush so
+    /// that the remaining devices are still written, its channels are retried
+    /// with the next update.
+    Action flush()
+    {
+        size_t index = 0;
+        while (index < devices_.size() &&
+               (!devices_[index].dirty || devices_[index].failed))
+        {
+            index++;
+        }
+        if (index >= devices_.size())
+        {
+            for (auto &device : devices_)
+            {
+                device.failed = false;
+            }
+            flushPending_ = false;
+            return exit();
+        }
+        Device &device = devices_[index];
+        std::string payload;
+        if (device.dirty == ALL_CHANNELS && all_channels_equal(device))
+        {
+            // Channel 0 has no phase offset, use its encoding for all
+            // channels so the shadow matches what the device will hold.
+            device.shadow.fill(encode_pwm_duty(0, device.duty[0]));
+            payload.push_back(REGISTERS::ALL_LED_ON_L);
+            payload.append((const char *)&device.shadow[0],
+                           sizeof(OUTPUT_STATE_REGISTER));
+            inflight_ = ALL_CHANNELS;
+            ESP_LOGV(TAG, "[%02x] Writing all channels", device.address);
+        }
+        else
+        {
+            size_t first = __builtin_ctz(device.dirty);
+            size_t last = first;
+            for (size_t channel = first + 1; channel < NUM_CHANNELS; channel++)
+            {
+                if (channel - last > BURST_MERGE_GAP + 1)
+                {
+                    break;
+                }
+                if (device.dirty & (1 << channel))
+                {
+                    last = channel;
+                }
+            }
+            size_t count = (last - first) + 1;
+            // The payload is captured now, any updates that arrive while the
+            // write is in progress will be included in a subsequent burst.
+            payload.reserve((count * sizeof(OUTPUT_STATE_REGISTER)) + 1);
+            payload.push_back(REGISTERS::LED0_ON_L + (first << 2));
+            payload.append((const char *)&device.shadow[first],
+                           count * sizeof(OUTPUT_STATE_REGISTER));
+            inflight_ = device.dirty & (((1 << count) - 1) << first);
+            ESP_LOGV(TAG, "[%02x] Writing channels %d-%d", device.address,
+                     first, last);
+        }
+        inflightDevice_ = index;
+        device.dirty &= ~inflight_;
+        transactions_++;
+        bytes_ += payload.size();
+        return invoke_subflow_and_wait(worker_, STATE(flush_done),
+                                       I2CRequest::WRITE, device.address,
+                                       std::move(payload));
+    }
+
+    /// Callback from the @ref I2CWorker when the burst write has completed.
+    Action flush_done()
+    {
+        auto b = get_buffer_deleter(full_allocation_result(worker_));
+        if (b->data()->resultCode != ESP_OK)
+        {
+            Device &device = devices_[inflightDevice_];
+            errors_++;
+            ESP_LOGE(TAG, "[%02x] Failed to write channels %04x: %s",
+                     device.address, inflight_,
+                     esp_err_to_name(b->data()->resultCode));
+            // Mark the channels as dirty again, they will be retried with the
+            // next update rather than looping on a failed device.
+            device.dirty |= inflight_;
+            device.failed = true;
+        }
+        inflight_ = 0;
+        return call_immediately(STATE(flush));
     }
 
     DISALLOW_COPY_AND_ASSIGN(PCA9685PWM);
@@ -412,14 +731,14 @@ class PCA9685PWMBit : public PWM
 {
 public:
     /// Constructor.
-    /// @param instance reference to the chip
-    /// @param index channel index on the chip (0 through 15) 
+    /// @param instance reference to the chip complement
+    /// @param index channel index (0 through num_channels() - 1)
     PCA9685PWMBit(PCA9685PWM *instance, size_t index)
         : PWM()
         , instance_(instance)
         , index_(index)
     {
-        HASSERT(index < PCA9685PWM::NUM_CHANNELS);
+        HASSERT(index < instance->num_channels());
     }
 
     /// Destructor.
@@ -473,7 +792,7 @@ private:
     /// instance pointer to the whole chip complement
     PCA9685PWM *instance_;
 
-    /// bit index within PCA9685
+    /// channel index within the chip complement
     size_t index_;
 
     DISALLOW_COPY_AND_ASSIGN(PCA9685PWMBit);
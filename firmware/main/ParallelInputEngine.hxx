@@ -0,0 +1,330 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ParallelInputEngine.hxx
+ *
+ * Polled input engine which debounces all inputs in parallel.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef PARALLEL_INPUT_ENGINE_HXX_
+#define PARALLEL_INPUT_ENGINE_HXX_
+
+#include "InputEngine.hxx"
+
+#include <driver/gpio.h>
+#include <executor/StateFlow.hxx>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <utils/logging.h>
+
+namespace esp32io
+{
+
+/// Compile time mapping between GPIO numbers and input numbers.
+///
+/// Raw GPIO levels are sampled as a single 64-bit value where bit N is the
+/// level of GPIO N, bits 0-31 come from GPIO_IN_REG and bits 32-39 from
+/// GPIO_IN1_REG.
+struct GpioInputMap
+{
+    /// Marker for GPIO pins which are not an input.
+    static constexpr uint8_t NO_INPUT = 0xFF;
+
+    /// Number of GPIO pins covered by the raw sample.
+    static constexpr size_t NUM_GPIO = 64;
+
+    /// Constructor.
+    ///
+    /// @param pins is the array of GPIO pins, the index into this array is
+    /// the input number.
+    template <size_t N>
+    constexpr GpioInputMap(const gpio_num_t (&pins)[N])
+        : count(N)
+    {
+        static_assert(N <= InputEngine::MAX_INPUTS, "Too many input pins");
+        for (size_t gpio = 0; gpio < NUM_GPIO; gpio++)
+        {
+            input[gpio] = NO_INPUT;
+        }
+        for (size_t index = 0; index < N; index++)
+        {
+            gpio[index] = pins[index];
+            input[pins[index]] = index;
+            mask |= 1ULL << pins[index];
+        }
+    }
+
+    /// Number of inputs.
+    size_t count;
+
+    /// Bit mask of all input pins in the raw sample.
+    uint64_t mask{0};
+
+    /// GPIO number for each input number.
+    gpio_num_t gpio[InputEngine::MAX_INPUTS]{};
+
+    /// Input number for each GPIO number, @ref NO_INPUT if the GPIO is not
+    /// an input.
+    uint8_t input[NUM_GPIO]{};
+};
+
+/// Debounces up to 64 pins in parallel using vertical counters.
+///
+/// Each bit position of the counter planes belongs to one GPIO pin, the
+/// counter of a pin is incremented on every sample which differs from the
+/// accepted level and cleared on every sample which matches. When the counter
+/// reaches the pin's threshold (also stored as bit planes) the new level is
+/// accepted. All pins are processed with a handful of 64-bit operations per
+/// counter bit regardless of how many pins there are.
+///
+/// This has no dependency on the executor, callers are responsible for any
+/// locking that is needed.
+class VerticalDebouncer
+{
+public:
+    /// Number of bits in the vertical counters, this limits the debounce time
+    /// to ((2^COUNTER_BITS) - 1) samples.
+    static constexpr size_t COUNTER_BITS = 8;
+
+    /// Maximum number of samples which can be used for debouncing.
+    static constexpr uint32_t MAX_SAMPLES = (1 << COUNTER_BITS) - 1;
+
+    /// Configures the debounce behavior of a set of pins.
+    ///
+    /// @param mask is the bit mask of the pins to configure.
+    /// @param samples is the number of consecutive samples (1 through
+    /// @ref MAX_SAMPLES) that must differ from the accepted level before a
+    /// new level is accepted.
+    /// @param enabled is true if the pins should be debounced.
+    /// @param levels is the current level of the pins, this becomes the
+    /// accepted level.
+    void configure(uint64_t mask, uint32_t samples, bool enabled,
+                   uint64_t levels)
+    {
+        for (size_t plane = 0; plane < COUNTER_BITS; plane++)
+        {
+            counter_[plane] &= ~mask;
+            if (samples & (1 << plane))
+            {
+                threshold_[plane] |= mask;
+            }
+            else
+            {
+                threshold_[plane] &= ~mask;
+            }
+        }
+        enabled_ = enabled ? (enabled_ | mask) : (enabled_ & ~mask);
+        stable_ = (stable_ & ~mask) | (levels & mask);
+    }
+
+    /// Debounces one sample of all pins.
+    ///
+    /// @param raw is the raw sample, bit N is the level of pin N.
+    /// @return bit mask of the pins which have changed.
+    uint64_t process(uint64_t raw)
+    {
+        uint64_t delta = (raw ^ stable_) & enabled_;
+        // Increment the counters of pins which differ from the accepted
+        // level, all other counters are cleared.
+        uint64_t carry = delta;
+        uint64_t mismatch = 0;
+        for (size_t plane = 0; plane < COUNTER_BITS; plane++)
+        {
+            uint64_t next = counter_[plane] & carry;
+            counter_[plane] = (counter_[plane] ^ carry) & delta;
+            carry = next;
+            mismatch |= counter_[plane] ^ threshold_[plane];
+        }
+        uint64_t changed = delta & ~mismatch;
+        if (changed)
+        {
+            stable_ ^= changed;
+            for (size_t plane = 0; plane < COUNTER_BITS; plane++)
+            {
+                counter_[plane] &= ~changed;
+            }
+        }
+        return changed;
+    }
+
+    /// @return accepted level of all pins.
+    uint64_t stable()
+    {
+        return stable_;
+    }
+
+private:
+    /// Counter bit planes, plane N holds bit N of the counter of every pin.
+    uint64_t counter_[COUNTER_BITS]{};
+
+    /// Threshold bit planes, plane N holds bit N of the threshold of every
+    /// pin.
+    uint64_t threshold_[COUNTER_BITS]{};
+
+    /// Pins which are debounced.
+    uint64_t enabled_{0};
+
+    /// Accepted level of all pins.
+    uint64_t stable_{0};
+};
+
+/// @ref InputEngine which samples all inputs with two register reads on a
+/// fixed interval and debounces them together using a
+/// @ref VerticalDebouncer. Only the pins which changed are converted to input
+/// numbers and published.
+class ParallelInputEngine : public InputEngine, public StateFlowBase
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service that will execute the sampling
+    /// flow.
+    /// @param map is the @ref GpioInputMap for the inputs.
+    /// @param interval_ms is the sampling interval in milliseconds.
+    ParallelInputEngine(Service *service, const GpioInputMap &map,
+                        uint32_t interval_ms)
+        : StateFlowBase(service)
+        , map_(map)
+        , intervalMs_(interval_ms)
+    {
+    }
+
+    /// Starts sampling the inputs.
+    ///
+    /// @return ESP_OK.
+    esp_err_t hw_init()
+    {
+        LOG(INFO, "[Parallel-Input] Sampling %zu inputs every %" PRIu32 " ms",
+            map_.count, intervalMs_);
+        start_flow(STATE(sample));
+        return ESP_OK;
+    }
+
+    /// Configures the debounce behavior of an input.
+    ///
+    /// @param index is the input number.
+    /// @param debounce_ms is the time in milliseconds that the input must be
+    /// stable before a transition is published.
+    /// @param enabled is true if the input should be sampled.
+    void configure(size_t index, uint16_t debounce_ms, bool enabled) override
+    {
+        HASSERT(index < map_.count);
+        uint64_t bit = 1ULL << map_.gpio[index];
+        uint32_t samples = std::max<uint32_t>(
+            (debounce_ms + intervalMs_ - 1) / intervalMs_, 1);
+        if (samples > VerticalDebouncer::MAX_SAMPLES)
+        {
+            LOG(WARNING, "[Parallel-Input] Input %zu debounce of %u ms "
+                "exceeds the maximum of %" PRIu32 " ms", index, debounce_ms,
+                VerticalDebouncer::MAX_SAMPLES * intervalMs_);
+            samples = VerticalDebouncer::MAX_SAMPLES;
+        }
+        uint64_t raw = read_raw();
+        {
+            AtomicHolder h(this);
+            debouncer_.configure(bit, samples, enabled, raw);
+        }
+        if (enabled)
+        {
+            set_level(index, raw & bit);
+        }
+    }
+
+    /// Debounces one sample of all inputs.
+    ///
+    /// @param raw is the raw sample, bit N is the level of GPIO N.
+    /// @return bit mask of the GPIO pins which have changed.
+    uint64_t process(uint64_t raw)
+    {
+        AtomicHolder h(this);
+        return debouncer_.process(raw);
+    }
+
+    /// @return number of samples taken.
+    uint32_t sample_count()
+    {
+        return samples_;
+    }
+
+    /// @return current raw level of all GPIO pins.
+    static uint64_t read_raw()
+    {
+        return REG_READ(GPIO_IN_REG) |
+               ((uint64_t)REG_READ(GPIO_IN1_REG) << 32);
+    }
+
+private:
+    /// Mapping between GPIO numbers and input numbers.
+    const GpioInputMap &map_;
+
+    /// Sampling interval in milliseconds.
+    const uint32_t intervalMs_;
+
+    /// Debounce state of all pins.
+    VerticalDebouncer debouncer_;
+
+    /// Number of samples taken.
+    uint32_t samples_{0};
+
+    /// Timer used for the sampling interval.
+    StateFlowTimer timer_{this};
+
+    /// Samples and debounces all inputs, publishing any transitions.
+    Action sample()
+    {
+        samples_++;
+        uint64_t changed = process(read_raw() & map_.mask);
+        if (changed)
+        {
+            uint32_t inputs = 0;
+            uint32_t levels = 0;
+            uint64_t stable = debouncer_.stable();
+            while (changed)
+            {
+                size_t gpio = __builtin_ctzll(changed);
+                changed &= ~(1ULL << gpio);
+                uint32_t bit = 1U << map_.input[gpio];
+                inputs |= bit;
+                if (stable & (1ULL << gpio))
+                {
+                    levels |= bit;
+                }
+            }
+            publish(inputs, levels);
+        }
+        return sleep_and_call(&timer_, MSEC_TO_NSEC(intervalMs_),
+                              STATE(sample));
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(ParallelInputEngine);
+};
+
+} // namespace esp32io
+
+#endif // PARALLEL_INPUT_ENGINE_HXX_
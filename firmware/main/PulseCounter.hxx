@@ -0,0 +1,396 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file PulseCounter.hxx
+ *
+ * Pulse counter input using the PCNT peripheral.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef PULSE_COUNTER_HXX_
+#define PULSE_COUNTER_HXX_
+
+#include "EventIndex.hxx"
+#include "IoConfig.hxx"
+
+#include <driver/gpio.h>
+#include <driver/pulse_cnt.h>
+#include <esp_check.h>
+#include <executor/StateFlow.hxx>
+#include <freertos/FreeRTOS.h>
+#include <openlcb/Node.hxx>
+#include <openlcb/WriteHelper.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <algorithm>
+
+namespace esp32io
+{
+
+/// Pulse counter settings for a single pin.
+struct PulseCounterSettings
+{
+    /// Event generation mode.
+    PulseMode mode{PulseMode::COUNT};
+
+    /// Number of pulses required to produce the on event.
+    uint16_t threshold{1};
+
+    /// Window time in milliseconds.
+    uint16_t window_ms{DEFAULT_PULSE_WINDOW_MSEC};
+
+    /// Glitch filter in nanoseconds, zero disables the filter.
+    uint16_t filter_ns{DEFAULT_PULSE_FILTER_NSEC};
+
+    /// @return true if the settings are the same as @param other.
+    bool operator==(const PulseCounterSettings &other) const
+    {
+        return mode == other.mode && threshold == other.threshold &&
+               window_ms == other.window_ms && filter_ns == other.filter_ns;
+    }
+
+    /// @return true if the settings differ from @param other.
+    bool operator!=(const PulseCounterSettings &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/// Counts the rising edges of a pin using the PCNT peripheral and produces
+/// events based on the count.
+///
+/// All counting is done in hardware. In @ref PulseMode::COUNT the counter
+/// wraps at the threshold and the watch point interrupt wakes this flow only
+/// when the threshold has been reached, the counter is then checked once per
+/// window until no further pulses arrive. In @ref PulseMode::RATE the counter
+/// is read once per window and compared to the threshold.
+///
+/// NOTE: The ESP32 has eight PCNT units, a pin can not be used as a pulse
+/// counter once all units are in use.
+class PulseCounter : public StateFlowBase
+{
+public:
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service to send events from, this must be
+    /// the same as the OpenLCB stack.
+    /// @param pin is the GPIO pin to count.
+    PulseCounter(Service *service, gpio_num_t pin)
+        : StateFlowBase(service)
+        , pin_(pin)
+    {
+    }
+
+    /// Sets the events to produce, this must be called from the OpenLCB
+    /// executor.
+    ///
+    /// @param node is the @ref openlcb::Node to send the events from.
+    /// @param event_on is the event produced for the on state.
+    /// @param event_off is the event produced for the off state.
+    void set_events(openlcb::Node *node, openlcb::EventId event_on,
+                    openlcb::EventId event_off)
+    {
+        node_ = node;
+        eventOn_ = event_on;
+        eventOff_ = event_off;
+    }
+
+    /// Configures the PCNT unit and starts counting, this can only be called
+    /// once.
+    ///
+    /// @param settings is the @ref PulseCounterSettings to use.
+    /// @return ESP_OK if the counter was started, any other value indicates
+    /// failure.
+    esp_err_t start(const PulseCounterSettings &settings)
+    {
+        HASSERT(!unit_);
+        settings_ = settings;
+        settings_.threshold =
+            std::min(std::max<uint16_t>(settings_.threshold, 1),
+                     MAX_PULSE_THRESHOLD);
+        settings_.window_ms =
+            std::max(settings_.window_ms, MIN_PULSE_WINDOW_MSEC);
+
+        pcnt_unit_config_t unit_config = {};
+        unit_config.low_limit = -1;
+        unit_config.high_limit = settings_.mode == PulseMode::COUNT
+                               ? settings_.threshold : MAX_PULSE_THRESHOLD;
+        ESP_RETURN_ON_ERROR(pcnt_new_unit(&unit_config, &unit_), TAG,
+                            "Failed to allocate PCNT unit for GPIO %d", pin_);
+        if (settings_.filter_ns)
+        {
+            pcnt_glitch_filter_config_t filter_config = {};
+            filter_config.max_glitch_ns =
+                std::min(settings_.filter_ns, MAX_PULSE_FILTER_NSEC);
+            ESP_RETURN_ON_ERROR(
+                pcnt_unit_set_glitch_filter(unit_, &filter_config), TAG,
+                "Failed to configure glitch filter for GPIO %d", pin_);
+        }
+        pcnt_chan_config_t channel_config = {};
+        channel_config.edge_gpio_num = pin_;
+        channel_config.level_gpio_num = -1;
+        ESP_RETURN_ON_ERROR(
+            pcnt_new_channel(unit_, &channel_config, &channel_), TAG,
+            "Failed to allocate PCNT channel for GPIO %d", pin_);
+        ESP_RETURN_ON_ERROR(
+            pcnt_channel_set_edge_action(channel_,
+                                         PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                         PCNT_CHANNEL_EDGE_ACTION_HOLD), TAG,
+            "Failed to configure PCNT channel for GPIO %d", pin_);
+        if (settings_.mode == PulseMode::COUNT)
+        {
+            ESP_RETURN_ON_ERROR(
+                pcnt_unit_add_watch_point(unit_, settings_.threshold), TAG,
+                "Failed to add PCNT watch point for GPIO %d", pin_);
+            pcnt_event_callbacks_t callbacks = {};
+            callbacks.on_reach = threshold_isr;
+            ESP_RETURN_ON_ERROR(
+                pcnt_unit_register_event_callbacks(unit_, &callbacks, this),
+                TAG, "Failed to register PCNT callback for GPIO %d", pin_);
+        }
+        ESP_RETURN_ON_ERROR(pcnt_unit_enable(unit_), TAG,
+                            "Failed to enable PCNT unit for GPIO %d", pin_);
+        ESP_RETURN_ON_ERROR(pcnt_unit_clear_count(unit_), TAG,
+                            "Failed to clear PCNT unit for GPIO %d", pin_);
+        ESP_RETURN_ON_ERROR(pcnt_unit_start(unit_), TAG,
+                            "Failed to start PCNT unit for GPIO %d", pin_);
+        LOG(INFO, "[PCNT] GPIO %d counting, mode:%s threshold:%u window:%ums",
+            pin_, settings_.mode == PulseMode::COUNT ? "count" : "rate",
+            settings_.threshold, settings_.window_ms);
+        if (settings_.mode == PulseMode::COUNT)
+        {
+            start_flow(STATE(wait_for_threshold));
+        }
+        else
+        {
+            lastCount_ = count();
+            start_flow(STATE(start_window));
+        }
+        return ESP_OK;
+    }
+
+    /// @return the settings in use by this counter.
+    const PulseCounterSettings &settings()
+    {
+        return settings_;
+    }
+
+    /// @return true if the counter is in the active (on) state.
+    bool active()
+    {
+        return active_;
+    }
+
+    /// @return number of events produced by this counter.
+    uint32_t event_count()
+    {
+        return events_;
+    }
+
+private:
+    /// Log tag used for errors.
+    static constexpr const char *TAG = "PCNT";
+
+    /// GPIO pin being counted.
+    const gpio_num_t pin_;
+
+    /// PCNT unit, nullptr until @ref start has been called.
+    pcnt_unit_handle_t unit_{nullptr};
+
+    /// PCNT channel connected to @ref pin_.
+    pcnt_channel_handle_t channel_{nullptr};
+
+    /// Settings in use by this counter.
+    PulseCounterSettings settings_;
+
+    /// Node to send the events from, nullptr until @ref set_events has been
+    /// called.
+    openlcb::Node *node_{nullptr};
+
+    /// Event produced for the on state.
+    openlcb::EventId eventOn_{0};
+
+    /// Event produced for the off state.
+    openlcb::EventId eventOff_{0};
+
+    /// Lock protecting the state shared with the interrupt handler.
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    /// Number of times the threshold was reached since last checked.
+    uint32_t thresholds_{0};
+
+    /// True when the flow is waiting for the threshold interrupt.
+    bool waiting_{false};
+
+    /// True when the counter is in the active (on) state.
+    bool active_{false};
+
+    /// Counter value at the start of the current window.
+    int lastCount_{0};
+
+    /// Number of events produced by this counter.
+    uint32_t events_{0};
+
+    /// Helper used for sending the events.
+    openlcb::WriteHelper helper_;
+
+    /// Notified when the event has been sent.
+    BarrierNotifiable n_;
+
+    /// Timer used for the counting window.
+    StateFlowTimer timer_{this};
+
+    /// PCNT watch point interrupt handler, called when the counter reaches
+    /// the threshold.
+    ///
+    /// @param unit is the PCNT unit which reached the watch point.
+    /// @param edata is the watch point event data.
+    /// @param ctx is the @ref PulseCounter owning the unit.
+    /// @return false as no task switch is requested from here.
+    static bool threshold_isr(pcnt_unit_handle_t unit,
+                              const pcnt_watch_event_data_t *edata,
+                              void *ctx)
+    {
+        PulseCounter *counter = static_cast<PulseCounter *>(ctx);
+        bool wakeup = false;
+        portENTER_CRITICAL_ISR(&counter->lock_);
+        counter->thresholds_++;
+        if (counter->waiting_)
+        {
+            counter->waiting_ = false;
+            wakeup = true;
+        }
+        portEXIT_CRITICAL_ISR(&counter->lock_);
+        if (wakeup)
+        {
+            counter->notify_from_isr();
+        }
+        return false;
+    }
+
+    /// @return the current value of the hardware counter.
+    int count()
+    {
+        int value = 0;
+        pcnt_unit_get_count(unit_, &value);
+        return value;
+    }
+
+    /// Retrieves and clears the number of times the threshold was reached.
+    ///
+    /// @param wait is true if the flow will wait for the next threshold
+    /// interrupt when the threshold has not been reached.
+    /// @return true if the threshold has been reached.
+    bool take_thresholds(bool wait)
+    {
+        portENTER_CRITICAL(&lock_);
+        bool reached = thresholds_ != 0;
+        thresholds_ = 0;
+        waiting_ = wait && !reached;
+        portEXIT_CRITICAL(&lock_);
+        return reached;
+    }
+
+    /// Produces the event for the current state.
+    ///
+    /// @param next is the state to continue with once the event is sent.
+    Action produce(Callback next)
+    {
+        if (!node_)
+        {
+            return call_immediately(next);
+        }
+        events_++;
+        EventIndex::produce(&helper_, node_, active_ ? eventOn_ : eventOff_,
+                            n_.reset(this));
+        return wait_and_call(next);
+    }
+
+    /// Waits for the threshold interrupt.
+    Action wait_for_threshold()
+    {
+        if (!take_thresholds(true))
+        {
+            return wait_and_call(STATE(wait_for_threshold));
+        }
+        active_ = true;
+        lastCount_ = count();
+        return produce(STATE(start_window));
+    }
+
+    /// Starts a new counting window.
+    Action start_window()
+    {
+        return sleep_and_call(&timer_, MSEC_TO_NSEC(settings_.window_ms),
+                              STATE(window_elapsed));
+    }
+
+    /// Evaluates the pulses counted during the window.
+    Action window_elapsed()
+    {
+        int value = count();
+        int pulses = value - lastCount_;
+        lastCount_ = value;
+        if (settings_.mode == PulseMode::RATE)
+        {
+            if (pulses < 0)
+            {
+                // The counter wrapped at the high limit.
+                pulses += MAX_PULSE_THRESHOLD;
+            }
+            bool active = pulses >= settings_.threshold;
+            if (active != active_)
+            {
+                active_ = active;
+                return produce(STATE(start_window));
+            }
+            return call_immediately(STATE(start_window));
+        }
+        if (take_thresholds(false))
+        {
+            // The threshold was reached again, repeat the on event.
+            return produce(STATE(start_window));
+        }
+        if (pulses)
+        {
+            return call_immediately(STATE(start_window));
+        }
+        // No pulses during the window, discard any partial count and go back
+        // to waiting for the threshold.
+        pcnt_unit_clear_count(unit_);
+        lastCount_ = 0;
+        active_ = false;
+        return produce(STATE(wait_for_threshold));
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(PulseCounter);
+};
+
+} // namespace esp32io
+
+#endif // PULSE_COUNTER_HXX_
@@ -0,0 +1,384 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file RemoteConfigClient.hxx
+ *
+ * Memory configuration client for remote nodes which can run alongside other
+ * clients on the same node.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef REMOTE_CONFIG_CLIENT_HXX_
+#define REMOTE_CONFIG_CLIENT_HXX_
+
+#include <executor/CallableFlow.hxx>
+#include <executor/StateFlow.hxx>
+#include <openlcb/DatagramHandlerDefault.hxx>
+#include <openlcb/MemoryConfig.hxx>
+#include <utils/format_utils.hxx>
+#include <utils/logging.h>
+#include <vector>
+
+namespace esp32io
+{
+
+/// Request for a @ref RemoteConfigClient.
+struct RemoteConfigRequest : public CallableFlowRequestBase
+{
+    enum ReadPartCmd
+    {
+        READ_PART
+    };
+
+    enum WriteCmd
+    {
+        WRITE
+    };
+
+    enum UpdateCompleteCmd
+    {
+        UPDATE_COMPLETE
+    };
+
+    enum Command : uint8_t
+    {
+        CMD_READ_PART,
+        CMD_WRITE,
+        CMD_UPDATE_COMPLETE
+    };
+
+    /// Reads up to 64 bytes from a memory space.
+    ///
+    /// @param dst is the node to read from.
+    /// @param space is the memory space to read from.
+    /// @param address is the first address to read.
+    /// @param size is the number of bytes to read.
+    void reset(ReadPartCmd, openlcb::NodeHandle dst, uint8_t space,
+               uint32_t address, size_t size)
+    {
+        reset_common(CMD_READ_PART, dst, space, address);
+        this->size = size;
+    }
+
+    /// Writes up to 64 bytes to a memory space.
+    ///
+    /// @param dst is the node to write to.
+    /// @param space is the memory space to write to.
+    /// @param address is the first address to write.
+    /// @param data is the data to write.
+    void reset(WriteCmd, openlcb::NodeHandle dst, uint8_t space,
+               uint32_t address, string data)
+    {
+        reset_common(CMD_WRITE, dst, space, address);
+        payload = std::move(data);
+    }
+
+    /// Sends the update complete command.
+    ///
+    /// @param dst is the node to send the command to.
+    void reset(UpdateCompleteCmd, openlcb::NodeHandle dst)
+    {
+        reset_common(CMD_UPDATE_COMPLETE, dst, 0, 0);
+    }
+
+    Command cmd;
+    openlcb::NodeHandle dst;
+    uint8_t space;
+    uint32_t address;
+    size_t size;
+
+    /// Data to write, or the data read once the request completes.
+    string payload;
+
+private:
+    void reset_common(Command cmd, openlcb::NodeHandle dst, uint8_t space,
+                      uint32_t address)
+    {
+        reset_base();
+        this->cmd = cmd;
+        this->dst = dst;
+        this->space = space;
+        this->address = address;
+        size = 0;
+        payload.clear();
+    }
+};
+
+class RemoteConfigRouter;
+
+/// Sends memory configuration requests to a remote node. Replies are
+/// delivered by the @ref RemoteConfigRouter of the node, which matches them
+/// to the client by the node that sent them. A client must therefore be the
+/// only one with a request in flight for its target node.
+///
+/// Runs on the executor of the memory config handler.
+class RemoteConfigClient : public CallableFlow<RemoteConfigRequest>
+{
+public:
+    /// Constructor.
+    ///
+    /// @param router is the @ref RemoteConfigRouter delivering replies.
+    /// @param node is the local node to send requests from.
+    /// @param dg_service is the datagram service of @p node.
+    RemoteConfigClient(RemoteConfigRouter *router, openlcb::Node *node,
+                       openlcb::DatagramService *dg_service);
+
+private:
+    /// Maximum time to wait for the reply datagram.
+    static constexpr long long REPLY_TIMEOUT_NSEC = SEC_TO_NSEC(3);
+
+    /// Local node sending the requests.
+    openlcb::Node *node_;
+
+    /// Datagram service of @ref node_.
+    openlcb::DatagramService *dgService_;
+
+    /// Datagram client used for the request in flight.
+    openlcb::DatagramClient *dgClient_{nullptr};
+
+    /// Notified when the request datagram has been acknowledged.
+    BarrierNotifiable bn_;
+
+    /// Used to wait for the reply datagram.
+    StateFlowTimer timer_{this};
+
+    /// Reply datagram received from the target node.
+    string reply_;
+
+    /// True when a reply datagram is expected from the target node.
+    bool waiting_{false};
+
+    /// True when @ref reply_ holds the reply to the request in flight.
+    bool replied_{false};
+
+    /// True when sleeping on @ref timer_ for the reply.
+    bool sleeping_{false};
+
+    friend class RemoteConfigRouter;
+
+    Action entry() override
+    {
+        request()->resultCode = openlcb::DatagramClient::OPERATION_PENDING;
+        return allocate_and_call(STATE(send_request),
+                                 dgService_->client_allocator());
+    }
+
+    /// Sends the request datagram.
+    Action send_request()
+    {
+        dgClient_ = full_allocation_result(dgService_->client_allocator());
+        string payload;
+        switch (request()->cmd)
+        {
+            case RemoteConfigRequest::CMD_READ_PART:
+                payload = openlcb::MemoryConfigDefs::read_datagram(
+                    request()->space, request()->address, request()->size);
+                break;
+            case RemoteConfigRequest::CMD_WRITE:
+                payload = openlcb::MemoryConfigDefs::write_datagram(
+                    request()->space, request()->address, request()->payload);
+                break;
+            case RemoteConfigRequest::CMD_UPDATE_COMPLETE:
+                payload.push_back(openlcb::DatagramDefs::CONFIGURATION);
+                payload.push_back(
+                    openlcb::MemoryConfigDefs::COMMAND_UPDATE_COMPLETE);
+                break;
+        }
+        Buffer<openlcb::GenMessage> *b;
+        mainBufferPool->alloc(&b);
+        b->data()->reset(openlcb::Defs::MTI_DATAGRAM, node_->node_id(),
+                         request()->dst, std::move(payload));
+        b->set_done(bn_.reset(this));
+        // The reply can be routed before the datagram client reports the
+        // acknowledgement.
+        replied_ = false;
+        waiting_ = request()->cmd != RemoteConfigRequest::CMD_UPDATE_COMPLETE;
+        dgClient_->write_datagram(b);
+        return wait_and_call(STATE(request_sent));
+    }
+
+    /// Waits for the reply datagram once the request has been acknowledged.
+    Action request_sent()
+    {
+        uint32_t result = dgClient_->result();
+        dgService_->client_allocator()->typed_insert(dgClient_);
+        dgClient_ = nullptr;
+        if (!(result & openlcb::DatagramClient::OPERATION_SUCCESS))
+        {
+            waiting_ = false;
+            int code = result & openlcb::DatagramClient::RESPONSE_CODE_MASK;
+            return return_with_error(code ? code
+                                          : openlcb::Defs::ERROR_PERMANENT);
+        }
+        if (request()->cmd == RemoteConfigRequest::CMD_WRITE && !replied_ &&
+            !(result & openlcb::DatagramClient::OK_REPLY_PENDING))
+        {
+            // The node accepted the write without a reply.
+            waiting_ = false;
+        }
+        if (!waiting_ && !replied_)
+        {
+            return return_ok();
+        }
+        else if (replied_)
+        {
+            return call_immediately(STATE(reply_received));
+        }
+        sleeping_ = true;
+        return sleep_and_call(&timer_, REPLY_TIMEOUT_NSEC,
+                              STATE(reply_received));
+    }
+
+    /// Decodes the reply datagram.
+    Action reply_received()
+    {
+        sleeping_ = false;
+        if (!replied_)
+        {
+            waiting_ = false;
+            LOG(VERBOSE, "[RemoteConfig] No reply from %s",
+                uint64_to_string_hex(request()->dst.id).c_str());
+            return return_with_error(openlcb::Defs::ERROR_TEMPORARY);
+        }
+        // The address is followed by the space number unless one of the
+        // command bits selects the space.
+        uint8_t cmd = reply_.size() > 1 ? reply_[1] : 0;
+        size_t header = (cmd & ~openlcb::MemoryConfigDefs::COMMAND_MASK)
+                      ? 6 : 7;
+        uint8_t command = cmd & openlcb::MemoryConfigDefs::COMMAND_MASK;
+        if (reply_.size() < header)
+        {
+            return return_with_error(openlcb::Defs::ERROR_PERMANENT);
+        }
+        else if (command == openlcb::MemoryConfigDefs::COMMAND_READ_FAILED ||
+                 command == openlcb::MemoryConfigDefs::COMMAND_WRITE_FAILED)
+        {
+            int code = openlcb::Defs::ERROR_PERMANENT;
+            if (reply_.size() >= header + 2)
+            {
+                code = ((uint8_t)reply_[header] << 8) |
+                       (uint8_t)reply_[header + 1];
+            }
+            return return_with_error(code);
+        }
+        else if (request()->cmd == RemoteConfigRequest::CMD_READ_PART)
+        {
+            request()->payload.assign(reply_, header, string::npos);
+        }
+        reply_.clear();
+        return return_ok();
+    }
+};
+
+/// Receives the memory configuration reply datagrams of a node and hands
+/// them to the @ref RemoteConfigClient waiting for a reply from the node
+/// that sent them.
+///
+/// The memory config handler forwards replies to a single client, this takes
+/// that slot so that several @ref RemoteConfigClient can have requests in
+/// flight to different nodes at the same time.
+class RemoteConfigRouter : public openlcb::DefaultDatagramHandler
+{
+public:
+    /// Constructor.
+    ///
+    /// @param node is the local node.
+    /// @param dg_service is the datagram service of @p node.
+    /// @param memcfg is the memory config handler of @p node.
+    RemoteConfigRouter(openlcb::Node *node,
+                       openlcb::DatagramService *dg_service,
+                       openlcb::MemoryConfigHandler *memcfg)
+        : openlcb::DefaultDatagramHandler(dg_service)
+        , node_(node)
+        , memcfg_(memcfg)
+    {
+        memcfg_->set_client(this);
+    }
+
+    ~RemoteConfigRouter()
+    {
+        memcfg_->set_client(nullptr);
+    }
+
+    /// Registers a client to receive replies, this must be called before the
+    /// client sends any requests.
+    ///
+    /// @param client is the client to register.
+    void add(RemoteConfigClient *client)
+    {
+        clients_.push_back(client);
+    }
+
+private:
+    /// Local node.
+    openlcb::Node *node_;
+
+    /// Memory config handler forwarding the replies.
+    openlcb::MemoryConfigHandler *memcfg_;
+
+    /// Registered clients.
+    std::vector<RemoteConfigClient *> clients_;
+
+    Action entry() override
+    {
+        for (RemoteConfigClient *client : clients_)
+        {
+            if (client->waiting_ &&
+                node_->iface()->matching_node(client->request()->dst,
+                                              message()->data()->src))
+            {
+                client->reply_ = message()->data()->payload;
+                client->replied_ = true;
+                client->waiting_ = false;
+                if (client->sleeping_)
+                {
+                    client->timer_.trigger();
+                }
+                return respond_ok(0);
+            }
+        }
+        LOG(VERBOSE, "[RemoteConfig] Unexpected reply from %s",
+            uint64_to_string_hex(message()->data()->src.id).c_str());
+        return respond_reject(openlcb::Defs::ERROR_OUT_OF_ORDER);
+    }
+};
+
+inline RemoteConfigClient::RemoteConfigClient(
+    RemoteConfigRouter *router, openlcb::Node *node,
+    openlcb::DatagramService *dg_service)
+    : CallableFlow<RemoteConfigRequest>(router->service())
+    , node_(node)
+    , dgService_(dg_service)
+{
+    router->add(this);
+}
+
+} // namespace esp32io
+
+#endif // REMOTE_CONFIG_CLIENT_HXX_
@@ -0,0 +1,216 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ServoMotion.hxx
+ *
+ * Speed and acceleration limited servo outputs.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef SERVO_MOTION_HXX_
+#define SERVO_MOTION_HXX_
+
+#include "EventIndex.hxx"
+#include "ServoMotionConfig.hxx"
+#include "ServoMotionEngine.hxx"
+
+#include <freertos_drivers/common/PWM.hxx>
+#include <utils/ConfigUpdateListener.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+
+namespace esp32io
+{
+
+/// Servo output driven by two events. Receiving the minimum or maximum
+/// rotation event moves the servo to the corresponding stop point using the
+/// configured velocity and acceleration limits. This is a replacement for
+/// @ref openlcb::ServoConsumer, the events are handled by the
+/// @ref EventIndex.
+class ServoMotionConsumer : public DefaultConfigUpdateListener
+                          , public EventTarget
+{
+public:
+    /// Constructor.
+    ///
+    /// @param cfg is the @ref ServoMotionConfig for this output.
+    /// @param pwmCountPerMs is the number of PWM counts per millisecond.
+    /// @param pwm is the @ref PWM output to drive, this can be nullptr when
+    /// the output is only known once the devices have been discovered, see
+    /// @ref set_output.
+    /// @param engine is the @ref ServoMotionEngine to move the output.
+    ServoMotionConsumer(const ServoMotionConfig &cfg,
+                        const uint32_t pwmCountPerMs, PWM *pwm,
+                        ServoMotionEngine *engine)
+        : DefaultConfigUpdateListener()
+        , cfg_(cfg)
+        , pwmCountPerMs_(pwmCountPerMs)
+        , channel_(engine, pwm)
+    {
+    }
+
+    /// Sets the @ref PWM output to drive, this must be called before the
+    /// output is registered with the @ref EventIndex when it was constructed
+    /// without one.
+    ///
+    /// @param pwm is the @ref PWM output to drive.
+    void set_output(PWM *pwm)
+    {
+        channel_.set_output(pwm);
+    }
+
+    /// @return the motion state of this output.
+    ServoMotionEngine::Channel *channel()
+    {
+        return &channel_;
+    }
+
+    /// Adds the rotation events of this output, the "on" event rotates the
+    /// servo to the maximum stop point.
+    ///
+    /// @param index is the @ref EventIndex being built.
+    void add_events(EventIndex *index) override
+    {
+        if (!configured_)
+        {
+            return;
+        }
+        index->add(eventMax_, this,
+                   EventIndex::FLAG_CONSUMER | EventIndex::FLAG_ON);
+        index->add(eventMin_, this, EventIndex::FLAG_CONSUMER);
+    }
+
+    /// @return the last requested state of the output.
+    openlcb::EventState event_state() override
+    {
+        return state_;
+    }
+
+    /// Moves the servo to the requested stop point.
+    ///
+    /// @param on is true for the maximum stop point.
+    void event_received(bool on) override
+    {
+        state_ = on ? openlcb::EventState::VALID
+                    : openlcb::EventState::INVALID;
+        channel_.move_to(on ? servoMax_ : servoMin_);
+    }
+
+    /// Processes a configuration update.
+    ///
+    /// @param fd is the configuration file descriptor.
+    /// @param initial_load is true during the first load of configuration.
+    /// @param done is the @ref BarrierNotifiable to notify on completion.
+    /// @return @ref UpdateAction based on the changes made.
+    UpdateAction apply_configuration(int fd, bool initial_load,
+                                     BarrierNotifiable *done) override
+    {
+        AutoNotify n(done);
+        const openlcb::EventId event_min = cfg_.event_rotate_min().read(fd);
+        const openlcb::EventId event_max = cfg_.event_rotate_max().read(fd);
+        const int16_t min_percent = cfg_.servo_min_percent().read(fd);
+        const int16_t max_percent = cfg_.servo_max_percent().read(fd);
+        const uint16_t velocity = cfg_.velocity().read(fd);
+        const uint16_t acceleration = cfg_.acceleration().read(fd);
+
+        // 1ms duty cycle
+        const uint32_t ticks_0 = pwmCountPerMs_;
+        // 2ms duty cycle
+        const uint32_t ticks_180 = pwmCountPerMs_ * 2;
+
+        // Use a weighted sum of the two end points to compute the duty cycle.
+        servoMin_ = ((100 - min_percent) * ticks_0 + min_percent * ticks_180)
+                  / 100;
+        servoMax_ = ((100 - max_percent) * ticks_0 + max_percent * ticks_180)
+                  / 100;
+        channel_.set_limits(ticks_180 - ticks_0, velocity, acceleration);
+
+        if (state_ != openlcb::EventState::UNKNOWN)
+        {
+            channel_.move_to(state_ == openlcb::EventState::VALID ? servoMax_
+                                                                 : servoMin_);
+        }
+
+        if (!configured_ || event_min != eventMin_ || event_max != eventMax_)
+        {
+            configured_ = true;
+            eventMin_ = event_min;
+            eventMax_ = event_max;
+            invalidate_events();
+            return initial_load ? UPDATED : REINIT_NEEDED;
+        }
+        return UPDATED;
+    }
+
+    /// Resets the configuration to defaults.
+    ///
+    /// @param fd is the configuration file descriptor.
+    void factory_reset(int fd) override
+    {
+        cfg_.description().write(fd, "");
+        CDI_FACTORY_RESET(cfg_.servo_min_percent);
+        CDI_FACTORY_RESET(cfg_.servo_max_percent);
+        CDI_FACTORY_RESET(cfg_.velocity);
+        CDI_FACTORY_RESET(cfg_.acceleration);
+    }
+
+private:
+    /// Configuration for this output.
+    const ServoMotionConfig cfg_;
+
+    /// Number of PWM counts per millisecond.
+    const uint32_t pwmCountPerMs_;
+
+    /// Motion state of this output.
+    ServoMotionEngine::Channel channel_;
+
+    /// Minimum stop point, in PWM counts.
+    uint32_t servoMin_{0};
+
+    /// Maximum stop point, in PWM counts.
+    uint32_t servoMax_{0};
+
+    /// Last requested state, the output is not driven until the first event
+    /// has been received.
+    openlcb::EventState state_{openlcb::EventState::UNKNOWN};
+
+    /// True once the configuration has been loaded.
+    bool configured_{false};
+
+    /// Event which rotates to the minimum stop point.
+    openlcb::EventId eventMin_{0};
+
+    /// Event which rotates to the maximum stop point.
+    openlcb::EventId eventMax_{0};
+
+    DISALLOW_COPY_AND_ASSIGN(ServoMotionConsumer);
+};
+
+} // namespace esp32io
+
+#endif // SERVO_MOTION_HXX_
@@ -0,0 +1,88 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ServoMotionConfig.hxx
+ *
+ * CDI configuration for a speed limited servo output.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef SERVO_MOTION_CONFIG_HXX_
+#define SERVO_MOTION_CONFIG_HXX_
+
+#include <openlcb/ConfigRepresentation.hxx>
+
+namespace esp32io
+{
+
+/// CDI configuration for a single servo output. The first five entries match
+/// the layout of @ref openlcb::ServoConsumerConfig.
+CDI_GROUP(ServoMotionConfig);
+CDI_GROUP_ENTRY(description, openlcb::StringConfigEntry<16>,
+                Name("Description"),
+                Description("User name of this output."));
+CDI_GROUP_ENTRY(event_rotate_min, openlcb::EventConfigEntry,
+                Name("Minimum Rotation Event ID"),
+                Description("Receiving this event ID will rotate the servo to "
+                            "its mimimum configured point."));
+CDI_GROUP_ENTRY(event_rotate_max, openlcb::EventConfigEntry,
+                Name("Maximum Rotation Event ID"),
+                Description("Receiving this event ID will rotate the servo to "
+                            "its maximum configured point."));
+CDI_GROUP_ENTRY(servo_min_percent, openlcb::Int16ConfigEntry,
+                Name("Servo Minimum Stop Point Percentage"),
+                Description("Low-end stop point of the servo, as a percentage: "
+                            "generally 0-100. May be under/over-driven by "
+                            "setting a percentage value of -99 to 200, "
+                            "respectively."),
+                Min(-99), Max(200), Default(0));
+CDI_GROUP_ENTRY(servo_max_percent, openlcb::Int16ConfigEntry,
+                Name("Servo Maximum Stop Point Percentage"),
+                Description("High-end stop point of the servo, as a "
+                            "percentage: generally 0-100. May be under/over-"
+                            "driven by setting a percentage value of -99 to "
+                            "200, respectively."),
+                Min(-99), Max(200), Default(100));
+CDI_GROUP_ENTRY(velocity, openlcb::Uint16ConfigEntry,
+                Name("Servo Velocity"),
+                Description("Maximum speed of the servo, as a percentage of "
+                            "the full servo range per second. A value of zero "
+                            "will move the servo immediately."),
+                Min(0), Max(1000), Default(0));
+CDI_GROUP_ENTRY(acceleration, openlcb::Uint16ConfigEntry,
+                Name("Servo Acceleration"),
+                Description("Rate of change of the servo speed, as a "
+                            "percentage of the full servo range per second "
+                            "per second. A value of zero will start and stop "
+                            "the servo at full velocity."),
+                Min(0), Max(1000), Default(0));
+CDI_GROUP_END();
+
+} // namespace esp32io
+
+#endif // SERVO_MOTION_CONFIG_HXX_
@@ -0,0 +1,274 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ServoMotionEngine.hxx
+ *
+ * Moves servo outputs with velocity and acceleration limits.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef SERVO_MOTION_ENGINE_HXX_
+#define SERVO_MOTION_ENGINE_HXX_
+
+#include "ServoProfile.hxx"
+
+#include <executor/StateFlow.hxx>
+#include <freertos_drivers/common/PWM.hxx>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <vector>
+
+namespace esp32io
+{
+
+/// Moves servo outputs towards their target position in fixed size time
+/// steps. Each output moves with a trapezoidal velocity profile limited by
+/// its configured velocity and acceleration, see @ref ServoProfile.
+///
+/// Only outputs which are moving are visited on each tick and the PWM duty
+/// cycle is only updated when the integer PWM count changes. When no outputs
+/// are moving the flow exits and does not consume any executor time.
+///
+/// NOTE: All methods must be called from the executor of the @ref Service
+/// provided in the constructor.
+class ServoMotionEngine : public StateFlowBase
+{
+public:
+    /// Interval between position updates, this matches the servo frame rate.
+    static constexpr uint32_t TICK_MSEC = ServoProfile::TICK_MSEC;
+
+    /// Motion state for a single servo output.
+    class Channel
+    {
+    public:
+        /// Constructor.
+        ///
+        /// @param engine is the @ref ServoMotionEngine to move this output.
+        /// @param pwm is the @ref PWM output to update.
+        Channel(ServoMotionEngine *engine, PWM *pwm)
+            : engine_(engine)
+            , pwm_(pwm)
+        {
+        }
+
+        /// Configures the motion limits for this output.
+        ///
+        /// @param range is the number of PWM counts in the full servo range.
+        /// @param velocity is the maximum velocity, as a percentage of the
+        /// full servo range per second. Zero disables motion limiting.
+        /// @param acceleration is the acceleration, as a percentage of the
+        /// full servo range per second per second. Zero disables acceleration
+        /// limiting.
+        void set_limits(uint32_t range, uint16_t velocity,
+                        uint16_t acceleration)
+        {
+            profile_.set_limits(range, velocity, acceleration);
+        }
+
+        /// Starts moving this output towards a new position. The first move
+        /// and all moves without a velocity limit are applied immediately.
+        ///
+        /// @param counts is the target position in PWM counts.
+        void move_to(uint32_t counts)
+        {
+            if (!valid_ || !profile_.is_limited())
+            {
+                profile_.jump_to(counts);
+                valid_ = true;
+                counts_ = counts;
+                pwm_->set_duty(counts);
+                return;
+            }
+            profile_.set_target(counts);
+            engine_->activate(this);
+        }
+
+        /// Sets the @ref PWM output to update, this must be called before
+        /// the first move when the output was constructed without one.
+        ///
+        /// @param pwm is the @ref PWM output to update.
+        void set_output(PWM *pwm)
+        {
+            pwm_ = pwm;
+        }
+
+        /// @return current position in PWM counts.
+        uint32_t position()
+        {
+            return counts_;
+        }
+
+        /// @return true if this output is moving.
+        bool is_moving()
+        {
+            return active_;
+        }
+
+    private:
+        /// Allow the engine to update the motion state.
+        friend class ServoMotionEngine;
+
+        /// @ref ServoMotionEngine which moves this output.
+        ServoMotionEngine *engine_;
+
+        /// @ref PWM output to update.
+        PWM *pwm_;
+
+        /// Position, velocity and limits of this output.
+        ServoProfile profile_;
+
+        /// Last PWM count written to @ref pwm_.
+        uint32_t counts_{0};
+
+        /// True when @ref position_ reflects the output position.
+        bool valid_{false};
+
+        /// True when this output is in the engine's active list.
+        bool active_{false};
+
+        DISALLOW_COPY_AND_ASSIGN(Channel);
+    };
+
+    /// Constructor.
+    ///
+    /// @param service is the @ref Service that will execute this flow.
+    ServoMotionEngine(Service *service) : StateFlowBase(service)
+    {
+    }
+
+    /// @return number of position update ticks executed.
+    uint32_t tick_count()
+    {
+        return ticks_;
+    }
+
+    /// @return number of PWM duty cycle updates issued by position updates.
+    uint32_t write_count()
+    {
+        return writes_;
+    }
+
+    /// @return number of outputs which are currently moving.
+    size_t active_count()
+    {
+        return active_.size();
+    }
+
+    /// Advances all moving outputs by one step, this is called by the flow
+    /// every @ref TICK_MSEC and allows the motion to be simulated without the
+    /// timer.
+    ///
+    /// @return true if any output is still moving.
+    bool advance()
+    {
+        ticks_++;
+        for (size_t index = 0; index < active_.size();)
+        {
+            Channel *channel = active_[index];
+            if (step(channel))
+            {
+                index++;
+            }
+            else
+            {
+                channel->active_ = false;
+                active_[index] = active_.back();
+                active_.pop_back();
+            }
+        }
+        return !active_.empty();
+    }
+
+private:
+    /// Timer used for scheduling the position updates.
+    StateFlowTimer timer_{this};
+
+    /// Outputs which are currently moving.
+    std::vector<Channel *> active_;
+
+    /// True when the flow is running.
+    bool running_{false};
+
+    /// Number of position update ticks executed.
+    uint32_t ticks_{0};
+
+    /// Number of PWM duty cycle updates issued by position updates.
+    uint32_t writes_{0};
+
+    /// Adds an output to the active list and starts the flow if needed.
+    ///
+    /// @param channel is the @ref Channel to add.
+    void activate(Channel *channel)
+    {
+        if (!channel->active_)
+        {
+            channel->active_ = true;
+            active_.push_back(channel);
+        }
+        if (!running_)
+        {
+            running_ = true;
+            start_flow(STATE(tick));
+        }
+    }
+
+    /// Advances all moving outputs every @ref TICK_MSEC.
+    Action tick()
+    {
+        if (!advance())
+        {
+            running_ = false;
+            return exit();
+        }
+        return sleep_and_call(&timer_, MSEC_TO_NSEC(TICK_MSEC), STATE(tick));
+    }
+
+    /// Advances a single output by one step.
+    ///
+    /// @param channel is the @ref Channel to advance.
+    /// @return true if the output is still moving.
+    bool step(Channel *channel)
+    {
+        bool moving = channel->profile_.step();
+        uint32_t counts = channel->profile_.counts();
+        if (counts != channel->counts_)
+        {
+            channel->counts_ = counts;
+            channel->pwm_->set_duty(counts);
+            writes_++;
+        }
+        return moving;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(ServoMotionEngine);
+};
+
+} // namespace esp32io
+
+#endif // SERVO_MOTION_ENGINE_HXX_
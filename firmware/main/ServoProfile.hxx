@@ -0,0 +1,237 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ServoProfile.hxx
+ *
+ * Trapezoidal velocity profile used by the servo outputs.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef SERVO_PROFILE_HXX_
+#define SERVO_PROFILE_HXX_
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace esp32io
+{
+
+/// Position, velocity and limits of a single servo output. Each call to
+/// @ref step advances the position by one fixed size time step using a
+/// trapezoidal velocity profile limited by the configured velocity and
+/// acceleration.
+///
+/// Positions are tracked in fixed point PWM counts with @ref FRACTION_BITS
+/// fractional bits. This has no dependency on the executor so the profile can
+/// be simulated on the host.
+class ServoProfile
+{
+public:
+    /// Interval between position updates, this matches the servo frame rate.
+    static constexpr uint32_t TICK_MSEC = 20;
+
+    /// Number of fractional bits used for positions and velocities.
+    static constexpr uint32_t FRACTION_BITS = 8;
+
+    /// Configures the motion limits.
+    ///
+    /// @param range is the number of PWM counts in the full servo range.
+    /// @param velocity is the maximum velocity, as a percentage of the
+    /// full servo range per second. Zero disables motion limiting.
+    /// @param acceleration is the acceleration, as a percentage of the
+    /// full servo range per second per second. Zero disables acceleration
+    /// limiting.
+    void set_limits(uint32_t range, uint16_t velocity, uint16_t acceleration)
+    {
+        maxVelocity_ = 0;
+        acceleration_ = 0;
+        if (velocity)
+        {
+            maxVelocity_ = std::max<uint64_t>(1,
+                ((uint64_t)range * velocity * TICK_MSEC << FRACTION_BITS)
+                    / (100ULL * 1000ULL));
+        }
+        if (velocity && acceleration)
+        {
+            acceleration_ = std::max<uint64_t>(1,
+                ((uint64_t)range * acceleration * TICK_MSEC * TICK_MSEC
+                    << FRACTION_BITS) / (100ULL * 1000ULL * 1000ULL));
+        }
+    }
+
+    /// @return true if motion is limited by a maximum velocity.
+    bool is_limited()
+    {
+        return maxVelocity_ != 0;
+    }
+
+    /// Moves immediately to a position and stops.
+    ///
+    /// @param counts is the new position in PWM counts.
+    void jump_to(uint32_t counts)
+    {
+        target_ = counts << FRACTION_BITS;
+        position_ = target_;
+        velocity_ = 0;
+    }
+
+    /// Sets the position to move towards with @ref step.
+    ///
+    /// @param counts is the target position in PWM counts.
+    void set_target(uint32_t counts)
+    {
+        target_ = counts << FRACTION_BITS;
+    }
+
+    /// Advances the position by one step.
+    ///
+    /// @return true if the target has not yet been reached.
+    bool step()
+    {
+        int32_t remaining = target_ - position_;
+        int32_t direction = remaining < 0 ? -1 : 1;
+        int32_t distance = std::abs(remaining);
+        int32_t speed = std::abs(velocity_);
+
+        if (!maxVelocity_)
+        {
+            // motion limiting was disabled while moving.
+            velocity_ = 0;
+            position_ = target_;
+        }
+        else if (!acceleration_)
+        {
+            velocity_ = direction * std::min(maxVelocity_, distance);
+            position_ += velocity_;
+        }
+        else if (velocity_ * direction < 0)
+        {
+            // moving away from the target, slow down before reversing.
+            speed = std::max<int32_t>(speed - acceleration_, 0);
+            velocity_ = -direction * speed;
+            position_ += velocity_;
+        }
+        else
+        {
+            // accelerate up to the maximum velocity but never beyond the
+            // speed from which the output can still stop at the target.
+            speed = std::min({speed + acceleration_, maxVelocity_,
+                              stopping_speed(distance)});
+            velocity_ = direction * speed;
+            position_ += velocity_;
+        }
+
+        bool moving = position_ != target_;
+        if (!moving)
+        {
+            velocity_ = 0;
+        }
+        return moving;
+    }
+
+    /// @return current position rounded to PWM counts.
+    uint32_t counts()
+    {
+        return (position_ + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS;
+    }
+
+    /// @return current position, in fixed point PWM counts.
+    int32_t position()
+    {
+        return position_;
+    }
+
+    /// @return current signed velocity, in fixed point PWM counts per tick.
+    int32_t velocity()
+    {
+        return velocity_;
+    }
+
+    /// @return maximum velocity, in fixed point PWM counts per tick.
+    int32_t max_velocity()
+    {
+        return maxVelocity_;
+    }
+
+    /// @return acceleration, in fixed point PWM counts per tick per tick.
+    int32_t acceleration()
+    {
+        return acceleration_;
+    }
+
+private:
+    /// Calculates the highest speed from which the output can stop within a
+    /// distance while slowing down by @ref acceleration_ on each step.
+    ///
+    /// Stopping from a speed of (n * a) + r travels a distance of
+    /// (a * n * (n + 1) / 2) + ((n + 1) * r) with r < a, this finds the
+    /// largest n that fits and then the largest r.
+    ///
+    /// @param distance is the distance to the target.
+    /// @return the stopping speed, this is never more than distance.
+    int32_t stopping_speed(int32_t distance)
+    {
+        int64_t accel = acceleration_;
+        int64_t steps =
+            (sqrtf((8.0f * distance / accel) + 1.0f) - 1.0f) / 2.0f;
+        // correct any rounding error from the float approximation.
+        while (steps > 0 && (accel * steps * (steps + 1)) / 2 > distance)
+        {
+            steps--;
+        }
+        while ((accel * (steps + 1) * (steps + 2)) / 2 <= distance)
+        {
+            steps++;
+        }
+        return (steps * accel) +
+               ((distance - ((accel * steps * (steps + 1)) / 2)) /
+                    (steps + 1));
+    }
+
+    /// Current position, in fixed point PWM counts.
+    int32_t position_{0};
+
+    /// Target position, in fixed point PWM counts.
+    int32_t target_{0};
+
+    /// Current signed velocity, in fixed point PWM counts per tick.
+    int32_t velocity_{0};
+
+    /// Maximum velocity, in fixed point PWM counts per tick.
+    int32_t maxVelocity_{0};
+
+    /// Acceleration, in fixed point PWM counts per tick per tick.
+    int32_t acceleration_{0};
+};
+
+} // namespace esp32io
+
+#endif // SERVO_PROFILE_HXX_
@@ -0,0 +1,248 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file TxPacer.hxx
+ *
+ * Pacing of bulk transmissions (identify replies and startup state events).
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef TX_PACER_HXX_
+#define TX_PACER_HXX_
+
+#include <os/os.h>
+#include <utils/logging.h>
+#include <utils/macros.h>
+#include <vector>
+
+#include "sdkconfig.h"
+
+#if CONFIG_OLCB_ENABLE_TWAI
+#include <freertos_drivers/esp32/Esp32HardwareTwai.hxx>
+#endif // CONFIG_OLCB_ENABLE_TWAI
+
+namespace esp32io
+{
+
+/// Reports how many packets are waiting in an outbound queue.
+class TxQueueProbe
+{
+public:
+    /// Destructor.
+    virtual ~TxQueueProbe()
+    {
+    }
+
+    /// @return number of packets waiting to be transmitted.
+    virtual size_t pending() = 0;
+
+    /// @return maximum number of packets the queue can hold.
+    virtual size_t capacity() = 0;
+};
+
+#if CONFIG_OLCB_ENABLE_TWAI
+/// @ref TxQueueProbe for the TWAI driver TX queue.
+class TwaiTxQueueProbe : public TxQueueProbe
+{
+public:
+    /// Constructor.
+    ///
+    /// @param twai is the @ref Esp32HardwareTwai driver to monitor.
+    TwaiTxQueueProbe(Esp32HardwareTwai *twai) : twai_(twai)
+    {
+    }
+
+    /// @return number of frames accepted by the driver which have not yet
+    /// completed (successfully or otherwise).
+    size_t pending() override
+    {
+        esp32_twai_stats_t stats;
+        twai_->get_driver_stats(&stats);
+        uint32_t completed = stats.tx_success + stats.tx_failed;
+        return stats.tx_processed > completed
+             ? stats.tx_processed - completed : 0;
+    }
+
+    /// @return size of the TWAI TX queue.
+    size_t capacity() override
+    {
+        return CONFIG_OLCB_TWAI_TX_BUFFER_SIZE;
+    }
+
+private:
+    /// TWAI driver being monitored.
+    Esp32HardwareTwai *twai_;
+};
+#endif // CONFIG_OLCB_ENABLE_TWAI
+
+/// Paces a burst of outbound messages so that it does not overrun the
+/// outbound queues of this node or the receive buffers of other nodes.
+///
+/// Messages are sent in groups of @ref CONFIG_OLCB_BULK_SEND_BURST with a
+/// pause of @ref CONFIG_OLCB_BULK_SEND_INTERVAL_MSEC between groups. The
+/// pause is also taken whenever a monitored queue is at least half full.
+class TxPacer
+{
+public:
+    /// Constructor.
+    TxPacer()
+    {
+    }
+
+    /// Adds a queue to monitor.
+    ///
+    /// @param probe is the @ref TxQueueProbe to monitor.
+    void add_probe(TxQueueProbe *probe)
+    {
+        probes_.push_back(probe);
+    }
+
+    /// Starts timing a new burst.
+    void begin()
+    {
+        startTime_ = os_get_time_monotonic();
+        sent_ = 0;
+        sentInGroup_ = 0;
+        pauses_ = 0;
+    }
+
+    /// Called before each message of the burst is sent.
+    ///
+    /// @return zero when the message can be sent now, otherwise the number
+    /// of nanoseconds to wait before calling this method again.
+    long long next_delay()
+    {
+        if (sentInGroup_ >= CONFIG_OLCB_BULK_SEND_BURST || congested())
+        {
+            sentInGroup_ = 0;
+            pauses_++;
+            return MSEC_TO_NSEC(CONFIG_OLCB_BULK_SEND_INTERVAL_MSEC);
+        }
+        sentInGroup_++;
+        sent_++;
+        return 0;
+    }
+
+    /// Completes the timing of the current burst.
+    ///
+    /// @param name is used in the log message.
+    void end(const char *name)
+    {
+        lastUsec_ = NSEC_TO_USEC(os_get_time_monotonic() - startTime_);
+        if (lastUsec_ > maxUsec_)
+        {
+            maxUsec_ = lastUsec_;
+        }
+        bursts_++;
+        messages_ += sent_;
+        totalPauses_ += pauses_;
+        LOG(INFO, "[%s] Sent %" PRIu32 " messages in %" PRIu32 " usec "
+                  "(%" PRIu32 " pauses)", name, sent_, lastUsec_, pauses_);
+    }
+
+    /// @return number of completed bursts.
+    uint32_t bursts()
+    {
+        return bursts_;
+    }
+
+    /// @return number of messages sent in all completed bursts.
+    uint32_t messages()
+    {
+        return messages_;
+    }
+
+    /// @return number of pauses taken in all completed bursts.
+    uint32_t pauses()
+    {
+        return totalPauses_;
+    }
+
+    /// @return duration of the last completed burst in microseconds.
+    uint32_t last_usec()
+    {
+        return lastUsec_;
+    }
+
+    /// @return duration of the longest completed burst in microseconds.
+    uint32_t max_usec()
+    {
+        return maxUsec_;
+    }
+
+private:
+    /// Queues being monitored.
+    std::vector<TxQueueProbe *> probes_;
+
+    /// Start time of the current burst.
+    long long startTime_{0};
+
+    /// Number of messages sent in the current burst.
+    uint32_t sent_{0};
+
+    /// Number of messages sent since the last pause.
+    uint32_t sentInGroup_{0};
+
+    /// Number of pauses taken in the current burst.
+    uint32_t pauses_{0};
+
+    /// Number of completed bursts.
+    uint32_t bursts_{0};
+
+    /// Number of messages sent in all completed bursts.
+    uint32_t messages_{0};
+
+    /// Number of pauses taken in all completed bursts.
+    uint32_t totalPauses_{0};
+
+    /// Duration of the last completed burst in microseconds.
+    uint32_t lastUsec_{0};
+
+    /// Duration of the longest completed burst in microseconds.
+    uint32_t maxUsec_{0};
+
+    /// @return true if any monitored queue is at least half full.
+    bool congested()
+    {
+        for (TxQueueProbe *probe : probes_)
+        {
+            if (probe->pending() * 2 >= probe->capacity())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(TxPacer);
+};
+
+} // namespace esp32io
+
+#endif // TX_PACER_HXX_
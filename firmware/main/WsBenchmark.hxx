@@ -0,0 +1,146 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file WsBenchmark.hxx
+ *
+ * Micro-benchmark of the JSON and binary websocket protocols.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef WS_BENCHMARK_HXX_
+#define WS_BENCHMARK_HXX_
+
+#include "WsProtocol.hxx"
+
+#include <cJSON.h>
+#include <HttpStringUtils.h>
+#include <inttypes.h>
+#include <os/os.h>
+#include <string>
+#include <utils/logging.h>
+#include <utils/StringPrintf.hxx>
+
+namespace esp32io
+{
+
+/// Measures the cost of parsing a CDI read request and serializing the
+/// response for a 32 byte string field with the JSON protocol (cJSON,
+/// StringPrintf and base64 as used by the websocket handler) and with the
+/// binary protocol. The results are written to the log.
+///
+/// This only depends on cJSON, the HttpServer string utilities and the
+/// OpenMRN os layer so it can also be run on the host.
+///
+/// @param iterations is the number of messages to average over.
+inline void benchmark_ws_protocol(size_t iterations = 1000)
+{
+    static constexpr char JSON_REQUEST[] =
+        R"!^!({"req":"cdi","ofs":128,"type":"str","sz":32,)!^!"
+        R"!^!("tgt":"seg-1-line-0-name","spc":253,)!^!"
+        R"!^!("node":"05.01.01.01.8F.00"})!^!";
+    static constexpr uint8_t FIELD_SIZE = 32;
+    static constexpr char FIELD_VALUE[FIELD_SIZE] = "Yard lead east";
+    // prevents the compiler from discarding the decoded values.
+    volatile size_t sink = 0;
+
+    long long start = os_get_time_monotonic();
+    for (size_t idx = 0; idx < iterations; idx++)
+    {
+        std::string req(JSON_REQUEST);
+        cJSON *root = cJSON_Parse(req.c_str());
+        size_t offs = cJSON_GetObjectItem(root, "ofs")->valueint;
+        std::string type = cJSON_GetObjectItem(root, "type")->valuestring;
+        size_t size = cJSON_GetObjectItem(root, "sz")->valueint;
+        std::string target = cJSON_GetObjectItem(root, "tgt")->valuestring;
+        std::string node = cJSON_GetObjectItem(root, "node")->valuestring;
+        cJSON_Delete(root);
+        sink += offs + size + type.size() + target.size() + node.size();
+    }
+    long long json_parse = os_get_time_monotonic() - start;
+
+    size_t json_response = 0;
+    start = os_get_time_monotonic();
+    for (size_t idx = 0; idx < iterations; idx++)
+    {
+        std::string value(FIELD_VALUE, FIELD_SIZE);
+        std::string response =
+            StringPrintf(R"!^!({"res":"field","tgt":"%s","val":"%s",)!^!"
+                         R"!^!("type":"%s","id":%zu})!^!",
+                         "seg-1-line-0-name",
+                         base64_encode(value).c_str(), "str", idx);
+        json_response = response.size();
+        sink += json_response;
+    }
+    long long json_serialize = os_get_time_monotonic() - start;
+
+    WsFrameHeader header = {WS_OP_CDI_READ, 0, 1};
+    WsCdiRequest body = {0x050101018F00ULL, 128, 253, FIELD_SIZE};
+    std::string frame((const char *)&header, sizeof(header));
+    frame.append((const char *)&body, sizeof(body));
+    start = os_get_time_monotonic();
+    for (size_t idx = 0; idx < iterations; idx++)
+    {
+        WsRequest req;
+        if (ws_decode_request((const uint8_t *)frame.data(), frame.size(),
+                              &req))
+        {
+            sink += req.offs + req.size + req.id;
+        }
+    }
+    long long binary_parse = os_get_time_monotonic() - start;
+
+    size_t binary_response = 0;
+    start = os_get_time_monotonic();
+    uint8_t response[WS_MAX_FRAME];
+    for (size_t idx = 0; idx < iterations; idx++)
+    {
+        binary_response =
+            ws_encode_response(WS_OP_CDI_READ, idx, 0, response);
+        memcpy(response + binary_response, FIELD_VALUE, FIELD_SIZE);
+        binary_response += FIELD_SIZE;
+        sink += response[binary_response - 1];
+    }
+    long long binary_serialize = os_get_time_monotonic() - start;
+
+    LOG(INFO, "[WS] JSON: parse %" PRIu32 " nsec/msg, serialize %" PRIu32
+              " nsec/msg, request %zu bytes, response %zu bytes",
+        (uint32_t)(json_parse / iterations),
+        (uint32_t)(json_serialize / iterations), sizeof(JSON_REQUEST) - 1,
+        json_response);
+    LOG(INFO, "[WS] binary: parse %" PRIu32 " nsec/msg, serialize %" PRIu32
+              " nsec/msg, request %zu bytes, response %zu bytes",
+        (uint32_t)(binary_parse / iterations),
+        (uint32_t)(binary_serialize / iterations), frame.size(),
+        binary_response);
+    (void)sink;
+}
+
+} // namespace esp32io
+
+#endif // WS_BENCHMARK_HXX_
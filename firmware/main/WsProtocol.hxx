@@ -0,0 +1,310 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file WsProtocol.hxx
+ *
+ * Binary framed websocket protocol used alongside the JSON protocol.
+ *
+ * All multi-byte values are little-endian. Every frame starts with a
+ * @ref WsFrameHeader, responses use the request opcode with
+ * @ref WS_OP_RESPONSE set and a @ref WsResponseHeader with the result of the
+ * request (zero or an OpenLCB error code). The frames following the header
+ * are:
+ *
+ * | Opcode     | Request                        | Response                  |
+ * |------------|--------------------------------|---------------------------|
+ * | INFO       | (none)                         | @ref WsInfo, strings      |
+ * | CDI_READ   | @ref WsCdiRequest              | field data                |
+ * | CDI_WRITE  | @ref WsCdiRequest, field data  | (none)                    |
+ * | CDI_BATCH  | @ref WsCdiBatch, fields        | count, fields             |
+ * | EVENT_TEST | event ID                       | (none)                    |
+ *
+ * A batch request contains @ref WsCdiBatch::count @ref WsBatchField entries,
+ * the response contains a count byte followed by the fields that were read
+ * as {index, size, data} where index is the position of the field in the
+ * request. The strings of the info response are each prefixed by a length
+ * byte. Responses are at most @ref WS_MAX_FRAME bytes, batch requests with
+ * a larger response are rejected.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef WS_PROTOCOL_HXX_
+#define WS_PROTOCOL_HXX_
+
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+namespace esp32io
+{
+
+/// Maximum size of a binary websocket response.
+static constexpr size_t WS_MAX_FRAME = 512;
+
+/// Opcodes of the binary websocket protocol.
+enum WsOpcode : uint8_t
+{
+    /// Node information.
+    WS_OP_INFO = 0x01,
+
+    /// Read of a single configuration field.
+    WS_OP_CDI_READ = 0x02,
+
+    /// Write of a single configuration field.
+    WS_OP_CDI_WRITE = 0x03,
+
+    /// Read of multiple configuration fields of a node.
+    WS_OP_CDI_BATCH = 0x04,
+
+    /// Produces an event.
+    WS_OP_EVENT_TEST = 0x05,
+
+    /// Set on the opcode of all responses.
+    WS_OP_RESPONSE = 0x80
+};
+
+/// Header of every binary websocket frame.
+struct WsFrameHeader
+{
+    /// @ref WsOpcode of the frame.
+    uint8_t opcode;
+
+    /// Reserved, must be zero.
+    uint8_t reserved;
+
+    /// Identifier chosen by the client, returned in the response.
+    uint16_t tag;
+} __attribute__((packed));
+
+/// Follows the @ref WsFrameHeader of every response.
+struct WsResponseHeader
+{
+    /// Zero on success, otherwise an OpenLCB error code.
+    uint16_t status;
+} __attribute__((packed));
+
+/// Body of a @ref WS_OP_CDI_READ or @ref WS_OP_CDI_WRITE request.
+struct WsCdiRequest
+{
+    /// Node to read from or write to.
+    uint64_t node;
+
+    /// Offset of the field.
+    uint32_t offs;
+
+    /// Memory space of the field.
+    uint8_t space;
+
+    /// Size of the field, for writes this is the number of bytes following.
+    uint8_t size;
+} __attribute__((packed));
+
+/// Body of a @ref WS_OP_CDI_BATCH request.
+struct WsCdiBatch
+{
+    /// Node to read from.
+    uint64_t node;
+
+    /// Memory space of the fields.
+    uint8_t space;
+
+    /// Number of @ref WsBatchField following.
+    uint8_t count;
+} __attribute__((packed));
+
+/// Field of a @ref WS_OP_CDI_BATCH request.
+struct WsBatchField
+{
+    /// Offset of the field.
+    uint32_t offs;
+
+    /// Size of the field.
+    uint8_t size;
+} __attribute__((packed));
+
+/// Body of a @ref WS_OP_INFO response, followed by the build, timestamp,
+/// running partition, model, hardware version and software version strings.
+struct WsInfo
+{
+    /// Node ID of this node.
+    uint64_t node_id;
+
+    /// @ref FLAG_TWAI and @ref FLAG_PWM.
+    uint8_t flags;
+
+    /// Set when TWAI is enabled.
+    static constexpr uint8_t FLAG_TWAI = 0x01;
+
+    /// Set when PWM is enabled.
+    static constexpr uint8_t FLAG_PWM = 0x02;
+} __attribute__((packed));
+
+/// Decoded binary websocket request, data points into the received frame.
+struct WsRequest
+{
+    /// @ref WsOpcode of the request.
+    uint8_t opcode;
+
+    /// Identifier to return in the response.
+    uint16_t tag;
+
+    /// Target node (CDI requests) or event ID (@ref WS_OP_EVENT_TEST).
+    uint64_t id;
+
+    /// Offset of the field (@ref WS_OP_CDI_READ and @ref WS_OP_CDI_WRITE).
+    uint32_t offs;
+
+    /// Memory space of the field(s).
+    uint8_t space;
+
+    /// Size of the field or number of fields (@ref WS_OP_CDI_BATCH).
+    uint8_t size;
+
+    /// Field data (@ref WS_OP_CDI_WRITE) or @ref WsBatchField entries
+    /// (@ref WS_OP_CDI_BATCH).
+    const uint8_t *data;
+
+    /// Returns a field of a @ref WS_OP_CDI_BATCH request.
+    ///
+    /// @param index is the index of the field, less than @ref size.
+    /// @return the requested field.
+    WsBatchField field(size_t index) const
+    {
+        WsBatchField field;
+        memcpy(&field, data + (index * sizeof(WsBatchField)), sizeof(field));
+        return field;
+    }
+};
+
+/// Decodes a binary websocket request.
+///
+/// @param frame is the received frame.
+/// @param len is the length of @p frame.
+/// @param req will receive the decoded request.
+/// @return true if the frame is a complete and supported request.
+inline bool ws_decode_request(const uint8_t *frame, size_t len,
+                              WsRequest *req)
+{
+    WsFrameHeader header;
+    if (len < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, frame, sizeof(header));
+    frame += sizeof(header);
+    len -= sizeof(header);
+    memset(req, 0, sizeof(WsRequest));
+    req->opcode = header.opcode;
+    req->tag = header.tag;
+    switch (header.opcode)
+    {
+        case WS_OP_INFO:
+            return true;
+        case WS_OP_CDI_READ:
+        case WS_OP_CDI_WRITE:
+        {
+            WsCdiRequest cdi;
+            if (len < sizeof(cdi))
+            {
+                return false;
+            }
+            memcpy(&cdi, frame, sizeof(cdi));
+            req->id = cdi.node;
+            req->offs = cdi.offs;
+            req->space = cdi.space;
+            req->size = cdi.size;
+            req->data = frame + sizeof(cdi);
+            return header.opcode == WS_OP_CDI_READ ||
+                   len - sizeof(cdi) >= cdi.size;
+        }
+        case WS_OP_CDI_BATCH:
+        {
+            WsCdiBatch batch;
+            if (len < sizeof(batch))
+            {
+                return false;
+            }
+            memcpy(&batch, frame, sizeof(batch));
+            req->id = batch.node;
+            req->space = batch.space;
+            req->size = batch.count;
+            req->data = frame + sizeof(batch);
+            return len - sizeof(batch) >= batch.count * sizeof(WsBatchField);
+        }
+        case WS_OP_EVENT_TEST:
+            if (len < sizeof(uint64_t))
+            {
+                return false;
+            }
+            memcpy(&req->id, frame, sizeof(uint64_t));
+            return true;
+    }
+    return false;
+}
+
+/// Starts a binary websocket response.
+///
+/// @param opcode is the @ref WsOpcode of the request.
+/// @param tag is the identifier of the request.
+/// @param status is zero or an OpenLCB error code.
+/// @param out will receive the response header, this must have room for
+/// @ref WS_MAX_FRAME bytes.
+/// @return the number of bytes written to @p out.
+inline size_t ws_encode_response(uint8_t opcode, uint16_t tag,
+                                 uint16_t status, uint8_t *out)
+{
+    WsFrameHeader header = {(uint8_t)(opcode | WS_OP_RESPONSE), 0, tag};
+    WsResponseHeader response = {status};
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), &response, sizeof(response));
+    return sizeof(header) + sizeof(response);
+}
+
+/// Appends a length-prefixed string to a binary websocket response.
+///
+/// @param value is the string to append, it is truncated to fit.
+/// @param out is the response being built.
+/// @param len is the length of @p out, this will be updated.
+inline void ws_append_string(const char *value, uint8_t *out, size_t *len)
+{
+    if (*len >= WS_MAX_FRAME)
+    {
+        return;
+    }
+    size_t size = std::min(std::min(strlen(value), (size_t)UINT8_MAX),
+                           WS_MAX_FRAME - *len - 1);
+    out[(*len)++] = size;
+    memcpy(out + *len, value, size);
+    *len += size;
+}
+
+} // namespace esp32io
+
+#endif // WS_PROTOCOL_HXX_
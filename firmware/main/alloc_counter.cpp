@@ -0,0 +1,88 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file alloc_counter.cpp
+ *
+ * Counts the heap allocations made on the web request path.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#include "sdkconfig.h"
+#include "alloc_counter.hxx"
+
+#include <atomic>
+#include <esp_attr.h>
+#include <freertos_includes.h>
+#include <stddef.h>
+
+namespace esp32io
+{
+
+/// True when the allocations of the calling task are counted.
+static thread_local bool counting = false;
+
+/// Number of allocations made by all tasks while @ref counting.
+static std::atomic<uint32_t> allocations{0};
+
+uint32_t alloc_count()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+AllocCounterScope::AllocCounterScope(bool enable) : previous_(counting)
+{
+    counting = enable;
+}
+
+AllocCounterScope::~AllocCounterScope()
+{
+    counting = previous_;
+}
+
+} // namespace esp32io
+
+#if CONFIG_WS_ALLOC_COUNTER
+/// Called by the heap for every successful allocation.
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size,
+                                                    uint32_t caps)
+{
+    // Thread local storage is only set up once the scheduler is running and
+    // it does not exist in interrupt context.
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING &&
+        !xPortInIsrContext() && esp32io::counting)
+    {
+        esp32io::allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/// Called by the heap for every free, not used.
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+}
+#endif // CONFIG_WS_ALLOC_COUNTER
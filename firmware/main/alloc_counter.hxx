@@ -0,0 +1,72 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file alloc_counter.hxx
+ *
+ * Counts the heap allocations made on the web request path.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef ALLOC_COUNTER_HXX_
+#define ALLOC_COUNTER_HXX_
+
+#include <stdint.h>
+
+namespace esp32io
+{
+
+/// @return the number of heap allocations made inside an
+/// @ref AllocCounterScope since startup, this is always zero when
+/// CONFIG_WS_ALLOC_COUNTER is not enabled.
+uint32_t alloc_count();
+
+/// Counts the heap allocations made by the calling task while the scope
+/// exists. Scopes can be nested, an inner scope can also pause the counting
+/// (for example around calls into the web server which allocate on their
+/// own). The counting state is kept per task so scopes on different tasks do
+/// not affect each other, all tasks add to the same @ref alloc_count.
+class AllocCounterScope
+{
+public:
+    /// Constructor.
+    ///
+    /// @param enable is true to count allocations, false to pause counting.
+    AllocCounterScope(bool enable = true);
+
+    /// Restores the counting state of the enclosing scope.
+    ~AllocCounterScope();
+
+private:
+    /// Counting state of the calling task when this scope was entered.
+    bool previous_;
+};
+
+} // namespace esp32io
+
+#endif // ALLOC_COUNTER_HXX_
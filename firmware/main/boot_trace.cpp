@@ -0,0 +1,242 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file boot_trace.cpp
+ *
+ * Startup phase timing trace retained in RTC memory across resets.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#include "sdkconfig.h"
+#include "boot_trace.hxx"
+
+#include <esp_app_desc.h>
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <esp_timer.h>
+#include <freertos_includes.h>
+#include <algorithm>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <utils/logging.h>
+#include <utils/StringPrintf.hxx>
+
+#ifndef CONFIG_BOOT_TRACE_HISTORY
+#define CONFIG_BOOT_TRACE_HISTORY 4
+#endif
+
+/// Identifies a valid boot trace in RTC memory.
+static constexpr uint32_t BOOT_TRACE_MAGIC = 0x42545243;
+
+/// Number of characters of the firmware version retained for each boot.
+static constexpr size_t BOOT_TRACE_VERSION_LEN = 16;
+
+/// Number of recorded phases.
+static constexpr size_t BOOT_PHASE_COUNT = (size_t)BootPhase::COUNT;
+
+/// Names of the phases, in the order of @ref BootPhase.
+static const char * const BOOT_PHASE_NAMES[] =
+{
+    "nvs",
+    "factory-reset",
+    "mount-fs",
+    "stack",
+    "wifi",
+    "webserver",
+    "pwm",
+    "io",
+    "twai",
+    "init-join",
+    "config",
+    "executor",
+    "pwm-join",
+    "fs-dump",
+};
+static_assert(sizeof(BOOT_PHASE_NAMES) / sizeof(BOOT_PHASE_NAMES[0]) ==
+              BOOT_PHASE_COUNT, "BOOT_PHASE_NAMES does not match BootPhase");
+
+/// Trace of a single boot.
+typedef struct
+{
+    /// Firmware version, may not be NULL terminated.
+    char version[BOOT_TRACE_VERSION_LEN];
+
+    /// Reason for the CPU reset which started this boot.
+    uint8_t reset_reason;
+
+    /// Completion time of each phase in microseconds since reset, zero if
+    /// the phase was not reached.
+    uint32_t phase_usec[BOOT_PHASE_COUNT];
+} boot_record_t;
+
+/// All retained boot traces.
+typedef struct
+{
+    /// Set to @ref BOOT_TRACE_MAGIC when the trace is valid.
+    uint32_t magic;
+
+    /// Number of boots recorded, the current boot is stored at index
+    /// (count - 1) % CONFIG_BOOT_TRACE_HISTORY.
+    uint32_t count;
+
+    /// Boot traces.
+    boot_record_t records[CONFIG_BOOT_TRACE_HISTORY];
+
+    /// CRC32 of all preceding fields.
+    uint32_t crc;
+} boot_trace_t;
+
+/// Boot traces, this is not cleared by software, watchdog or brownout
+/// resets but does not survive the loss of power.
+static RTC_NOINIT_ATTR boot_trace_t boot_trace;
+
+/// Trace of the current boot, nullptr until @ref boot_trace_init.
+static boot_record_t *current_boot = nullptr;
+
+/// Protects @ref boot_trace, phases may be recorded from both cores.
+static portMUX_TYPE boot_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/// @return the CRC32 of the boot trace.
+static uint32_t boot_trace_crc()
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&boot_trace,
+                            offsetof(boot_trace_t, crc));
+}
+
+void boot_trace_init(uint8_t reset_reason)
+{
+    if (boot_trace.magic != BOOT_TRACE_MAGIC ||
+        boot_trace.crc != boot_trace_crc())
+    {
+        memset(&boot_trace, 0, sizeof(boot_trace_t));
+        boot_trace.magic = BOOT_TRACE_MAGIC;
+    }
+    current_boot =
+        &boot_trace.records[boot_trace.count % CONFIG_BOOT_TRACE_HISTORY];
+    boot_trace.count++;
+    memset(current_boot, 0, sizeof(boot_record_t));
+    strncpy(current_boot->version, esp_app_get_description()->version,
+            BOOT_TRACE_VERSION_LEN);
+    current_boot->reset_reason = reset_reason;
+    boot_trace.crc = boot_trace_crc();
+}
+
+void boot_trace_record(BootPhase phase)
+{
+    if (!current_boot || phase >= BootPhase::COUNT)
+    {
+        return;
+    }
+    uint32_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&boot_trace_lock);
+    current_boot->phase_usec[(size_t)phase] = now;
+    boot_trace.crc = boot_trace_crc();
+    portEXIT_CRITICAL(&boot_trace_lock);
+}
+
+const char *boot_trace_phase_name(BootPhase phase)
+{
+    if (phase >= BootPhase::COUNT)
+    {
+        return "unknown";
+    }
+    return BOOT_PHASE_NAMES[(size_t)phase];
+}
+
+/// Calls @param callback for each retained boot, newest first.
+///
+/// @param callback receives the age of the boot (zero for the current boot)
+/// and a copy of the @ref boot_record_t.
+template <typename F> static void boot_trace_foreach(F callback)
+{
+    portENTER_CRITICAL(&boot_trace_lock);
+    uint32_t count = boot_trace.count;
+    portEXIT_CRITICAL(&boot_trace_lock);
+    uint32_t available = std::min(count, (uint32_t)CONFIG_BOOT_TRACE_HISTORY);
+    for (uint32_t age = 0; age < available; age++)
+    {
+        boot_record_t record;
+        portENTER_CRITICAL(&boot_trace_lock);
+        memcpy(&record,
+               &boot_trace.records[(count - 1 - age) %
+                                   CONFIG_BOOT_TRACE_HISTORY],
+               sizeof(boot_record_t));
+        portEXIT_CRITICAL(&boot_trace_lock);
+        callback(age, record);
+    }
+}
+
+void boot_trace_dump()
+{
+    boot_trace_foreach([](uint32_t age, const boot_record_t &record)
+    {
+        std::string phases;
+        for (size_t idx = 0; idx < BOOT_PHASE_COUNT; idx++)
+        {
+            if (record.phase_usec[idx])
+            {
+                phases += StringPrintf(" %s:%" PRIu32, BOOT_PHASE_NAMES[idx],
+                                       record.phase_usec[idx]);
+            }
+        }
+        LOG(INFO, "[Boot] -%" PRIu32 " %.*s (reset:%d) usec:%s", age,
+            (int)BOOT_TRACE_VERSION_LEN, record.version, record.reset_reason,
+            phases.c_str());
+    });
+}
+
+std::string boot_trace_json()
+{
+    std::string json = "[";
+    boot_trace_foreach([&json](uint32_t age, const boot_record_t &record)
+    {
+        if (age)
+        {
+            json += ",";
+        }
+        json += StringPrintf(R"!^!({"version":"%.*s","reset":%d,"usec":{)!^!",
+                             (int)BOOT_TRACE_VERSION_LEN, record.version,
+                             record.reset_reason);
+        bool first = true;
+        for (size_t idx = 0; idx < BOOT_PHASE_COUNT; idx++)
+        {
+            if (record.phase_usec[idx])
+            {
+                json += StringPrintf(R"!^!(%s"%s":%" PRIu32)!^!",
+                                     first ? "" : ",", BOOT_PHASE_NAMES[idx],
+                                     record.phase_usec[idx]);
+                first = false;
+            }
+        }
+        json += "}}";
+    });
+    json += "]";
+    return json;
+}
@@ -0,0 +1,112 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file boot_trace.hxx
+ *
+ * Startup phase timing trace retained in RTC memory across resets.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef BOOT_TRACE_HXX_
+#define BOOT_TRACE_HXX_
+
+#include <stdint.h>
+#include <string>
+
+/// Startup phases recorded in the boot trace.
+enum class BootPhase : uint8_t
+{
+    /// NVS initialized and node configuration loaded.
+    NVS,
+
+    /// Factory reset and bootloader button checks completed.
+    FACTORY_RESET,
+
+    /// Persistent filesystem mounted.
+    MOUNT_FS,
+
+    /// OpenLCB stack and node constructed.
+    STACK,
+
+    /// WiFi manager constructed.
+    WIFI,
+
+    /// Web server initialized.
+    WEBSERVER,
+
+    /// PCA9685 probe completed.
+    PWM,
+
+    /// IO pins and input engines initialized.
+    IO,
+
+    /// TWAI driver initialized and attached to the stack.
+    TWAI,
+
+    /// Concurrent startup stages completed.
+    INIT_JOIN,
+
+    /// Configuration file opened.
+    CONFIG,
+
+    /// OpenLCB executor started.
+    EXECUTOR,
+
+    /// PCA9685 probe joined and servo outputs registered.
+    PWM_JOIN,
+
+    /// Deferred filesystem listing completed.
+    FS_DUMP,
+
+    /// Number of phases, not a phase.
+    COUNT
+};
+
+/// Starts the trace for the current boot, this must be called once early in
+/// startup before any phase is recorded.
+///
+/// @param reset_reason is the reason for the last CPU reset.
+void boot_trace_init(uint8_t reset_reason);
+
+/// Records the completion of a startup phase for the current boot.
+///
+/// @param phase is the @ref BootPhase which has completed.
+void boot_trace_record(BootPhase phase);
+
+/// @param phase is the @ref BootPhase.
+/// @return name of the phase.
+const char *boot_trace_phase_name(BootPhase phase);
+
+/// Prints all retained boot traces to the serial console.
+void boot_trace_dump();
+
+/// @return all retained boot traces as a JSON array, newest first.
+std::string boot_trace_json();
+
+#endif // BOOT_TRACE_HXX_
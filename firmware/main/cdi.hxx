@@ -37,18 +37,26 @@
 
 #include "sdkconfig.h"
 
+#include "IoConfig.hxx"
+#include "ServoMotionConfig.hxx"
+
 #include <freertos_drivers/esp32/Esp32WiFiConfiguration.hxx>
 #include <openlcb/ConfigRepresentation.hxx>
-#include <openlcb/ConfiguredProducer.hxx>
-#include <openlcb/MultiConfiguredPC.hxx>
-#include <openlcb/ServoConsumerConfig.hxx>
 
 namespace esp32io
 {
 
-using INPUT_ONLY_PINS = openlcb::RepeatedGroup<openlcb::ProducerConfig, 4>;
-using CONFIGURABLE_GPIO_PINS = openlcb::RepeatedGroup<openlcb::PCConfig, 14>;
-using PWM_PINS = openlcb::RepeatedGroup<openlcb::ServoConsumerConfig, 16>;
+#ifndef CONFIG_OLCB_PWM_MAX_DEVICES
+#define CONFIG_OLCB_PWM_MAX_DEVICES 1
+#endif // CONFIG_OLCB_PWM_MAX_DEVICES
+
+/// Number of PWM outputs declared in the CDI, each PCA9685 provides 16.
+static constexpr size_t PWM_CHANNEL_COUNT = 16 * CONFIG_OLCB_PWM_MAX_DEVICES;
+
+using INPUT_ONLY_PINS = openlcb::RepeatedGroup<InputConfig, 4>;
+using CONFIGURABLE_GPIO_PINS = openlcb::RepeatedGroup<IoConfig, 14>;
+using PWM_PINS =
+    openlcb::RepeatedGroup<ServoMotionConfig, PWM_CHANNEL_COUNT>;
 
 /// Defines the main segment in the configuration CDI. This is laid out at
 /// origin 128 to give space for the ACDI user data at the beginning.
@@ -67,6 +75,13 @@ CDI_GROUP_ENTRY(pwm, PWM_PINS, Name("PWM"), RepName("PWM")
               , Hidden(true)
 #endif // !CONFIG_OLCB_ENABLE_PWM
 );
+CDI_GROUP_ENTRY(gpio_range, EventRangeConfig,
+                Name("Input Output Pin Events"));
+CDI_GROUP_ENTRY(pwm_range, EventRangeConfig, Name("PWM Events")
+#if !CONFIG_OLCB_ENABLE_PWM
+              , Hidden(true)
+#endif // !CONFIG_OLCB_ENABLE_PWM
+);
 CDI_GROUP_END();
 
 /// This segment is only needed temporarily until there is program code to set
@@ -223,11 +238,12 @@ Note: it is not recommended to enable the Hub functionality on single-core ESP32
 <name>Description</name>
 <description>User name of this input.</description>
 </string>
-<int size='1'>
-<name>Debounce parameter</name>
-<description>Amount of time to wait for the input to stabilize before producing the event. Unit is 30 msec of time. Usually a value of 2-3 works well in a non-noisy environment. In high noise (train wheels for example) a setting between 8 -- 15 makes for a slower response time but a more stable signal.
-Formally, the parameter tells how many times of tries, each 30 msec apart, the input must have the same value in order for that value to be accepted and the event transition produced.</description>
-<default>3</default>
+<int size='2'>
+<name>Debounce time</name>
+<description>Amount of time, in milliseconds, that the input must remain stable before the event is produced. Usually 50-100 works well in a non-noisy environment. In high noise (train wheels for example) a setting between 250 -- 500 makes for a slower response time but a more stable signal.</description>
+<min>0</min>
+<max>60000</max>
+<default>90</default>
 </int>
 <eventid>
 <name>Event On</name>
@@ -237,6 +253,46 @@ Formally, the parameter tells how many times of tries, each 30 msec apart, the i
 <name>Event Off</name>
 <description>This event will be produced when the input goes to LOW.</description>
 </eventid>
+<int size='2'>
+<name>Event rate limit</name>
+<description>Maximum number of events per minute that will be produced by this input, short bursts up to the burst size are allowed. A value of zero disables rate limiting.</description>
+<min>0</min>
+<max>6000</max>
+<default>0</default>
+</int>
+<int size='1'>
+<name>Event burst size</name>
+<description>Number of events that can be produced back to back before the event rate limit applies.</description>
+<min>1</min>
+<max>255</max>
+<default>4</default>
+</int>
+<int size='1'>
+<name>Rate limit mode</name>
+<description>Drop discards transitions that exceed the rate limit. Collapse to latest produces the most recent state of the input once the rate limit allows another event.</description>
+<default>1</default>
+<map><relation><property>0</property><value>Drop</value></relation><relation><property>1</property><value>Collapse to latest</value></relation></map>
+</int>
+<int size='1'>
+<name>Input mode</name>
+<description>Analog is only supported by Input 9 and Input 10, the input is sampled by the ADC and compared to the analog thresholds rather than being used as a digital input.</description>
+<default>0</default>
+<map><relation><property>0</property><value>Digital</value></relation><relation><property>1</property><value>Analog</value></relation></map>
+</int>
+<int size='2'>
+<name>Analog on threshold</name>
+<description>Used for analog mode only. Filtered ADC reading (0 - 4095, approximately 0 - 3.1V) at or above which the on event is produced.</description>
+<min>0</min>
+<max>4095</max>
+<default>1000</default>
+</int>
+<int size='2'>
+<name>Analog off threshold</name>
+<description>Used for analog mode only. Filtered ADC reading at or below which the off event is produced, this must be lower than the on threshold.</description>
+<min>0</min>
+<max>4095</max>
+<default>800</default>
+</int>
 </group>
 <group replication='14'>
 <name>Input Output Pins</name>
@@ -244,16 +300,15 @@ Formally, the parameter tells how many times of tries, each 30 msec apart, the i
 <int size='1'>
 <name>Configuration</name>
 <default>1</default>
-<map><relation><property>0</property><value>Output</value></relation><relation><property>1</property><value>Input</value></relation></map>
+<map><relation><property>0</property><value>Output</value></relation><relation><property>1</property><value>Input</value></relation><relation><property>2</property><value>Pulse counter</value></relation><relation><property>3</property><value>Analog input</value></relation></map>
 </int>
-<int size='1'>
-<name>Debounce parameter</name>
-<description>Used for inputs only. Amount of time to wait for the input to stabilize before producing the event. Unit is 30 msec of time. Usually a value of 2-3 works well in a non-noisy environment. In high noise (train wheels for example) a setting between 8 -- 15 makes for a slower response time but a more stable signal.
-Formally, the parameter tells how many times of tries, each 30 msec apart, the input must have the same value in order for that value to be accepted and the event transition produced.</description>
-<default>3</default>
+<int size='2'>
+<name>Debounce time</name>
+<description>Used for inputs only. Amount of time, in milliseconds, that the input must remain stable before the event is produced. Usually 50-100 works well in a non-noisy environment. In high noise (train wheels for example) a setting between 250 -- 500 makes for a slower response time but a more stable signal.</description>
+<min>0</min>
+<max>60000</max>
+<default>90</default>
 </int>
-<group offset='1'/>
-<group>
 <string size='20'>
 <name>Description</name>
 <description>User name of this line.</description>
@@ -266,10 +321,81 @@ Formally, the parameter tells how many times of tries, each 30 msec apart, the i
 <name>Event Off</name>
 <description>This event ID will turn the output off / be produced when the input goes off.</description>
 </eventid>
-</group>
+<int size='2'>
+<name>Event rate limit</name>
+<description>Used for inputs only. Maximum number of events per minute that will be produced by this input, short bursts up to the burst size are allowed. A value of zero disables rate limiting.</description>
+<min>0</min>
+<max>6000</max>
+<default>0</default>
+</int>
+<int size='1'>
+<name>Event burst size</name>
+<description>Used for inputs only. Number of events that can be produced back to back before the event rate limit applies.</description>
+<min>1</min>
+<max>255</max>
+<default>4</default>
+</int>
+<int size='1'>
+<name>Rate limit mode</name>
+<description>Used for inputs only. Drop discards transitions that exceed the rate limit. Collapse to latest produces the most recent state of the input once the rate limit allows another event.</description>
+<default>1</default>
+<map><relation><property>0</property><value>Drop</value></relation><relation><property>1</property><value>Collapse to latest</value></relation></map>
+</int>
+<int size='1'>
+<name>Pulse counter mode</name>
+<description>Used for pulse counter only. Count produces the on event every time the threshold number of pulses has been counted and the off event once no pulses have been counted for the window time. Rate produces the on event when at least the threshold number of pulses are counted within the window time and the off event when the rate drops below the threshold.</description>
+<default>0</default>
+<map><relation><property>0</property><value>Count</value></relation><relation><property>1</property><value>Rate</value></relation></map>
+</int>
+<int size='2'>
+<name>Pulse count threshold</name>
+<description>Used for pulse counter only. Number of pulses (rising edges) required to produce the on event.</description>
+<min>1</min>
+<max>32767</max>
+<default>1</default>
+</int>
+<int size='2'>
+<name>Pulse window time</name>
+<description>Used for pulse counter only. Time, in milliseconds, of the counting window.</description>
+<min>10</min>
+<max>60000</max>
+<default>1000</default>
+</int>
+<int size='2'>
+<name>Pulse glitch filter</name>
+<description>Used for pulse counter only. Pulses shorter than this time, in nanoseconds, are ignored by the hardware. A value of zero disables the filter.</description>
+<min>0</min>
+<max>12000</max>
+<default>1000</default>
+</int>
+<int size='2'>
+<name>Analog on threshold</name>
+<description>Used for analog input only, this is only supported by IO 11 and IO 12. Filtered ADC reading (0 - 4095, approximately 0 - 3.1V) at or above which the on event is produced.</description>
+<min>0</min>
+<max>4095</max>
+<default>1000</default>
+</int>
+<int size='2'>
+<name>Analog off threshold</name>
+<description>Used for analog input only. Filtered ADC reading at or below which the off event is produced, this must be lower than the on threshold.</description>
+<min>0</min>
+<max>4095</max>
+<default>800</default>
+</int>
 </group>)xmlpayload"
 #if CONFIG_OLCB_ENABLE_PWM
-R"xmlpayload(<group replication='16'>
+#if CONFIG_OLCB_PWM_MAX_DEVICES == 1
+R"xmlpayload(<group replication='16'>)xmlpayload"
+#elif CONFIG_OLCB_PWM_MAX_DEVICES == 2
+R"xmlpayload(<group replication='32'>)xmlpayload"
+#elif CONFIG_OLCB_PWM_MAX_DEVICES == 3
+R"xmlpayload(<group replication='48'>)xmlpayload"
+#elif CONFIG_OLCB_PWM_MAX_DEVICES == 4
+R"xmlpayload(<group replication='64'>)xmlpayload"
+#else
+#error Unsupported CONFIG_OLCB_PWM_MAX_DEVICES value
+#endif // CONFIG_OLCB_PWM_MAX_DEVICES
+R"xmlpayload(
 <name>PWM</name>
 <repname>PWM</repname>
 <string size='16'>
@@ -298,9 +424,53 @@ R"xmlpayload(<group replication='16'>
 <max>200</max>
 <default>100</default>
 </int>
+<int size='2'>
+<name>Servo Velocity</name>
+<description>Maximum speed of the servo, as a percentage of the full servo range per second. A value of zero will move the servo immediately.</description>
+<min>0</min>
+<max>1000</max>
+<default>0</default>
+</int>
+<int size='2'>
+<name>Servo Acceleration</name>
+<description>Rate of change of the servo speed, as a percentage of the full servo range per second per second. A value of zero will start and stop the servo at full velocity.</description>
+<min>0</min>
+<max>1000</max>
+<default>0</default>
+</int>
 </group>)xmlpayload"
 #else
-R"xmlpayload(<group offset='576'/>)xmlpayload"
+R"xmlpayload(<group offset='640'/>)xmlpayload"
+#endif // CONFIG_OLCB_ENABLE_PWM
+R"xmlpayload(<group>
+<name>Input Output Pin Events</name>
+<int size='1'>
+<name>Event mode</name>
+<description>Individual uses the events configured for each entry. Range assigns two events to each entry starting from the base event, the first is the on event and the second is the off event. The bank is identified with a single event range message.</description>
+<default>0</default>
+<map><relation><property>0</property><value>Individual</value></relation><relation><property>1</property><value>Range</value></relation></map>
+</int>
+<eventid>
+<name>Base event</name>
+<description>Used for range mode only. First event of the range, this must be a multiple of the range size which is twice the number of entries rounded up to a power of two. A factory reset assigns an aligned base event from the node's own events.</description>
+</eventid>
+</group>)xmlpayload"
+#if CONFIG_OLCB_ENABLE_PWM
+R"xmlpayload(<group>
+<name>PWM Events</name>
+<int size='1'>
+<name>Event mode</name>
+<description>Individual uses the events configured for each entry. Range assigns two events to each entry starting from the base event, the first is the on event and the second is the off event. The bank is identified with a single event range message.</description>
+<default>0</default>
+<map><relation><property>0</property><value>Individual</value></relation><relation><property>1</property><value>Range</value></relation></map>
+</int>
+<eventid>
+<name>Base event</name>
+<description>Used for range mode only. First event of the range, this must be a multiple of the range size which is twice the number of entries rounded up to a power of two. A factory reset assigns an aligned base event from the node's own events.</description>
+</eventid>
+</group>)xmlpayload"
+#else
+R"xmlpayload(<group offset='9'/>)xmlpayload"
 #endif // CONFIG_OLCB_ENABLE_PWM
 R"xmlpayload(</segment>
 </cdi>)xmlpayload";
@@ -309,43 +479,97 @@ R"xmlpayload(</segment>
 
     extern const uint16_t CDI_EVENT_OFFSETS[] =
     {
-        378, 386,   // input 1
-        410, 418,   // input 2
-        442, 450,   // input 3
-        474, 482,   // input 4
+        379, 387,   // input 1
+        421, 429,   // input 2
+        463, 471,   // input 3
+        505, 513,   // input 4
+
+        553, 561,   // IO 1
+        607, 615,   // IO 2
+        661, 669,   // IO 3
+        715, 723,   // IO 4
+        769, 777,   // IO 5
+        823, 831,   // IO 6
+        877, 885,   // IO 7
+        931, 939,   // IO 8
+        985, 993,   // IO 9
+        1039, 1047, // IO 10
+        1093, 1101, // IO 11
+        1147, 1155, // IO 12
+        1201, 1209, // IO 13
+        1255, 1263, // IO 14
 
-        513, 521,   // IO 1
-        552, 560,   // IO 2
-        591, 599,   // IO 3
-        630, 638,   // IO 4
-        669, 677,   // IO 5
-        708, 716,   // IO 6
-        747, 755,   // IO 7
-        786, 794,   // IO 8
-        825, 833,   // IO 9
-        864, 872,   // IO 10
-        903, 911,   // IO 11
-        942, 950,   // IO 12
-        981, 989,   // IO 13
-        1020, 1028, // IO 14
+        1302, 1310, // SERVO 1
+        1342, 1350, // SERVO 2
+        1382, 1390, // SERVO 3
+        1422, 1430, // SERVO 4
+        1462, 1470, // SERVO 5
+        1502, 1510, // SERVO 6
+        1542, 1550, // SERVO 7
+        1582, 1590, // SERVO 8
+        1622, 1630, // SERVO 9
+        1662, 1670, // SERVO 10
+        1702, 1710, // SERVO 11
+        1742, 1750, // SERVO 12
+        1782, 1790, // SERVO 13
+        1822, 1830, // SERVO 14
+        1862, 1870, // SERVO 15
+        1902, 1910, // SERVO 16
+#if CONFIG_OLCB_PWM_MAX_DEVICES >= 2
+        1942, 1950, // SERVO 17
+        1982, 1990, // SERVO 18
+        2022, 2030, // SERVO 19
+        2062, 2070, // SERVO 20
+        2102, 2110, // SERVO 21
+        2142, 2150, // SERVO 22
+        2182, 2190, // SERVO 23
+        2222, 2230, // SERVO 24
+        2262, 2270, // SERVO 25
+        2302, 2310, // SERVO 26
+        2342, 2350, // SERVO 27
+        2382, 2390, // SERVO 28
+        2422, 2430, // SERVO 29
+        2462, 2470, // SERVO 30
+        2502, 2510, // SERVO 31
+        2542, 2550, // SERVO 32
+#endif // CONFIG_OLCB_PWM_MAX_DEVICES >= 2
+#if CONFIG_OLCB_PWM_MAX_DEVICES >= 3
+        2582, 2590, // SERVO 33
+        2622, 2630, // SERVO 34
+        2662, 2670, // SERVO 35
+        2702, 2710, // SERVO 36
+        2742, 2750, // SERVO 37
+        2782, 2790, // SERVO 38
+        2822, 2830, // SERVO 39
+        2862, 2870, // SERVO 40
+        2902, 2910, // SERVO 41
+        2942, 2950, // SERVO 42
+        2982, 2990, // SERVO 43
+        3022, 3030, // SERVO 44
+        3062, 3070, // SERVO 45
+        3102, 3110, // SERVO 46
+        3142, 3150, // SERVO 47
+        3182, 3190, // SERVO 48
+#endif // CONFIG_OLCB_PWM_MAX_DEVICES >= 3
+#if CONFIG_OLCB_PWM_MAX_DEVICES >= 4
+        3222, 3230, // SERVO 49
+        3262, 3270, // SERVO 50
+        3302, 3310, // SERVO 51
+        3342, 3350, // SERVO 52
+        3382, 3390, // SERVO 53
+        3422, 3430, // SERVO 54
+        3462, 3470, // SERVO 55
+        3502, 3510, // SERVO 56
+        3542, 3550, // SERVO 57
+        3582, 3590, // SERVO 58
+        3622, 3630, // SERVO 59
+        3662, 3670, // SERVO 60
+        3702, 3710, // SERVO 61
+        3742, 3750, // SERVO 62
+        3782, 3790, // SERVO 63
+        3822, 3830, // SERVO 64
+#endif // CONFIG_OLCB_PWM_MAX_DEVICES >= 4
 
-        1052, 1060, // SERVO 1
-        1088, 1096, // SERVO 2
-        1124, 1132, // SERVO 3
-        1160, 1168, // SERVO 4
-        1196, 1204, // SERVO 5
-        1232, 1240, // SERVO 6
-        1268, 1276, // SERVO 7
-        1304, 1312, // SERVO 8
-        1340, 1348, // SERVO 9
-        1376, 1384, // SERVO 10
-        1412, 1420, // SERVO 11
-        1448, 1456, // SERVO 12
-        1484, 1492, // SERVO 13
-        1520, 1528, // SERVO 14
-        1556, 1564, // SERVO 15
-        1592, 1600, // SERVO 16
-        
         0           // end marker
     };
 }  // namespace openlcb
@@ -0,0 +1,180 @@
+###############################################################################
+# Renders the CDI_DATA string from cdi.hxx into an XML file so it can be
+# compressed and embedded like the other web content.
+#
+# Only the constructs used by cdi.hxx are supported: raw string literals,
+# plain string literals, macros which are defined as CMake variables (the
+# SNIP_* values and CONFIG_* values from sdkconfig) and #if / #elif / #else /
+# #endif / #error directives testing CONFIG_* values. Anything else is a
+# build error so the served cdi.xml can not silently differ from the CDI
+# reported by the node.
+###############################################################################
+
+# Evaluates the expression of an #if or #elif directive.
+#
+# expr is the expression, one of CONFIG_X, !CONFIG_X or CONFIG_X <op> N with
+# <op> being ==, !=, >=, <=, > or <. Undefined values are treated as 0.
+function(cdi_eval_condition expr result)
+    string(STRIP "${expr}" expr)
+    if (NOT expr MATCHES "^(!?)(CONFIG_[A-Za-z0-9_]+)( *(==|!=|>=|<=|>|<) *([0-9]+))?$")
+        message(FATAL_ERROR "cdi.hxx: unsupported preprocessor expression: ${expr}")
+    endif()
+    set(negate "${CMAKE_MATCH_1}")
+    set(value "${${CMAKE_MATCH_2}}")
+    set(op "${CMAKE_MATCH_4}")
+    set(rhs "${CMAKE_MATCH_5}")
+    if (value STREQUAL "" OR value STREQUAL "n")
+        set(value 0)
+    elseif (value STREQUAL "y")
+        set(value 1)
+    endif()
+    if (op STREQUAL "")
+        set(op "!=")
+        set(rhs 0)
+    endif()
+    if (op STREQUAL "==")
+        set(cmp EQUAL)
+    elseif (op STREQUAL "!=")
+        set(cmp EQUAL)
+        if (negate)
+            set(negate "")
+        else()
+            set(negate "!")
+        endif()
+    elseif (op STREQUAL ">=")
+        set(cmp GREATER_EQUAL)
+    elseif (op STREQUAL "<=")
+        set(cmp LESS_EQUAL)
+    elseif (op STREQUAL ">")
+        set(cmp GREATER)
+    else()
+        set(cmp LESS)
+    endif()
+    if ("${value}" ${cmp} "${rhs}")
+        set(match TRUE)
+    else()
+        set(match FALSE)
+    endif()
+    if (negate)
+        if (match)
+            set(match FALSE)
+        else()
+            set(match TRUE)
+        endif()
+    endif()
+    set(${result} ${match} PARENT_SCOPE)
+endfunction()
+
+# Fails the build when the end of a string literal was not found.
+macro(cdi_check_terminated end)
+    if (${end} EQUAL -1)
+        message(FATAL_ERROR "cdi.hxx: unterminated string in CDI_DATA")
+    endif()
+endmacro()
+
+# Writes the XML of the CDI_DATA string declared in header to output.
+function(cdi_render_xml header output)
+    file(READ "${header}" source)
+    string(FIND "${source}" "CDI_DATA[] =" start)
+    string(FIND "${source}" "CDI_SIZE" end)
+    if (start EQUAL -1 OR end EQUAL -1)
+        message(FATAL_ERROR "cdi.hxx: unable to locate CDI_DATA")
+    endif()
+    math(EXPR start "${start} + 12")
+    math(EXPR length "${end} - ${start}")
+    string(SUBSTRING "${source}" ${start} ${length} source)
+
+    # Semicolons are list separators in CMake, protect them while the source
+    # is processed line by line.
+    string(REPLACE ";" "<CDI_SEMICOLON>" source "${source}")
+    string(REPLACE "\n" ";" lines "${source}")
+
+    # Drop the lines excluded by the preprocessor directives. Each nesting
+    # level tracks whether it is active and whether a branch was taken.
+    set(active TRUE)
+    set(stack "")
+    set(code "")
+    foreach (line IN LISTS lines)
+        string(STRIP "${line}" stripped)
+        if (stripped MATCHES "^#[ ]*if[ ]+(.*)$")
+            set(expr "${CMAKE_MATCH_1}")
+            list(APPEND stack "${active}:${taken}")
+            if (active)
+                cdi_eval_condition("${expr}" active)
+                set(taken ${active})
+            else()
+                set(taken TRUE)
+            endif()
+        elseif (stripped MATCHES "^#[ ]*elif[ ]+(.*)$")
+            set(expr "${CMAKE_MATCH_1}")
+            list(GET stack -1 parent)
+            if (parent MATCHES "^TRUE" AND NOT taken)
+                cdi_eval_condition("${expr}" active)
+                set(taken ${active})
+            else()
+                set(active FALSE)
+            endif()
+        elseif (stripped MATCHES "^#[ ]*else")
+            list(GET stack -1 parent)
+            if (parent MATCHES "^TRUE" AND NOT taken)
+                set(active TRUE)
+                set(taken TRUE)
+            else()
+                set(active FALSE)
+            endif()
+        elseif (stripped MATCHES "^#[ ]*endif")
+            list(GET stack -1 parent)
+            list(REMOVE_AT stack -1)
+            string(REPLACE ":" ";" parent "${parent}")
+            list(GET parent 0 active)
+            list(LENGTH parent parent_len)
+            set(taken "")
+            if (parent_len GREATER 1)
+                list(GET parent 1 taken)
+            endif()
+        elseif (stripped MATCHES "^#[ ]*error(.*)$")
+            if (active)
+                message(FATAL_ERROR "cdi.hxx: #error${CMAKE_MATCH_1}")
+            endif()
+        elseif (stripped MATCHES "^#")
+            message(FATAL_ERROR "cdi.hxx: unsupported preprocessor directive: ${stripped}")
+        elseif (active)
+            string(APPEND code "${line}\n")
+        endif()
+    endforeach()
+
+    # Concatenate the string literals and macro values.
+    set(xml "")
+    while (TRUE)
+        string(REGEX REPLACE "^[ \t\r\n]+" "" code "${code}")
+        if (code MATCHES "^<CDI_SEMICOLON>")
+            break()
+        elseif (code MATCHES "^R\"xmlpayload\\(")
+            string(SUBSTRING "${code}" 13 -1 code)
+            string(FIND "${code}" ")xmlpayload\"" end)
+            cdi_check_terminated(${end})
+            string(SUBSTRING "${code}" 0 ${end} literal)
+            math(EXPR end "${end} + 12")
+        elseif (code MATCHES "^\"")
+            string(SUBSTRING "${code}" 1 -1 code)
+            string(FIND "${code}" "\"" end)
+            cdi_check_terminated(${end})
+            string(SUBSTRING "${code}" 0 ${end} literal)
+            math(EXPR end "${end} + 1")
+        elseif (code MATCHES "^([A-Za-z_][A-Za-z0-9_]*)")
+            set(macro "${CMAKE_MATCH_1}")
+            if (NOT DEFINED ${macro})
+                message(FATAL_ERROR "cdi.hxx: unknown macro in CDI_DATA: ${macro}")
+            endif()
+            set(literal "${${macro}}")
+            string(LENGTH "${macro}" end)
+        else()
+            string(SUBSTRING "${code}" 0 40 context)
+            message(FATAL_ERROR "cdi.hxx: unable to parse CDI_DATA near: ${context}")
+        endif()
+        string(APPEND xml "${literal}")
+        string(SUBSTRING "${code}" ${end} -1 code)
+    endwhile()
+    string(REPLACE "<CDI_SEMICOLON>" ";" xml "${xml}")
+    file(WRITE "${output}" "${xml}")
+endfunction()
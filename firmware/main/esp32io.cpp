@@ -32,6 +32,10 @@
  * @date 4 July 2020
  */
 #include "sdkconfig.h"
+#include "boot_trace.hxx"
+#if CONFIG_OLCB_CONFIG_PARTITION
+#include "ConfigPartition.hxx"
+#endif // CONFIG_OLCB_CONFIG_PARTITION
 #include "fs.hxx"
 #include "hardware.hxx"
 #include "NodeRebootHelper.hxx"
@@ -156,6 +160,7 @@ void app_main()
 {
     // capture the reason for the CPU reset
     uint8_t reset_reason = Esp32SocInfo::print_soc_info();
+    boot_trace_init(reset_reason);
     const esp_app_desc_t *app_data = esp_app_get_description();
     LOG(INFO, "%s uses the OpenMRN library\n"
               "Copyright (c) 2019-2023, OpenMRN\n"
@@ -176,6 +181,7 @@ void app_main()
         default_config(&config);
         cleanup_config_tree = true;
     }
+    boot_trace_record(BootPhase::NVS);
     bool reset_events = false;
     bool run_bootloader = false;
     bool wifi_verbose = false;
@@ -283,6 +289,7 @@ void app_main()
     }
 
     dump_config(&config);
+    boot_trace_record(BootPhase::FACTORY_RESET);
 
     if (run_bootloader)
     {
@@ -290,7 +297,22 @@ void app_main()
     }
     else
     {
+#if CONFIG_OLCB_CONFIG_PARTITION
+        // The configuration partition is not part of the filesystem, it is
+        // cleared along with the filesystem content.
+        if (cleanup_config_tree)
+        {
+            esp32io::PartitionConfigStore::erase();
+        }
+#endif // CONFIG_OLCB_CONFIG_PARTITION
+#if CONFIG_BOOT_DEFER_FS_DUMP
+        // The filesystem content is listed after the OpenLCB stack has been
+        // started.
+        mount_fs(cleanup_config_tree, false);
+#else
         mount_fs(cleanup_config_tree);
+#endif // CONFIG_BOOT_DEFER_FS_DUMP
+        boot_trace_record(BootPhase::MOUNT_FS);
         esp32io::start_openlcb_stack(&config, reset_events,
                                      reset_reason == RTCWDT_BROWN_OUT_RESET,
                                      wifi_verbose);
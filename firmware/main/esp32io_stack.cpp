@@ -34,26 +34,48 @@
 
 #include "sdkconfig.h"
 #include "cdi.hxx"
+#include "ConfiguredEventRange.hxx"
 #include "DelayRebootHelper.hxx"
+#include "AnalogInputEngine.hxx"
+#include "BootStages.hxx"
+#if CONFIG_OLCB_CONFIG_CACHE
+#include "ConfigCache.hxx"
+#if CONFIG_OLCB_CONFIG_PARTITION
+#include "ConfigPartition.hxx"
+#endif // CONFIG_OLCB_CONFIG_PARTITION
+#endif // CONFIG_OLCB_CONFIG_CACHE
+#include "Esp32I2CBus.hxx"
+#include "EventIndex.hxx"
+#if CONFIG_OLCB_EVENT_INDEX_BENCHMARK
+#include "EventIndexBenchmark.hxx"
+#endif // CONFIG_OLCB_EVENT_INDEX_BENCHMARK
 #include "EventBroadcastHelper.hxx"
 #include "FactoryResetHelper.hxx"
 #include "fs.hxx"
 #include "hardware.hxx"
 #include "HealthMonitor.hxx"
+#include "I2CWorker.hxx"
+#include "IoPin.hxx"
+#if CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
+#include "InputBenchmark.hxx"
+#include "ParallelInputEngine.hxx"
+#else
+#include "IsrInputEngine.hxx"
+#endif // CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
 #include "NodeRebootHelper.hxx"
+#include "OutputBank.hxx"
 #include "nvs_config.hxx"
 #include "PCA9685PWM.hxx"
+#include "ServoMotion.hxx"
 #include "web_server.hxx"
 
 #include <CDIXMLGenerator.hxx>
 #include <freertos_drivers/esp32/Esp32HardwareTwai.hxx>
 #include <freertos_drivers/esp32/Esp32WiFiManager.hxx>
-#include <openlcb/MemoryConfigClient.hxx>
-#include <openlcb/RefreshLoop.hxx>
-#include <openlcb/ServoConsumer.hxx>
 #include <openlcb/SimpleStack.hxx>
 #include <utils/constants.hxx>
 #include <utils/format_utils.hxx>
+#include <utils/StringPrintf.hxx>
 #include <utils/Uninitialized.hxx>
 
 namespace esp32io
@@ -65,8 +87,14 @@ ConfigDef cfg(0);
 
 namespace openlcb
 {
+#if CONFIG_OLCB_CONFIG_CACHE
+    // Path to where OpenMRN should persist general configuration data, this
+    // is served from RAM by the ConfigCache and persisted to /fs/config.
+    const char *const CONFIG_FILENAME = "/cfg/config";
+#else
     // Path to where OpenMRN should persist general configuration data.
     const char *const CONFIG_FILENAME = "/fs/config";
+#endif // CONFIG_OLCB_CONFIG_CACHE
 
     // The size of the memory space to export over the above device.
     const size_t CONFIG_FILE_SIZE =
@@ -74,7 +102,7 @@ namespace openlcb
 
     // Default to store the dynamic SNIP data is stored in the same persistant
     // data file as general configuration data.
-    const char *const SNIP_DYNAMIC_FILENAME = "/fs/config";
+    const char *const SNIP_DYNAMIC_FILENAME = CONFIG_FILENAME;
 
     /// Defines the identification information for the node. The arguments are:
     ///
@@ -143,23 +171,81 @@ namespace esp32io
 int config_fd;
 uninitialized<openlcb::SimpleCanStack> stack;
 uninitialized<Esp32WiFiManager> wifi_manager;
-uninitialized<openlcb::MemoryConfigClient> memory_client;
 uninitialized<FactoryResetHelper> factory_reset_helper;
 uninitialized<EventBroadcastHelper> event_helper;
 uninitialized<DelayRebootHelper> delayed_reboot;
 uninitialized<HealthMonitor> health_mon;
 uninitialized<NodeRebootHelper> node_reboot_helper;
-uninitialized<openlcb::ConfiguredProducer> inputs[ARRAYSIZE(INPUT_ONLY_GPIO)];
-uninitialized<openlcb::MultiConfiguredPC> multi_pc;
-std::unique_ptr<openlcb::RefreshLoop> refresh_loop;
+
+/// Priority of the IO thread.
+static constexpr int IO_EXECUTOR_PRIORITY = 3;
+
+/// Stack size of the IO thread.
+static constexpr size_t IO_EXECUTOR_STACK_SIZE = 2048;
+
+uninitialized<Executor<1>> io_executor;
+uninitialized<Service> io_service;
+#if CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
+/// Mapping of GPIO pins to input numbers for the input engine.
+static constexpr GpioInputMap INPUT_GPIO_MAP(INPUT_GPIO_NUM);
+uninitialized<ParallelInputEngine> input_engine;
+#else
+uninitialized<IsrInputEngine> input_engine;
+#endif // CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
+uninitialized<EventIndex> event_index;
+uninitialized<InputDispatcher> input_dispatcher;
+uninitialized<AnalogInputEngine> analog_engine;
+uninitialized<InputDispatcher> analog_dispatcher;
+uninitialized<OutputBank> output_bank;
+uninitialized<ConfiguredInputPin> inputs[ARRAYSIZE(INPUT_ONLY_GPIO)];
+uninitialized<ConfiguredGpioPin> gpio_pins[ARRAYSIZE(CONFIGURABLE_GPIO)];
+uninitialized<ConfiguredEventRange> gpio_range;
+
+/// Offset of the default IO pin range base event within the node's event
+/// space, this is above the events assigned by a factory reset.
+static constexpr uint16_t GPIO_RANGE_DEFAULT_OFFSET = 0x8000;
+#if CONFIG_OLCB_CONFIG_CACHE
+/// Priority of the configuration flush thread.
+static constexpr int CONFIG_CACHE_PRIORITY = 1;
+
+/// Stack size of the configuration flush thread.
+static constexpr size_t CONFIG_CACHE_STACK_SIZE = 3072;
+
+/// File on the persistent filesystem holding the configuration.
+static constexpr char CONFIG_CACHE_BACKING_FILE[] = "/fs/config";
+
+uninitialized<FileConfigStore> config_file_store;
+#if CONFIG_OLCB_CONFIG_PARTITION
+uninitialized<PartitionConfigStore> config_partition_store;
+#endif // CONFIG_OLCB_CONFIG_PARTITION
+uninitialized<Executor<1>> config_cache_executor;
+uninitialized<Service> config_cache_service;
+uninitialized<ConfigCache> config_cache;
+#endif // CONFIG_OLCB_CONFIG_CACHE
 #if CONFIG_OLCB_ENABLE_TWAI
 Esp32HardwareTwai twai(CONFIG_TWAI_RX_PIN, CONFIG_TWAI_TX_PIN);
+TwaiTxQueueProbe twai_probe(&twai);
 #endif // CONFIG_OLCB_ENABLE_TWAI
 
 #if CONFIG_OLCB_ENABLE_PWM
-PCA9685PWM pca9685(CONFIG_SDA_PIN, CONFIG_SCL_PIN, PCA9685_ADDR, 1000);
-uninitialized<PCA9685PWMBit> pca9685PWM[16];
-uninitialized<openlcb::ServoConsumer> servos[16];
+/// Priority of the I2C worker thread.
+static constexpr int I2C_WORKER_PRIORITY = 3;
+
+/// Stack size of the I2C worker thread.
+static constexpr size_t I2C_WORKER_STACK_SIZE = 2048;
+
+Esp32I2CBus i2c_bus(I2C_NUM_0, CONFIG_SDA_PIN, CONFIG_SCL_PIN);
+uninitialized<Executor<1>> i2c_executor;
+uninitialized<Service> i2c_service;
+uninitialized<I2CWorker> i2c_worker;
+uninitialized<PCA9685PWM> pca9685;
+uninitialized<PCA9685PWMBit> pca9685PWM[PWM_CHANNEL_COUNT];
+uninitialized<ServoMotionEngine> servo_motion;
+uninitialized<ServoMotionConsumer> servos[PWM_CHANNEL_COUNT];
+uninitialized<ConfiguredEventRange> pwm_range;
+
+/// Offset of the default PWM range base event within the node's event space.
+static constexpr uint16_t PWM_RANGE_DEFAULT_OFFSET = 0xC000;
 #endif // CONFIG_OLCB_ENABLE_PWM
 
 void factory_reset_events()
@@ -167,9 +253,75 @@ void factory_reset_events()
     LOG(WARNING, "[CDI] Resetting event IDs");
     stack->factory_reset_all_events(cfg.seg().internal_config()
                                   , stack->node()->node_id(), config_fd);
+    // The range base events are not assigned sequentially, they must stay
+    // aligned to the range size.
+    gpio_range->reset_base_event(config_fd);
+#if CONFIG_OLCB_ENABLE_PWM
+    pwm_range->reset_base_event(config_fd);
+#endif // CONFIG_OLCB_ENABLE_PWM
     fsync(config_fd);
 }
 
+/// Appends the event statistics for a single pin to a JSON array.
+///
+/// @param json is the JSON array being built.
+/// @param name is the name of the pin.
+/// @param pin is the @ref IoPin to report.
+static void append_io_stats(string &json, const char *name, IoPin *pin)
+{
+    if (json.back() != '[')
+    {
+        json += ",";
+    }
+    json += StringPrintf(
+        R"!^!({"name":"%s","events":%" PRIu32 ","suppressed":%" PRIu32 "})!^!"
+      , name, pin->event_count(), pin->suppressed_count());
+}
+
+string io_stats()
+{
+    string pins = "[";
+    for (size_t idx = 0; idx < ARRAYSIZE(INPUT_ONLY_GPIO); idx++)
+    {
+        append_io_stats(pins, INPUT_ONLY_GPIO_NAMES[idx]
+                      , inputs[idx].get_mutable());
+    }
+    for (size_t idx = 0; idx < ARRAYSIZE(CONFIGURABLE_GPIO); idx++)
+    {
+        append_io_stats(pins, CONFIGURABLE_GPIO_NAMES[idx]
+                      , gpio_pins[idx].get_mutable());
+    }
+    pins += "]";
+    TxPacer *pacer = event_index->pacer();
+    return StringPrintf(
+        R"!^!({"res":"io-stats","transitions":%" PRIu32 ",)!^!"
+        R"!^!("events":%" PRIu32 ","suppressed":%" PRIu32 ",)!^!"
+        R"!^!("bulk":{"bursts":%" PRIu32 ","messages":%" PRIu32 ",)!^!"
+        R"!^!("pauses":%" PRIu32 ","last_usec":%" PRIu32 ",)!^!"
+        R"!^!("max_usec":%" PRIu32 "},"pins":%s})!^!"
+      , input_engine->transition_count() + analog_engine->transition_count()
+      , input_dispatcher->event_count() + analog_dispatcher->event_count()
+      , input_dispatcher->suppressed_count()
+      + analog_dispatcher->suppressed_count()
+      , pacer->bursts(), pacer->messages(), pacer->pauses()
+      , pacer->last_usec(), pacer->max_usec(), pins.c_str());
+}
+
+string config_stats()
+{
+#if CONFIG_OLCB_CONFIG_CACHE
+    return StringPrintf(
+        R"!^!({"res":"cfg-stats","cached":true,"writes":%" PRIu32 ",)!^!"
+        R"!^!("flushes":%" PRIu32 ","avoided":%" PRIu32 ",)!^!"
+        R"!^!("written_bytes":%" PRIu32 ","flushed_bytes":%" PRIu32 "})!^!"
+      , config_cache->writes(), config_cache->flushes()
+      , config_cache->writes_avoided(), config_cache->written_bytes()
+      , config_cache->flushed_bytes());
+#else
+    return R"!^!({"res":"cfg-stats","cached":false})!^!";
+#endif // CONFIG_OLCB_CONFIG_CACHE
+}
+
 void NodeRebootHelper::reboot()
 {
     // make sure we are not called from the executor thread otherwise there
@@ -180,6 +332,9 @@ void NodeRebootHelper::reboot()
     stack->executor()->sync_run([&]()
     {
         close(config_fd);
+#if CONFIG_OLCB_CONFIG_CACHE
+        config_cache->flush();
+#endif // CONFIG_OLCB_CONFIG_CACHE
         unmount_fs();
         // restart the node
         LOG(INFO, "[Reboot] Restarting!");
@@ -237,16 +392,18 @@ void FactoryResetHelper::factory_reset(int fd)
     auto config_io = cfg.seg().gpio();
     for (size_t idx = 0; idx < ARRAYSIZE(CONFIGURABLE_GPIO_NAMES); idx++)
     {
-        config_io.entry(idx).pc().description().write(fd, CONFIGURABLE_GPIO_NAMES[idx]);
+        config_io.entry(idx).description().write(fd, CONFIGURABLE_GPIO_NAMES[idx]);
     }
 
 #if !CONFIG_OLCB_ENABLE_PWM
     auto config_pwm = cfg.seg().pwm();
-    for (size_t idx = 0; idx < 16; idx++)
+    for (size_t idx = 0; idx < PWM_CHANNEL_COUNT; idx++)
     {
         config_pwm.entry(idx).description().write(fd, "");
         CDI_FACTORY_RESET(config_pwm.entry(idx).servo_min_percent);
         CDI_FACTORY_RESET(config_pwm.entry(idx).servo_max_percent);
+        CDI_FACTORY_RESET(config_pwm.entry(idx).velocity);
+        CDI_FACTORY_RESET(config_pwm.entry(idx).acceleration);
     }
 #endif // !CONFIG_OLCB_ENABLE_PWM
 }
@@ -283,6 +440,24 @@ void FactoryResetHelper::factory_reset(int fd)
 #define CONFIG_TIMEZONE "UTC0"
 #endif
 
+#ifndef CONFIG_BOOT_CONCURRENT_INIT
+#define CONFIG_BOOT_CONCURRENT_INIT 0
+#endif
+
+/// Startup stages which run alongside the IO pin and TWAI initialization.
+uninitialized<BootStageGroup> boot_concurrent;
+
+#if CONFIG_OLCB_ENABLE_PWM
+/// PCA9685 probe, this runs alongside the IO pin and TWAI initialization and
+/// is only joined once the OpenLCB executor has been started.
+uninitialized<BootStageGroup> boot_pwm;
+#endif // CONFIG_OLCB_ENABLE_PWM
+
+#if CONFIG_BOOT_DEFER_FS_DUMP
+/// Startup stages which run after the OpenLCB stack has been started.
+uninitialized<BootStageGroup> boot_deferred;
+#endif // CONFIG_BOOT_DEFER_FS_DUMP
+
 void start_openlcb_stack(node_config_t *config, bool reset_events
                        , bool brownout_detected, bool wifi_verbose)
 {
@@ -292,45 +467,146 @@ void start_openlcb_stack(node_config_t *config, bool reset_events
       , openlcb::SNIP_STATIC_DATA.model_name
       , openlcb::SNIP_STATIC_DATA.hardware_version
       , openlcb::SNIP_STATIC_DATA.software_version);
+    BootStageTimer boot_timer("stack");
     stack.emplace(config->node_id);
     stack->set_tx_activity_led(LED_ACTIVITY_Pin::instance());
 #if CONFIG_OLCB_PRINT_ALL_PACKETS
     stack->print_all_packets();
 #endif
 
-    memory_client.emplace(stack->node(), stack->memory_config_handler());
-    wifi_manager.emplace(
-        CONFIG_WIFI_STATION_SSID, CONFIG_WIFI_STATION_PASSWORD,
-        stack.operator->(), cfg.seg().wifi(), (wifi_mode_t)CONFIG_WIFI_MODE,
-        (Esp32WiFiManager::ConnectionMode)CONFIG_OLCB_WIFI_MODE, /* uplink / hub mode */
-        CONFIG_WIFI_HOSTNAME_PREFIX, CONFIG_SNTP_SERVER, CONFIG_TIMEZONE, false,
-        CONFIG_WIFI_SOFTAP_CHANNEL, WIFI_AUTH_OPEN,
-        CONFIG_WIFI_SOFTAP_SSID, CONFIG_WIFI_SOFTAP_PASSWORD);
-    wifi_manager->set_status_led(LED_WIFI_Pin::instance());
-    if (wifi_verbose)
+    boot_timer.done(BootPhase::STACK);
+
+    // WiFi and the web server are not needed for the IO pins to produce and
+    // consume events, they are started on the second core while the IO pins
+    // and TWAI are initialized. These must complete before the configuration
+    // is loaded as they register configuration listeners.
+    boot_concurrent.emplace("boot-init", CONFIG_BOOT_CONCURRENT_INIT);
+    boot_concurrent->add(BootPhase::WIFI, [wifi_verbose]()
     {
-        wifi_manager->enable_verbose_logging();
-    }
-    init_webserver(memory_client.operator->(), wifi_manager.operator->(),
-                   config->node_id);
+        wifi_manager.emplace(
+            CONFIG_WIFI_STATION_SSID, CONFIG_WIFI_STATION_PASSWORD,
+            stack.operator->(), cfg.seg().wifi(), (wifi_mode_t)CONFIG_WIFI_MODE,
+            (Esp32WiFiManager::ConnectionMode)CONFIG_OLCB_WIFI_MODE, /* uplink / hub mode */
+            CONFIG_WIFI_HOSTNAME_PREFIX, CONFIG_SNTP_SERVER, CONFIG_TIMEZONE,
+            false, CONFIG_WIFI_SOFTAP_CHANNEL, WIFI_AUTH_OPEN,
+            CONFIG_WIFI_SOFTAP_SSID, CONFIG_WIFI_SOFTAP_PASSWORD);
+        wifi_manager->set_status_led(LED_WIFI_Pin::instance());
+        if (wifi_verbose)
+        {
+            wifi_manager->enable_verbose_logging();
+        }
+    });
+    boot_concurrent->add(BootPhase::WEBSERVER, [config]()
+    {
+        init_webserver(stack.operator->(), wifi_manager.operator->(),
+                       config->node_id);
+    });
+    boot_concurrent->start();
+
+#if CONFIG_OLCB_ENABLE_PWM
+    // All I2C traffic after initialization is handled by a dedicated thread
+    // so that a stuck or NACKing device can not stall the OpenLCB executor.
+    i2c_executor.emplace("i2c", I2C_WORKER_PRIORITY, I2C_WORKER_STACK_SIZE);
+    i2c_service.emplace(i2c_executor.get_mutable());
+    i2c_worker.emplace(i2c_service.get_mutable(), &i2c_bus);
+    pca9685.emplace(stack->service(), i2c_worker.get_mutable(), 1000,
+                    CONFIG_OLCB_PWM_MAX_DEVICES, CONFIG_OLCB_PWM_I2C_SPEED);
+    // The servo outputs only consume events, the bus scan does not hold up
+    // the IO pins. The outputs of the discovered devices are registered once
+    // the OpenLCB executor is running.
+    boot_pwm.emplace("boot-pwm", CONFIG_BOOT_CONCURRENT_INIT);
+    boot_pwm->add(BootPhase::PWM, []()
+    {
+        LOG(INFO, "Initializing PCA9685");
+        if (i2c_bus.hw_init() == ESP_OK)
+        {
+            pca9685->hw_init();
+        }
+    });
+    boot_pwm->start();
+#endif // CONFIG_OLCB_ENABLE_PWM
+
     factory_reset_helper.emplace();
     event_helper.emplace();
     delayed_reboot.emplace(stack->service());
     health_mon.emplace(stack->service());
     node_reboot_helper.emplace();
 
+    // Inputs are sampled and debounced on a dedicated thread, the OpenLCB
+    // executor is only woken up when a debounced transition is ready to be
+    // produced.
+    io_executor.emplace("io", IO_EXECUTOR_PRIORITY, IO_EXECUTOR_STACK_SIZE);
+    io_service.emplace(io_executor.get_mutable());
+#if CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
+#if CONFIG_IOPIN_INPUT_BENCHMARK
+    {
+        const Gpio *bench_pins[ARRAYSIZE(INPUT_GPIO_NUM)];
+        std::copy(std::begin(INPUT_ONLY_GPIO), std::end(INPUT_ONLY_GPIO)
+                , bench_pins);
+        std::copy(std::begin(CONFIGURABLE_GPIO), std::end(CONFIGURABLE_GPIO)
+                , bench_pins + CONFIGURABLE_GPIO_INPUT_OFFSET);
+        benchmark_inputs(bench_pins, INPUT_GPIO_MAP);
+    }
+#endif // CONFIG_IOPIN_INPUT_BENCHMARK
+    input_engine.emplace(io_service.get_mutable(), INPUT_GPIO_MAP
+                       , CONFIG_IOPIN_INPUT_POLL_INTERVAL);
+#else
+    input_engine.emplace(io_service.get_mutable(), INPUT_GPIO_NUM
+                       , ARRAYSIZE(INPUT_GPIO_NUM));
+#endif // CONFIG_IOPIN_INPUT_ENGINE_PARALLEL
+#if CONFIG_OLCB_EVENT_INDEX_BENCHMARK
+    benchmark_event_index(stack->node());
+#endif // CONFIG_OLCB_EVENT_INDEX_BENCHMARK
+    // All IO and servo events are handled by a single event handler.
+    event_index.emplace(stack->node());
+#if CONFIG_OLCB_ENABLE_TWAI
+    // Identify replies (including those sent at startup) are paced based on
+    // how full the TWAI TX queue is.
+    event_index->pacer()->add_probe(&twai_probe);
+#endif // CONFIG_OLCB_ENABLE_TWAI
+    input_dispatcher.emplace(stack->node(), input_engine.get_mutable());
+    // Analog inputs are sampled by the ADC via DMA, conversion frames are
+    // filtered on the IO thread and threshold crossings are delivered by a
+    // second dispatcher.
+    analog_engine.emplace(io_service.get_mutable(), INPUT_ADC1_CHANNEL
+                        , ARRAYSIZE(INPUT_ADC1_CHANNEL));
+    analog_dispatcher.emplace(stack->node(), analog_engine.get_mutable());
+    output_bank.emplace(stack->service(), INPUT_GPIO_NUM
+                      , ARRAYSIZE(INPUT_GPIO_NUM));
     for (size_t idx = 0; idx < ARRAYSIZE(INPUT_ONLY_GPIO); idx++)
     {
         inputs[idx].emplace(stack->node(), cfg.seg().gpi().entry(idx)
-                          , INPUT_ONLY_GPIO[idx]);
+                          , INPUT_ONLY_GPIO[idx], input_engine.get_mutable()
+                          , idx, nullptr, INPUT_GPIO_NUM[idx]
+                          , analog_engine.get_mutable());
+        input_dispatcher->register_pin(idx, inputs[idx].get_mutable());
+        analog_dispatcher->register_pin(idx, inputs[idx].get_mutable());
+        event_index->register_target(inputs[idx].get_mutable());
     }
-    multi_pc.emplace(stack->node(), CONFIGURABLE_GPIO
-                   , ARRAYSIZE(CONFIGURABLE_GPIO), cfg.seg().gpio());
-    refresh_loop.reset(
-        new openlcb::RefreshLoop(stack->node()
-                               , { inputs[0]->polling(), inputs[1]->polling()
-                                 , inputs[2]->polling(), inputs[3]->polling()
-                                 , multi_pc->polling() }));
+    // The IO pins can optionally use a single event range rather than
+    // individually configured events.
+    gpio_range.emplace(stack->node(), cfg.seg().gpio_range()
+                     , ARRAYSIZE(CONFIGURABLE_GPIO), GPIO_RANGE_DEFAULT_OFFSET);
+    event_index->register_range(gpio_range.get_mutable());
+    for (size_t idx = 0; idx < ARRAYSIZE(CONFIGURABLE_GPIO); idx++)
+    {
+        size_t input = CONFIGURABLE_GPIO_INPUT_OFFSET + idx;
+        gpio_pins[idx].emplace(stack->node(), cfg.seg().gpio().entry(idx)
+                             , CONFIGURABLE_GPIO[idx]
+                             , input_engine.get_mutable(), input
+                             , output_bank.get_mutable()
+                             , INPUT_GPIO_NUM[input]
+                             , analog_engine.get_mutable());
+        input_dispatcher->register_pin(input, gpio_pins[idx].get_mutable());
+        analog_dispatcher->register_pin(input, gpio_pins[idx].get_mutable());
+        event_index->register_target(gpio_pins[idx].get_mutable());
+        gpio_range->add_target(gpio_pins[idx].get_mutable(), idx);
+    }
+    input_engine->hw_init();
+    input_dispatcher->start();
+    analog_engine->hw_init();
+    analog_dispatcher->start();
+    boot_timer.done(BootPhase::IO);
 
 #if CONFIG_OLCB_ENABLE_TWAI
     // Initialize the TWAI driver.
@@ -338,22 +614,59 @@ void start_openlcb_stack(node_config_t *config, bool reset_events
 
     // Add the TWAI port to the stack.
     stack->add_can_port_select("/dev/twai/twai0");
+    boot_timer.done(BootPhase::TWAI);
 #endif // CONFIG_OLCB_ENABLE_TWAI
 
+    boot_concurrent->join();
+    boot_timer.done(BootPhase::INIT_JOIN);
+
 
 #if CONFIG_OLCB_ENABLE_PWM
-    LOG(INFO, "Initializing PCA9685");
-    pca9685.hw_init();
-    for (size_t idx = 0; idx < PCA9685PWM::NUM_CHANNELS; idx++)
+    servo_motion.emplace(stack->service());
+    // The range covers all servo outputs declared in the CDI so that the
+    // event assignment does not depend on the number of devices found.
+    pwm_range.emplace(stack->node(), cfg.seg().pwm_range(), PWM_CHANNEL_COUNT
+                    , PWM_RANGE_DEFAULT_OFFSET);
+    event_index->register_range(pwm_range.get_mutable());
+    // All servo outputs declared in the CDI take part in the configuration
+    // load and factory reset, the PWM output is attached once the devices
+    // have been discovered. Outputs without a device are left unused.
+    for (size_t idx = 0; idx < PWM_CHANNEL_COUNT; idx++)
     {
-        pca9685PWM[idx].emplace(&pca9685, idx);
-        servos[idx].emplace(stack->node(), cfg.seg().pwm().entry(idx),
+        servos[idx].emplace(cfg.seg().pwm().entry(idx),
                             CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000ULL,
-                            pca9685PWM[idx].get_mutable());
+                            nullptr, servo_motion.get_mutable());
     }
-#else
 #endif // CONFIG_OLCB_ENABLE_PWM
 
+#if CONFIG_OLCB_CONFIG_CACHE
+    // All configuration reads and writes are served from a RAM image, the
+    // flash is only written when the image has changed and is flushed on a
+    // dedicated thread so that a flash erase does not stall the executor.
+    config_file_store.emplace(CONFIG_CACHE_BACKING_FILE);
+    ConfigStore *config_store = config_file_store.get_mutable();
+#if CONFIG_OLCB_CONFIG_PARTITION
+    // Reads of an unmodified configuration are served directly from the
+    // memory-mapped partition, the configuration file is carried over the
+    // first time the partition is used.
+    config_partition_store.emplace();
+    if (config_partition_store->valid())
+    {
+        if (!config_partition_store->exists() && config_file_store->exists())
+        {
+            config_partition_store->import_from(config_store);
+        }
+        config_store = config_partition_store.get_mutable();
+    }
+#endif // CONFIG_OLCB_CONFIG_PARTITION
+    config_cache_executor.emplace("cfg", CONFIG_CACHE_PRIORITY,
+                                  CONFIG_CACHE_STACK_SIZE);
+    config_cache_service.emplace(config_cache_executor.get_mutable());
+    config_cache.emplace(config_cache_service.get_mutable(), "/cfg", "config",
+                         config_store, openlcb::CONFIG_FILE_SIZE,
+                         CONFIG_OLCB_CONFIG_CACHE_IDLE_MSEC);
+#endif // CONFIG_OLCB_CONFIG_CACHE
+
     // Check for presence of configuration file, if it exists check the version
     // and force factory reset if required. If it does not exist create it and
     // initialize the configuration values to defaults.
@@ -371,6 +684,7 @@ void start_openlcb_stack(node_config_t *config, bool reset_events
                                                 CDI_VERSION,
                                                 openlcb::CONFIG_FILE_SIZE);
     }
+    boot_timer.done(BootPhase::CONFIG);
 
     if (reset_events)
     {
@@ -386,6 +700,33 @@ void start_openlcb_stack(node_config_t *config, bool reset_events
 
     // Start the stack in the background using it's own task.
     stack->loop_executor();
+    boot_timer.done(BootPhase::EXECUTOR);
+
+#if CONFIG_OLCB_ENABLE_PWM
+    boot_pwm->join();
+    // The event index is used by the executor, the outputs of the discovered
+    // devices are registered on it. If the node has already been initialized
+    // the new consumers are announced.
+    stack->executor()->sync_run([]()
+    {
+        for (size_t idx = 0; idx < pca9685->num_channels(); idx++)
+        {
+            pca9685PWM[idx].emplace(pca9685.get_mutable(), idx);
+            servos[idx]->set_output(pca9685PWM[idx].get_mutable());
+            event_index->register_target(servos[idx].get_mutable());
+            pwm_range->add_target(servos[idx].get_mutable(), idx);
+        }
+        event_index->identify_all();
+    });
+    boot_timer.done(BootPhase::PWM_JOIN);
+#endif // CONFIG_OLCB_ENABLE_PWM
+    boot_trace_dump();
+
+#if CONFIG_BOOT_DEFER_FS_DUMP
+    boot_deferred.emplace("boot-deferred", true);
+    boot_deferred->add(BootPhase::FS_DUMP, dump_fs);
+    boot_deferred->start();
+#endif // CONFIG_BOOT_DEFER_FS_DUMP
 }
 
 } // namespace esp32io
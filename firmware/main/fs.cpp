@@ -32,14 +32,24 @@
  * @date 4 July 2020
  */
 
+#include "sdkconfig.h"
 #include "fs.hxx"
+#include "FsBackend.hxx"
+#if CONFIG_FS_BENCHMARK
+#include "FsBenchmark.hxx"
+#endif // CONFIG_FS_BENCHMARK
 extern "C"
 {
     #include <dirent.h>
 }
+#include <esp_littlefs.h>
 #include <esp_spiffs.h>
 #include <esp_vfs.h>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
 #include <utils/logging.h>
+#include <utils/macros.h>
 
 /// Partition name for the persistent filesystem.
 static constexpr char FS_PARTITION[] = "fs";
@@ -47,6 +57,165 @@ static constexpr char FS_PARTITION[] = "fs";
 /// Mount point for the persistent filesystem.
 static constexpr char FS_MOUNTPOINT[] = "/fs";
 
+/// Configuration file which is carried over when the filesystem type of the
+/// partition is changed.
+static constexpr char FS_CONFIG_FILE[] = "/fs/config";
+
+/// @ref FsBackend for SPIFFS.
+class SpiffsBackend : public FsBackend
+{
+public:
+    const char *name() override
+    {
+        return "SPIFFS";
+    }
+
+    bool mount(bool format) override
+    {
+        esp_vfs_spiffs_conf_t conf =
+        {
+          .base_path = FS_MOUNTPOINT,
+          .partition_label = FS_PARTITION,
+          .max_files = 10,
+          .format_if_mount_failed = format
+        };
+        return esp_vfs_spiffs_register(&conf) == ESP_OK;
+    }
+
+    void unmount() override
+    {
+        ESP_ERROR_CHECK(esp_vfs_spiffs_unregister(FS_PARTITION));
+    }
+
+    bool usage(size_t *total, size_t *used) override
+    {
+        return esp_spiffs_info(FS_PARTITION, total, used) == ESP_OK;
+    }
+};
+
+/// @ref FsBackend for LittleFS.
+class LittleFsBackend : public FsBackend
+{
+public:
+    const char *name() override
+    {
+        return "LittleFS";
+    }
+
+    bool mount(bool format) override
+    {
+        esp_vfs_littlefs_conf_t conf = {};
+        conf.base_path = FS_MOUNTPOINT;
+        conf.partition_label = FS_PARTITION;
+        conf.format_if_mount_failed = format;
+        return esp_vfs_littlefs_register(&conf) == ESP_OK;
+    }
+
+    void unmount() override
+    {
+        ESP_ERROR_CHECK(esp_vfs_littlefs_unregister(FS_PARTITION));
+    }
+
+    bool usage(size_t *total, size_t *used) override
+    {
+        return esp_littlefs_info(FS_PARTITION, total, used) == ESP_OK;
+    }
+};
+
+static SpiffsBackend spiffs_backend;
+static LittleFsBackend littlefs_backend;
+
+#if CONFIG_FS_BACKEND_LITTLEFS
+/// Filesystem used for the partition.
+static FsBackend *const fs_backend = &littlefs_backend;
+
+/// Filesystem the partition may contain from an earlier firmware.
+static FsBackend *const fs_legacy_backend = &spiffs_backend;
+#else
+/// Filesystem used for the partition.
+static FsBackend *const fs_backend = &spiffs_backend;
+
+/// Filesystem the partition may contain from an earlier firmware.
+static FsBackend *const fs_legacy_backend = &littlefs_backend;
+#endif // CONFIG_FS_BACKEND_LITTLEFS
+
+/// Reads a file into memory.
+///
+/// @param path is the file to read.
+/// @param data will receive the content of the file.
+/// @return true if the file was read.
+static bool read_file(const char *path, std::string *data)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    char buf[128];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0)
+    {
+        data->append(buf, len);
+    }
+    close(fd);
+    return len == 0;
+}
+
+/// Writes a file from memory.
+///
+/// @param path is the file to write.
+/// @param data is the content of the file.
+/// @return true if the file was written.
+static bool write_file(const char *path, const std::string &data)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        return false;
+    }
+    ssize_t len = write(fd, data.data(), data.size());
+    close(fd);
+    return len == (ssize_t)data.size();
+}
+
+/// Mounts the partition using @ref fs_backend, when the partition does not
+/// contain a valid filesystem of this type it is formatted. If the partition
+/// contains a filesystem of the @ref fs_legacy_backend type the configuration
+/// file is carried over to the new filesystem.
+static void mount_backend()
+{
+    if (fs_backend->mount(false))
+    {
+        return;
+    }
+    std::string config;
+    bool migrate = false;
+    LOG(WARNING, "[FS] Partition %s does not contain %s, checking for %s...",
+        FS_PARTITION, fs_backend->name(), fs_legacy_backend->name());
+    if (fs_legacy_backend->mount(false))
+    {
+        migrate = read_file(FS_CONFIG_FILE, &config);
+        fs_legacy_backend->unmount();
+    }
+    LOG(WARNING, "[FS] Formatting partition %s as %s", FS_PARTITION,
+        fs_backend->name());
+    bool mounted = fs_backend->mount(true);
+    HASSERT(mounted);
+    if (migrate)
+    {
+        if (write_file(FS_CONFIG_FILE, config))
+        {
+            LOG(INFO, "[FS] Migrated %s (%zu bytes) from %s", FS_CONFIG_FILE,
+                config.size(), fs_legacy_backend->name());
+        }
+        else
+        {
+            LOG_ERROR("[FS] Failed to migrate %s from %s", FS_CONFIG_FILE,
+                      fs_legacy_backend->name());
+        }
+    }
+}
+
 void recursive_dump_tree(const std::string &path, bool remove = false, bool first = true)
 {
     if (first && !remove)
@@ -95,30 +264,32 @@ void recursive_dump_tree(const std::string &path, bool remove = false, bool firs
     }
 }
 
-void mount_fs(bool cleanup)
+void mount_fs(bool cleanup, bool dump)
 {
-    size_t total_len = 0, free_len = 0;
-    esp_vfs_spiffs_conf_t conf =
-    {
-      .base_path = FS_MOUNTPOINT,
-      .partition_label = FS_PARTITION,
-      .max_files = 10,
-      .format_if_mount_failed = true
-    };
-    LOG(INFO, "[FS] Mounting SPIFFS: %s...", FS_PARTITION);
-    // Attempt to mount the partition
-    ESP_ERROR_CHECK(esp_vfs_spiffs_register(&conf));
+    size_t total_len = 0, used = 0;
+    LOG(INFO, "[FS] Mounting %s: %s...", fs_backend->name(), FS_PARTITION);
+    mount_backend();
+#if CONFIG_FS_BENCHMARK
+    benchmark_fs(fs_backend, FS_MOUNTPOINT);
+#endif // CONFIG_FS_BENCHMARK
     // check that the partition mounted
-    size_t used = 0;
-    ESP_ERROR_CHECK(esp_spiffs_info(FS_PARTITION, &total_len, &used));
-    free_len = total_len - used;
-    LOG(INFO, "[FS] %.2f/%.2f kb space used", (float)(free_len / 1024.0f)
+    bool have_usage = fs_backend->usage(&total_len, &used);
+    HASSERT(have_usage);
+    LOG(INFO, "[FS] %.2f/%.2f kb space used", (float)(used / 1024.0f)
       , (float)(total_len / 1024.0f));
-    recursive_dump_tree(FS_MOUNTPOINT, cleanup);
+    if (cleanup || dump)
+    {
+        recursive_dump_tree(FS_MOUNTPOINT, cleanup);
+    }
+}
+
+void dump_fs()
+{
+    recursive_dump_tree(FS_MOUNTPOINT);
 }
 
 void unmount_fs()
 {
-    LOG(INFO, "[FS] Unmounting SPIFFS: %s...", FS_PARTITION);
-    ESP_ERROR_CHECK(esp_vfs_spiffs_unregister(FS_PARTITION));
+    LOG(INFO, "[FS] Unmounting %s: %s...", fs_backend->name(), FS_PARTITION);
+    fs_backend->unmount();
 }
\ No newline at end of file
@@ -37,7 +37,12 @@
 
 /// Mounts the persistent filesystem.
 /// @param cleanup will remove all files from the filesystem during startup.
-void mount_fs(bool cleanup = false);
+/// @param dump will list the content of the filesystem, when false
+/// @ref dump_fs can be used to list the content later.
+void mount_fs(bool cleanup = false, bool dump = true);
+
+/// Lists the content of the persistent filesystem.
+void dump_fs();
 
 /// Unmounts the persistent filesystem.
 void unmount_fs();
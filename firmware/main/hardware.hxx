@@ -39,6 +39,7 @@
 #include <freertos_drivers/esp32/Esp32Gpio.hxx>
 #include <os/Gpio.hxx>
 #include <utils/GpioInitializer.hxx>
+#include <utils/macros.h>
 
 #include "sdkconfig.h"
 
@@ -161,6 +162,47 @@ constexpr const char *const INPUT_ONLY_GPIO_NAMES[] =
   "Factory Reset Button", "User Button", "Input 9", "Input 10"
 };
 
+/// GPIO numbers of all pins which can be used as inputs, the index into this
+/// array is the input number used by the input engine. The input only pins
+/// are first (same order as @ref INPUT_ONLY_GPIO) followed by the
+/// configurable pins (same order as @ref CONFIGURABLE_GPIO).
+constexpr gpio_num_t INPUT_GPIO_NUM[] =
+{
+    FACTORY_RESET_Pin::PIN_NUM, USER_BUTTON_Pin::PIN_NUM,
+    IO9_Pin::PIN_NUM,           IO10_Pin::PIN_NUM,
+    IO1_Pin::PIN_NUM,  IO2_Pin::PIN_NUM,  IO3_Pin::PIN_NUM,
+    IO4_Pin::PIN_NUM,  IO5_Pin::PIN_NUM,  IO6_Pin::PIN_NUM,
+    IO7_Pin::PIN_NUM,  IO8_Pin::PIN_NUM,
+    IO11_Pin::PIN_NUM, IO12_Pin::PIN_NUM, IO13_Pin::PIN_NUM,
+    IO14_Pin::PIN_NUM, IO15_Pin::PIN_NUM, IO16_Pin::PIN_NUM
+};
+
+/// ADC1 channels of the pins in @ref INPUT_GPIO_NUM which support the analog
+/// input mode, -1 for pins which do not. The buttons are excluded even though
+/// they are connected to ADC1 channels. ADC2 can not be used while WiFi is
+/// active.
+constexpr int8_t INPUT_ADC1_CHANNEL[] =
+{
+    -1, -1,
+    6,  7,  // IO9, IO10
+    -1, -1, -1,
+    -1, -1, -1,
+    -1, -1,
+    4,  5,  // IO11, IO12
+    -1, -1, -1, -1
+};
+
+/// Input number of the first configurable pin in @ref INPUT_GPIO_NUM.
+static constexpr size_t CONFIGURABLE_GPIO_INPUT_OFFSET =
+    ARRAYSIZE(INPUT_ONLY_GPIO);
+
+static_assert(ARRAYSIZE(INPUT_GPIO_NUM) ==
+              ARRAYSIZE(INPUT_ONLY_GPIO) + ARRAYSIZE(CONFIGURABLE_GPIO),
+              "INPUT_GPIO_NUM does not match the GPIO pin arrays");
+
+static_assert(ARRAYSIZE(INPUT_ADC1_CHANNEL) == ARRAYSIZE(INPUT_GPIO_NUM),
+              "INPUT_ADC1_CHANNEL does not match INPUT_GPIO_NUM");
+
 /// GPIO Pin connected to the TWAI (CAN) Transceiver RX pin.
 // ADC2_CHANNEL_0
 static constexpr gpio_num_t CONFIG_TWAI_RX_PIN = GPIO_NUM_4;
@@ -174,7 +216,4 @@ static constexpr gpio_num_t CONFIG_SDA_PIN = GPIO_NUM_19;
 /// GPIO Pin used for I2C SCL.
 static constexpr gpio_num_t CONFIG_SCL_PIN = GPIO_NUM_21;
 
-/// Default address for the PCA9685 PWM IC (all address pins to GND).
-static constexpr uint8_t PCA9685_ADDR = 0x40;
-
 #endif // HARDWARE_HXX_
@@ -33,10 +33,16 @@
  */
 
 #include "sdkconfig.h"
-#include "CDIClient.hxx"
+#include "boot_trace.hxx"
+#include "CDIScheduler.hxx"
+#include "ConfigBackup.hxx"
 #include "DelayRebootHelper.hxx"
 #include "EventBroadcastHelper.hxx"
 #include "nvs_config.hxx"
+#include "WsProtocol.hxx"
+#if CONFIG_WS_BENCHMARK
+#include "WsBenchmark.hxx"
+#endif // CONFIG_WS_BENCHMARK
 
 #include <cJSON.h>
 #include <esp_log.h>
@@ -45,7 +51,9 @@
 #include <freertos_drivers/esp32/Esp32WiFiManager.hxx>
 #include <Httpd.h>
 #include <HttpStringUtils.h>
-#include <openlcb/MemoryConfigClient.hxx>
+#include <memory>
+#include <new>
+#include <openlcb/SimpleStack.hxx>
 #include <os/MDNS.hxx>
 #include <utils/constants.hxx>
 #include <utils/FdUtils.hxx>
@@ -53,16 +61,15 @@
 #include <utils/logging.h>
 
 static std::unique_ptr<http::Httpd> http_server;
-static std::unique_ptr<CDIClient> cdi_client;
-static openlcb::MemoryConfigClient *memory_client;
+static std::unique_ptr<CDIScheduler> cdi_client;
 static MDNS mdns;
 static uint64_t node_id;
 static openlcb::NodeHandle node_handle;
 
 namespace openlcb
 {
-    extern const char CDI_DATA[];
-    extern const size_t CDI_SIZE;
+    extern const char *const CONFIG_FILENAME;
+    extern const size_t CONFIG_FILE_SIZE;
 }
 
 /// Statically embedded index.html start location.
@@ -89,6 +96,104 @@ extern const uint8_t spectreMinCssGz[] asm("_binary_spectre_min_css_gz_start");
 /// Statically embedded spectre.min.css size.
 extern const size_t spectreMinCssGz_size asm("spectre_min_css_gz_length");
 
+/// Statically embedded cdi.xml start location.
+extern const uint8_t cdiXmlGz[] asm("_binary_cdi_xml_gz_start");
+
+/// Statically embedded cdi.xml size.
+extern const size_t cdiXmlGz_size asm("cdi_xml_gz_length");
+
+/// ETag of the embedded web content, derived from the firmware build so it
+/// changes with every OTA update.
+static string static_etag;
+
+/// Embedded web content response which the browser may cache but must
+/// revalidate with the ETag on each use.
+class CachedStaticResponse : public http::StaticResponse
+{
+public:
+    /// Constructor.
+    ///
+    /// @param payload is the gzip compressed content.
+    /// @param size is the size of @p payload.
+    /// @param mime_type is the mime type of the content.
+    CachedStaticResponse(const uint8_t *payload, size_t size,
+                         const string &mime_type)
+        : http::StaticResponse(payload, size, mime_type,
+                               http::HTTP_ENCODING_GZIP)
+    {
+        header("ETag", static_etag);
+        header("Cache-Control", "no-cache");
+    }
+};
+
+/// Empty 304 response for embedded web content, this carries the same
+/// caching headers as @ref CachedStaticResponse so the browser keeps
+/// revalidating its cached copy.
+class NotModifiedResponse : public http::AbstractHttpResponse
+{
+public:
+    /// Constructor.
+    NotModifiedResponse()
+        : http::AbstractHttpResponse(http::HttpStatusCode::STATUS_NOT_MODIFIED)
+    {
+        header("ETag", static_etag);
+        header("Cache-Control", "no-cache");
+    }
+};
+
+/// Creates the response for embedded web content.
+///
+/// @param request is the request being processed.
+/// @param payload is the gzip compressed content.
+/// @param size is the size of @p payload.
+/// @param mime_type is the mime type of the content.
+/// @return the content or an empty 304 response when the browser already has
+/// the current content.
+static http::AbstractHttpResponse *static_response(
+    http::HttpRequest *request, const uint8_t *payload, size_t size,
+    const string &mime_type)
+{
+    if (request->has_header("If-None-Match") &&
+        request->header("If-None-Match").find(static_etag) != string::npos)
+    {
+        request->set_status(http::HttpStatusCode::STATUS_NOT_MODIFIED);
+        return new NotModifiedResponse();
+    }
+    return new CachedStaticResponse(payload, size, mime_type);
+}
+
+HTTP_HANDLER_IMPL(process_static, request)
+{
+    const string &uri = request->uri();
+    if (uri == "/index.html")
+    {
+        return static_response(request, indexHtmlGz, indexHtmlGz_size,
+                               http::MIME_TYPE_TEXT_HTML);
+    }
+    else if (uri == "/cash.min.js")
+    {
+        return static_response(request, cashJsGz, cashJsGz_size,
+                               http::MIME_TYPE_TEXT_JAVASCRIPT);
+    }
+    else if (uri == "/cdi.js")
+    {
+        return static_response(request, cdiJsGz, cdiJsGz_size,
+                               http::MIME_TYPE_TEXT_JAVASCRIPT);
+    }
+    else if (uri == "/spectre.min.css")
+    {
+        return static_response(request, spectreMinCssGz, spectreMinCssGz_size,
+                               http::MIME_TYPE_TEXT_CSS);
+    }
+    else if (uri == "/cdi.xml")
+    {
+        return static_response(request, cdiXmlGz, cdiXmlGz_size,
+                               http::MIME_TYPE_TEXT_XML);
+    }
+    request->set_status(http::HttpStatusCode::STATUS_NOT_FOUND);
+    return nullptr;
+}
+
 /// Cative portal landing page.
 static constexpr const char * const CAPTIVE_PORTAL_HTML = R"!^!(
 <html>
@@ -151,9 +256,91 @@ HTTP_STREAM_HANDLER_IMPL(process_ota, request, filename, size, data, length, off
     return nullptr;
 }
 
+/// Configuration backup response, the image is owned by the response and
+/// sent without being copied.
+///
+/// The Httpd sends a response body from a single buffer, the configuration
+/// file can not be streamed in chunks. The image is therefore read from the
+/// file directly into the buffer which is sent, this keeps one copy of the
+/// image in memory for the duration of the download.
+class ConfigBackupResponse : public http::StaticResponse
+{
+public:
+    /// Constructor.
+    ///
+    /// @param image is the backup image.
+    /// @param size is the size of @p image.
+    ConfigBackupResponse(std::unique_ptr<uint8_t[]> image, size_t size)
+        : http::StaticResponse(image.get(), size, "application/octet-stream")
+        , image_(std::move(image))
+    {
+    }
+
+private:
+    /// Backup image being sent.
+    std::unique_ptr<uint8_t[]> image_;
+};
+
+static std::unique_ptr<esp32io::ConfigRestore> config_restore;
+HTTP_HANDLER_IMPL(process_config_backup, request)
+{
+    bool include_nvs = request->has_param("nvs");
+    size_t size = esp32io::config_backup_size(openlcb::CONFIG_FILE_SIZE,
+                                              include_nvs);
+    std::unique_ptr<uint8_t[]> image(new (std::nothrow) uint8_t[size]);
+    if (!image ||
+        !esp32io::config_backup(openlcb::CONFIG_FILENAME,
+                                openlcb::CONFIG_FILE_SIZE, CDI_VERSION,
+                                include_nvs, image.get()))
+    {
+        LOG_ERROR("[Web] Configuration backup failed!");
+        request->set_status(http::HttpStatusCode::STATUS_SERVER_ERROR);
+        return nullptr;
+    }
+    LOG(INFO, "[Web] Sending configuration backup (%zu bytes)", size);
+    return new ConfigBackupResponse(std::move(image), size);
+}
+
+HTTP_STREAM_HANDLER_IMPL(process_config_restore, request, filename, size, data, length, offset, final, abort_req)
+{
+    if (!offset)
+    {
+        if (!config_restore)
+        {
+            config_restore.reset(
+                new esp32io::ConfigRestore(openlcb::CONFIG_FILENAME,
+                                           openlcb::CONFIG_FILE_SIZE,
+                                           CDI_VERSION));
+        }
+        config_restore->begin(size);
+        LOG(INFO, "[Web] Configuration restore starting (%zu bytes)...", size);
+    }
+    if (!config_restore->append(data, length) ||
+        (final && !config_restore->finish()))
+    {
+        LOG_ERROR("[Web] Configuration restore failed: %s",
+                  config_restore->error());
+        request->set_status(http::HttpStatusCode::STATUS_BAD_REQUEST);
+        *abort_req = true;
+        return new http::StringResponse(config_restore->error(),
+                                        http::MIME_TYPE_TEXT_PLAIN);
+    }
+    if (final)
+    {
+        // The stack only reads the restored configuration during startup.
+        request->set_status(http::HttpStatusCode::STATUS_OK);
+        Singleton<esp32io::DelayRebootHelper>::instance()->start();
+        return new http::StringResponse("Configuration restored, rebooting",
+                                        http::MIME_TYPE_TEXT_PLAIN);
+    }
+    return nullptr;
+}
+
 namespace esp32io
 {
 void factory_reset_events();
+string io_stats();
+string config_stats();
 } // namespace esp32io
 
 static uint32_t WS_REQ_ID = 0;
@@ -161,9 +348,190 @@ static constexpr const char * const ERROR_MISSING_PARAMS_RESPONSE =
     R"!^!({"res":"error", "error":"request is missing one (or more) required parameters"})!^!";
 static constexpr const char * const ERROR_MISSING_PARAMS_LOG =
     "[WSJSON] One or more required parameters are missing: %s";
+static constexpr const char * const ERROR_INVALID_PARAMS_RESPONSE =
+    R"!^!({"res":"error", "error":"request has one (or more) invalid parameters"})!^!";
+static constexpr const char * const ERROR_INVALID_PARAMS_LOG =
+    "[WSJSON] One or more parameters are invalid: %s";
+/// Response to a CDI request when the request pool is exhausted, the client
+/// should retry the request later.
+static constexpr const char * const BUSY_RESPONSE =
+    R"!^!({"res":"busy","tgt":"%s"})!^!";
+/// Response to a CDI batch request which can not be processed, the batch is
+/// not queued.
+static constexpr const char * const BATCH_ERROR_RESPONSE =
+    R"!^!({"res":"error","tgt":"%s","error":"request has one (or more) invalid parameters"})!^!";
+/// Response for a single field of a CDI batch request which was rejected, the
+/// remaining fields of the batch are still read.
+static constexpr const char * const FIELD_ERROR_RESPONSE =
+    R"!^!({"res":"field","tgt":"%s","error":"invalid field"})!^!";
+
+/// Checks that all fields of a CDI batch request carry the required
+/// parameters.
+///
+/// @param fields is the array of fields from the request.
+/// @return true if every field has an offset, size, type and target.
+static bool cdi_batch_fields_valid(cJSON *fields)
+{
+    cJSON *field;
+    cJSON_ArrayForEach(field, fields)
+    {
+        if (!cJSON_HasObjectItem(field, "ofs") ||
+            !cJSON_HasObjectItem(field, "sz") ||
+            !cJSON_IsString(cJSON_GetObjectItem(field, "type")) ||
+            !cJSON_IsString(cJSON_GetObjectItem(field, "tgt")))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Processes a binary websocket request, see @ref WsProtocol.hxx for the
+/// frame layout.
+///
+/// @param socket is the websocket the request was received on.
+/// @param data is the received frame.
+/// @param len is the length of @p data.
+static void process_ws_binary(http::WebSocketFlow *socket, uint8_t *data,
+                              size_t len)
+{
+    using namespace esp32io;
+    AllocCounterScope alloc_scope;
+    WsRequest req;
+    uint8_t response[WS_MAX_FRAME];
+    size_t response_len = 0;
+    if (!ws_decode_request(data, len, &req))
+    {
+        LOG_ERROR("[WSBIN] Malformed request (%zu bytes)", len);
+        response_len =
+            ws_encode_response(len ? data[0] : 0, 0,
+                               openlcb::Defs::ERROR_INVALID_ARGS, response);
+    }
+    else if (req.opcode == WS_OP_INFO)
+    {
+        const esp_app_desc_t *app_data = esp_ota_get_app_description();
+        const esp_partition_t *partition = esp_ota_get_running_partition();
+        WsInfo info = {node_id, 0};
+#if CONFIG_OLCB_ENABLE_TWAI
+        info.flags |= WsInfo::FLAG_TWAI;
+#endif // CONFIG_OLCB_ENABLE_TWAI
+#if CONFIG_OLCB_ENABLE_PWM
+        info.flags |= WsInfo::FLAG_PWM;
+#endif // CONFIG_OLCB_ENABLE_PWM
+        char timestamp[40];
+        snprintf(timestamp, sizeof(timestamp), "%s %s", app_data->date,
+                 app_data->time);
+        response_len = ws_encode_response(req.opcode, req.tag, 0, response);
+        memcpy(response + response_len, &info, sizeof(info));
+        response_len += sizeof(info);
+        ws_append_string(app_data->version, response, &response_len);
+        ws_append_string(timestamp, response, &response_len);
+        ws_append_string(partition->label, response, &response_len);
+        ws_append_string(openlcb::SNIP_STATIC_DATA.model_name, response,
+                         &response_len);
+        ws_append_string(openlcb::SNIP_STATIC_DATA.hardware_version,
+                         response, &response_len);
+        ws_append_string(openlcb::SNIP_STATIC_DATA.software_version,
+                         response, &response_len);
+    }
+    else if (req.opcode == WS_OP_EVENT_TEST)
+    {
+        Singleton<esp32io::EventBroadcastHelper>::instance()->send_event(
+            req.id);
+        response_len = ws_encode_response(req.opcode, req.tag, 0, response);
+    }
+    else
+    {
+        // Each field of a batch response is preceded by its index and size.
+        size_t batch_len = sizeof(WsFrameHeader) + sizeof(WsResponseHeader) + 1;
+        bool valid = req.size <= CDI_VALUE_SIZE;
+        if (req.opcode == WS_OP_CDI_BATCH)
+        {
+            valid = req.size <= CDI_MAX_BATCH_FIELDS;
+            for (uint8_t idx = 0; valid && idx < req.size; idx++)
+            {
+                WsBatchField field = req.field(idx);
+                batch_len += 2 + field.size;
+                valid = field.size <= CDI_VALUE_SIZE &&
+                        batch_len <= WS_MAX_FRAME;
+            }
+        }
+        Buffer<CDIClientRequest> *b = valid ? cdi_client->alloc() : nullptr;
+        CDIFieldBatch *batch = nullptr;
+        if (b && req.opcode == WS_OP_CDI_BATCH)
+        {
+            batch = cdi_client->alloc_batch();
+            if (!batch)
+            {
+                cdi_client->release(b);
+                b = nullptr;
+            }
+        }
+        if (!b)
+        {
+            LOG(VERBOSE, "[WSBIN] Rejecting request, valid:%d", valid);
+            response_len = ws_encode_response(
+                req.opcode, req.tag,
+                valid ? openlcb::Defs::ERROR_TEMPORARY
+                      : openlcb::Defs::ERROR_INVALID_ARGS, response);
+        }
+        else
+        {
+            openlcb::NodeHandle target(req.id);
+            if (req.opcode == WS_OP_CDI_READ)
+            {
+                LOG(VERBOSE,
+                    "[WSBIN:%" PRIu32 "] Sending CDI READ: offs:%" PRIu32
+                    " size:%u", WS_REQ_ID, req.offs, req.size);
+                b->data()->reset(CDIClientRequest::READ, target, socket,
+                                 WS_REQ_ID++, req.offs, req.size, "", "");
+            }
+            else if (req.opcode == WS_OP_CDI_WRITE)
+            {
+                LOG(VERBOSE,
+                    "[WSBIN:%" PRIu32 "] Sending CDI WRITE: offs:%" PRIu32
+                    " size:%u", WS_REQ_ID, req.offs, req.size);
+                b->data()->reset(CDIClientRequest::WRITE, target, socket,
+                                 WS_REQ_ID++, req.offs, req.size, "",
+                                 req.data, req.size);
+            }
+            else
+            {
+                for (uint8_t idx = 0; idx < req.size; idx++)
+                {
+                    WsBatchField field = req.field(idx);
+                    CDIField &entry = batch->fields[idx];
+                    entry.offs = field.offs;
+                    entry.size = field.size;
+                    entry.target[0] = '\0';
+                    entry.type[0] = '\0';
+                    entry.index = idx;
+                }
+                batch->count = req.size;
+                LOG(VERBOSE,
+                    "[WSBIN:%" PRIu32 "] Sending CDI READ BATCH: fields:%u",
+                    WS_REQ_ID, req.size);
+                b->data()->reset(CDIClientRequest::READ_BATCH, target, socket,
+                                 WS_REQ_ID++, "", batch);
+            }
+            b->data()->set_binary(req.opcode, req.tag);
+            b->data()->set_space(req.space);
+            cdi_client->send(b);
+            return;
+        }
+    }
+    // The web server allocates its own copy of the response.
+    AllocCounterScope pause(false);
+    socket->send_binary(response, response_len);
+}
+
 WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
 {
-    if (event == http::WebSocketEvent::WS_EVENT_TEXT)
+    if (event == http::WebSocketEvent::WS_EVENT_BINARY)
+    {
+        process_ws_binary(socket, data, len);
+    }
+    else if (event == http::WebSocketEvent::WS_EVENT_TEXT)
     {
         string response = R"!^!({"res":"error","error":"Request not understood"})!^!";
         string req = string((char *)data, len);
@@ -196,7 +564,7 @@ WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
             const esp_app_desc_t *app_data = esp_ota_get_app_description();
             const esp_partition_t *partition = esp_ota_get_running_partition();
             response =
-                StringPrintf(R"!^!({"res":"info","build":"%s","timestamp":"%s %s","ota":"%s","snip_name":"%s","snip_hw":"%s","snip_sw":"%s","node_id":"%s","twai":%s,"pwm":%s})!^!",
+                StringPrintf(R"!^!({"res":"info","build":"%s","timestamp":"%s %s","ota":"%s","snip_name":"%s","snip_hw":"%s","snip_sw":"%s","node_id":"%s","twai":%s,"pwm":%s,"boot":%s})!^!",
                     app_data->version, app_data->date, app_data->time,
                     partition->label, openlcb::SNIP_STATIC_DATA.model_name,
                     openlcb::SNIP_STATIC_DATA.hardware_version,
@@ -208,10 +576,11 @@ WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
                     "false",
 #endif // CONFIG_OLCB_ENABLE_TWAI
 #if CONFIG_OLCB_ENABLE_PWM
-                    "true"
+                    "true",
 #else
-                    "false"
+                    "false",
 #endif // CONFIG_OLCB_ENABLE_PWM
+                    boot_trace_json().c_str()
             );
         }
         else if (!strcmp(req_type->valuestring, "cdi"))
@@ -229,102 +598,202 @@ WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
             else
             {
                 size_t offs = cJSON_GetObjectItem(root, "ofs")->valueint;
-                std::string param_type =
+                const char *param_type =
                     cJSON_GetObjectItem(root, "type")->valuestring;
                 size_t size = cJSON_GetObjectItem(root, "sz")->valueint;
-                string target = cJSON_GetObjectItem(root, "tgt")->valuestring;
+                const char *target =
+                    cJSON_GetObjectItem(root, "tgt")->valuestring;
                 string node = cJSON_GetObjectItem(root, "node")->valuestring;
                 uint8_t space = cJSON_GetObjectItem(root, "spc")->valueint;
-                BufferPtr<CDIClientRequest> b(cdi_client->alloc());
                 openlcb::NodeHandle node_handle(string_to_uint64(node));
+                Buffer<CDIClientRequest> *b = nullptr;
 
-                if (!cJSON_HasObjectItem(root, "val"))
+                if (size == 0 || size > CDI_VALUE_SIZE ||
+                    strlen(target) >= CDI_TARGET_SIZE)
+                {
+                    LOG_ERROR(ERROR_INVALID_PARAMS_LOG, req.c_str());
+                    response = ERROR_INVALID_PARAMS_RESPONSE;
+                }
+                else if ((b = cdi_client->alloc()) == nullptr)
+                {
+                    response = StringPrintf(BUSY_RESPONSE, target);
+                }
+                else if (!cJSON_HasObjectItem(root, "val"))
                 {
                     LOG(VERBOSE,
                         "[WSJSON:%" PRIu32 "] Sending CDI READ: offs:%zu size:%zu "
                         "type:%s tgt:%s spc:%d", WS_REQ_ID, offs, size,
-                        param_type.c_str(), target.c_str(), space);
+                        param_type, target, space);
                     b->data()->reset(CDIClientRequest::READ, node_handle,
                                         socket, WS_REQ_ID++, offs, size, target,
-                                        param_type /*, space */);
+                                        param_type);
                 }
                 else
                 {
-                    string value = "";
+                    uint8_t value[CDI_VALUE_SIZE];
+                    size_t value_len = 0;
                     cJSON *raw_value = cJSON_GetObjectItem(root, "val");
-                    if (param_type == "str")
+                    if (!strcmp(param_type, "str"))
                     {
-                        // copy of up to the reported size.
-                        value = string(raw_value->valuestring, size);
-                        // ensure value is null terminated
-                        value += '\0';
+                        // copy of up to the reported size including the
+                        // null terminator.
+                        value_len =
+                            std::min(strlen(raw_value->valuestring), size - 1);
+                        memcpy(value, raw_value->valuestring, value_len);
+                        value[value_len++] = '\0';
                     }
-                    else if (param_type == "int")
+                    else if (!strcmp(param_type, "int"))
                     {
                         if (size == 1)
                         {
                             uint8_t data8 = std::stoi(raw_value->valuestring);
-                            value.clear();
-                            value.push_back(data8);
+                            value[value_len++] = data8;
                         }
                         else if (size == 2)
                         {
                             uint16_t data16 =
                                 std::stoi(raw_value->valuestring);
-                            value.clear();
-                            value.push_back((data16 >> 8) & 0xFF);
-                            value.push_back(data16 & 0xFF);
+                            value[value_len++] = (data16 >> 8) & 0xFF;
+                            value[value_len++] = data16 & 0xFF;
                         }
                         else
                         {
                             uint32_t data32 =
                                 std::stoul(raw_value->valuestring);
-                            value.clear();
-                            value.push_back((data32 >> 24) & 0xFF);
-                            value.push_back((data32 >> 16) & 0xFF);
-                            value.push_back((data32 >> 8) & 0xFF);
-                            value.push_back(data32 & 0xFF);
+                            value[value_len++] = (data32 >> 24) & 0xFF;
+                            value[value_len++] = (data32 >> 16) & 0xFF;
+                            value[value_len++] = (data32 >> 8) & 0xFF;
+                            value[value_len++] = data32 & 0xFF;
                         }
                     }
-                    else if (param_type == "evt")
+                    else if (!strcmp(param_type, "evt"))
                     {
                         uint64_t data =
                             string_to_uint64(string(raw_value->valuestring));
-                        value.clear();
-                        value.push_back((data >> 56) & 0xFF);
-                        value.push_back((data >> 48) & 0xFF);
-                        value.push_back((data >> 40) & 0xFF);
-                        value.push_back((data >> 32) & 0xFF);
-                        value.push_back((data >> 24) & 0xFF);
-                        value.push_back((data >> 16) & 0xFF);
-                        value.push_back((data >> 8) & 0xFF);
-                        value.push_back(data & 0xFF);
+                        for (int shift = 56; shift >= 0; shift -= 8)
+                        {
+                            value[value_len++] = (data >> shift) & 0xFF;
+                        }
                     }
                     LOG(VERBOSE,
                         "[WSJSON:%" PRIu32 "] Sending CDI WRITE: offs:%zu value:%s "
                         "tgt:%s spc:%d", WS_REQ_ID, offs,
-                        raw_value->valuestring, target.c_str(), space);
+                        raw_value->valuestring, target, space);
                     b->data()->reset(CDIClientRequest::WRITE, node_handle,
                                         socket, WS_REQ_ID++, offs, size, target,
-                                        value /*, space */);
+                                        value, value_len);
+                }
+                if (b)
+                {
+                    b->data()->set_space(space);
+                    cdi_client->send(b);
+                    cJSON_Delete(root);
+                    return;
+                }
+            }
+        }
+        else if (!strcmp(req_type->valuestring, "cdi-batch"))
+        {
+            cJSON *fields = cJSON_GetObjectItem(root, "fields");
+            if (!cJSON_HasObjectItem(root, "tgt") ||
+                !cJSON_HasObjectItem(root, "node") ||
+                !cJSON_IsArray(fields))
+            {
+                LOG_ERROR(ERROR_MISSING_PARAMS_LOG, req.c_str());
+                response = ERROR_MISSING_PARAMS_RESPONSE;
+            }
+            else if (cJSON_GetArraySize(fields) > (int)CDI_MAX_BATCH_FIELDS ||
+                     strlen(cJSON_GetObjectItem(root, "tgt")->valuestring) >=
+                        CDI_TARGET_SIZE)
+            {
+                LOG_ERROR(ERROR_INVALID_PARAMS_LOG, req.c_str());
+                response = ERROR_INVALID_PARAMS_RESPONSE;
+            }
+            else if (!cdi_batch_fields_valid(fields))
+            {
+                // Fields without a target can not be answered individually,
+                // reject the batch so the client does not wait for them.
+                LOG_ERROR(ERROR_MISSING_PARAMS_LOG, req.c_str());
+                response = StringPrintf(BATCH_ERROR_RESPONSE,
+                    cJSON_GetObjectItem(root, "tgt")->valuestring);
+            }
+            else
+            {
+                const char *target =
+                    cJSON_GetObjectItem(root, "tgt")->valuestring;
+                string node = cJSON_GetObjectItem(root, "node")->valuestring;
+                uint8_t space = openlcb::MemoryConfigDefs::SPACE_CONFIG;
+                if (cJSON_HasObjectItem(root, "spc"))
+                {
+                    space = cJSON_GetObjectItem(root, "spc")->valueint;
+                }
+                Buffer<CDIClientRequest> *b = cdi_client->alloc();
+                CDIFieldBatch *batch = b ? cdi_client->alloc_batch() : nullptr;
+                if (!batch)
+                {
+                    if (b)
+                    {
+                        cdi_client->release(b);
+                    }
+                    response = StringPrintf(BUSY_RESPONSE, target);
+                }
+                else
+                {
+                    cJSON *field;
+                    cJSON_ArrayForEach(field, fields)
+                    {
+                        CDIField &entry = batch->fields[batch->count];
+                        entry.offs =
+                            cJSON_GetObjectItem(field, "ofs")->valueint;
+                        entry.size =
+                            cJSON_GetObjectItem(field, "sz")->valueint;
+                        entry.index = batch->count;
+                        if (entry.size == 0 || entry.size > CDI_VALUE_SIZE ||
+                            !cdi_copy(entry.target, sizeof(entry.target),
+                                cJSON_GetObjectItem(field, "tgt")->valuestring) ||
+                            !cdi_copy(entry.type, sizeof(entry.type),
+                                cJSON_GetObjectItem(field, "type")->valuestring))
+                        {
+                            LOG_ERROR(ERROR_INVALID_PARAMS_LOG, req.c_str());
+                            socket->send_text(StringPrintf(FIELD_ERROR_RESPONSE,
+                                cJSON_GetObjectItem(field, "tgt")->valuestring)
+                                + "\n");
+                            continue;
+                        }
+                        batch->count++;
+                    }
+                    LOG(VERBOSE,
+                        "[WSJSON:%" PRIu32 "] Sending CDI READ BATCH: "
+                        "fields:%zu tgt:%s spc:%d", WS_REQ_ID, batch->count,
+                        target, space);
+                    b->data()->reset(CDIClientRequest::READ_BATCH,
+                        openlcb::NodeHandle(string_to_uint64(node)), socket,
+                        WS_REQ_ID++, target, batch);
+                    b->data()->set_space(space);
+                    cdi_client->send(b);
+                    cJSON_Delete(root);
+                    return;
                 }
-                b->data()->done.reset(EmptyNotifiable::DefaultInstance());
-                cdi_client->send(b->ref());
-                cJSON_Delete(root);
-                return;
             }
         }
         else if (!strcmp(req_type->valuestring, "update-complete"))
         {
-            LOG(VERBOSE, "[WSJSON:%" PRIu32 "] Sending UPDATE_COMPLETE to queue",
-                WS_REQ_ID);
-            BufferPtr<CDIClientRequest> b(cdi_client->alloc());
-            b->data()->reset(CDIClientRequest::UPDATE_COMPLETE,
-                             node_handle, socket, WS_REQ_ID++);
-            b->data()->done.reset(EmptyNotifiable::DefaultInstance());
-            cdi_client->send(b->ref());
-            cJSON_Delete(root);
-            return;
+            Buffer<CDIClientRequest> *b = cdi_client->alloc();
+            if (!b)
+            {
+                response = StringPrintf(BUSY_RESPONSE, "update-complete");
+            }
+            else
+            {
+                LOG(VERBOSE,
+                    "[WSJSON:%" PRIu32 "] Sending UPDATE_COMPLETE to queue",
+                    WS_REQ_ID);
+                b->data()->reset(CDIClientRequest::UPDATE_COMPLETE,
+                                 node_handle, socket, WS_REQ_ID++);
+                cdi_client->send(b);
+                cJSON_Delete(root);
+                return;
+            }
         }
         else if (!strcmp(req_type->valuestring, "factory-reset"))
         {
@@ -339,6 +808,18 @@ WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
             esp32io::factory_reset_events();
             response = R"!^!({"res":"reset-events"})!^!";
         }
+        else if (!strcmp(req_type->valuestring, "io-stats"))
+        {
+            response = esp32io::io_stats();
+        }
+        else if (!strcmp(req_type->valuestring, "cdi-stats"))
+        {
+            response = cdi_client->stats();
+        }
+        else if (!strcmp(req_type->valuestring, "cfg-stats"))
+        {
+            response = esp32io::config_stats();
+        }
         else if (!strcmp(req_type->valuestring, "event-test"))
         {
             string value = cJSON_GetObjectItem(root, "value")->valuestring;
@@ -357,38 +838,43 @@ WEBSOCKET_STREAM_HANDLER_IMPL(websocket_proc, socket, event, data, len)
     }
 }
 
-void init_webserver(openlcb::MemoryConfigClient *cfg_client,
+void init_webserver(openlcb::SimpleStackBase *stack,
                     openmrn_arduino::Esp32WiFiManager *wifi_mgr, uint64_t id)
 {
     const esp_app_desc_t *app_data = esp_ota_get_app_description();
-    memory_client = cfg_client;
     node_id = id;
     node_handle = openlcb::NodeHandle(id);
     LOG(INFO, "[Httpd] Initializing webserver");
+#if CONFIG_WS_BENCHMARK
+    esp32io::benchmark_ws_protocol();
+#endif // CONFIG_WS_BENCHMARK
     http_server.reset(new http::Httpd(wifi_mgr, &mdns));
     http_server->redirect_uri("/", "/index.html");
-    http_server->static_uri("/index.html", indexHtmlGz, indexHtmlGz_size,
-                            http::MIME_TYPE_TEXT_HTML,
-                            http::HTTP_ENCODING_GZIP,
-                            false);
-    http_server->static_uri("/cash.min.js", cashJsGz, cashJsGz_size,
-                            http::MIME_TYPE_TEXT_JAVASCRIPT,
-                            http::HTTP_ENCODING_GZIP);
-    http_server->static_uri("/cdi.js", cdiJsGz, cdiJsGz_size,
-                            http::MIME_TYPE_TEXT_JAVASCRIPT,
-                            http::HTTP_ENCODING_GZIP);
-    http_server->static_uri("/spectre.min.css", spectreMinCssGz,
-                            spectreMinCssGz_size, http::MIME_TYPE_TEXT_CSS,
-                            http::HTTP_ENCODING_GZIP);
-    http_server->static_uri("/cdi.xml", (const uint8_t *)openlcb::CDI_DATA,
-                            openlcb::CDI_SIZE, http::MIME_TYPE_TEXT_XML);
+    char elf_sha256[17];
+    esp_ota_get_app_elf_sha256(elf_sha256, sizeof(elf_sha256));
+    static_etag = StringPrintf("\"%s\"", elf_sha256);
+    for (const char *uri : {"/index.html", "/cash.min.js", "/cdi.js",
+                            "/spectre.min.css", "/cdi.xml"})
+    {
+        http_server->uri(uri, http::HttpMethod::GET, process_static);
+    }
     http_server->websocket_uri("/ws", websocket_proc);
     http_server->uri("/ota", http::HttpMethod::POST, nullptr, process_ota);
+    http_server->uri("/config.bin",
+                     http::HttpMethod::GET | http::HttpMethod::POST,
+                     process_config_backup, process_config_restore);
     http_server->captive_portal(
         StringPrintf(CAPTIVE_PORTAL_HTML, app_data->project_name,
                      app_data->version, app_data->project_name,
                      app_data->project_name));
-    cdi_client.reset(new CDIClient(wifi_mgr, cfg_client));
+    cdi_client.reset(new CDIScheduler(wifi_mgr, stack->node(),
+                                      stack->dg_service(),
+                                      stack->memory_config_handler(),
+                                      openlcb::CONFIG_FILENAME,
+                                      CONFIG_OLCB_CDI_CLIENT_WORKERS,
+                                      CONFIG_OLCB_CDI_CLIENT_NODE_WINDOW,
+                                      CONFIG_OLCB_CDI_REQUEST_POOL,
+                                      CONFIG_OLCB_CDI_BATCH_POOL));
 }
 
 void shutdown_webserver()
@@ -38,7 +38,6 @@
 namespace openlcb
 {
     class SimpleStackBase;
-    class MemoryConfigClient;
 }
 
 namespace openmrn_arduino
@@ -48,7 +47,7 @@ namespace openmrn_arduino
 
 class Service;
 
-void init_webserver(openlcb::MemoryConfigClient *cfg_client,
+void init_webserver(openlcb::SimpleStackBase *stack,
                     openmrn_arduino::Esp32WiFiManager *wifi_mgr, uint64_t id);
 void shutdown_webserver();
 
@@ -0,0 +1,199 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file MockI2CBus.hxx
+ *
+ * Simulated I2C bus used by the host tests.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#ifndef MOCK_I2C_BUS_HXX_
+#define MOCK_I2C_BUS_HXX_
+
+#include "I2CBus.hxx"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/// @ref I2CBus implementation which records all transactions. Devices are
+/// simulated as a set of responding addresses with an optional register
+/// file for reads, write failures (NACK) can be injected.
+///
+/// The bus can be used from any thread, the I2CWorker normally runs on its
+/// own executor.
+class MockI2CBus : public I2CBus
+{
+public:
+    /// Single recorded write transaction.
+    struct Write
+    {
+        /// 7-bit I2C address of the device.
+        uint8_t address;
+
+        /// Data written, including the register address.
+        std::vector<uint8_t> data;
+
+        /// Result returned to the caller.
+        esp_err_t result;
+    };
+
+    /// Adds a simulated device to the bus.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    void add_device(uint8_t address)
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        devices_.insert(address);
+    }
+
+    /// Sets the value of a register which is returned by @ref read.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    /// @param reg is the register address.
+    /// @param value is the register value.
+    void set_register(uint8_t address, uint8_t reg, uint8_t value)
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        registers_[{address, reg}] = value;
+    }
+
+    /// Fails the next write transactions with a NACK.
+    ///
+    /// @param count is the number of write transactions to fail.
+    void nack_writes(size_t count)
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        nacks_ = count;
+    }
+
+    /// Fails all write transactions to a device with a NACK, as if it had
+    /// been disconnected after initialization.
+    ///
+    /// @param address is the 7-bit I2C address of the device.
+    void fail_device(uint8_t address)
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        failing_.insert(address);
+    }
+
+    /// @return all write transactions since the last call to @ref clear.
+    std::vector<Write> writes()
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        return writes_;
+    }
+
+    /// Discards the recorded transactions.
+    void clear()
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        writes_.clear();
+    }
+
+    /// @return last bus speed set by @ref set_speed, zero if not set.
+    uint32_t speed()
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        return speed_;
+    }
+
+    esp_err_t write(uint8_t address, const uint8_t *data, size_t len) override
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        esp_err_t result = ESP_OK;
+        if (!devices_.count(address) || failing_.count(address))
+        {
+            result = ESP_FAIL;
+        }
+        else if (nacks_)
+        {
+            nacks_--;
+            result = ESP_FAIL;
+        }
+        writes_.push_back({address, std::vector<uint8_t>(data, data + len),
+                           result});
+        return result;
+    }
+
+    esp_err_t read(uint8_t address, uint8_t reg, uint8_t *data,
+                   size_t len) override
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        if (!devices_.count(address))
+        {
+            return ESP_FAIL;
+        }
+        for (size_t idx = 0; idx < len; idx++)
+        {
+            auto it = registers_.find({address, (uint8_t)(reg + idx)});
+            data[idx] = it == registers_.end() ? 0 : it->second;
+        }
+        return ESP_OK;
+    }
+
+    esp_err_t set_speed(uint32_t speed) override
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        speed_ = speed;
+        return ESP_OK;
+    }
+
+    esp_err_t ping(uint8_t address) override
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        return devices_.count(address) ? ESP_OK : ESP_FAIL;
+    }
+
+private:
+    /// Protects all members, the bus may be used from several threads.
+    std::mutex lock_;
+
+    /// Addresses of the simulated devices.
+    std::set<uint8_t> devices_;
+
+    /// Addresses of the devices which fail all writes.
+    std::set<uint8_t> failing_;
+
+    /// Register values of the simulated devices, keyed by address and
+    /// register.
+    std::map<std::pair<uint8_t, uint8_t>, uint8_t> registers_;
+
+    /// Recorded write transactions.
+    std::vector<Write> writes_;
+
+    /// Number of write transactions still to fail.
+    size_t nacks_{0};
+
+    /// Last bus speed set.
+    uint32_t speed_{0};
+};
+
+#endif // MOCK_I2C_BUS_HXX_
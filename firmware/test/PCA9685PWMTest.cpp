@@ -0,0 +1,321 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file PCA9685PWMTest.cpp
+ *
+ * Tests for the PCA9685 burst writes and their retry via the I2CWorker.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#include "utils/test_main.hxx"
+
+#include "MockI2CBus.hxx"
+#include "PCA9685PWM.hxx"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// Index of the LED0_ON_L register.
+static constexpr uint8_t LED0_ON_L = 0x06;
+
+/// Index of the ALL_LED_ON_L register.
+static constexpr uint8_t ALL_LED_ON_L = 0xFA;
+
+/// Index of the ALLCALLADR register used to identify a PCA9685.
+static constexpr uint8_t ALLCALLADR = 0x05;
+
+class PCA9685PWMTest : public ::testing::Test
+{
+protected:
+    PCA9685PWMTest()
+    {
+        for (uint8_t address : {0x40, 0x41})
+        {
+            bus_.add_device(address);
+            bus_.set_register(address, ALLCALLADR,
+                              PCA9685PWM::ALL_CALL_ADDRESS << 1);
+        }
+        EXPECT_EQ(ESP_OK, pwm_.hw_init());
+        wait_for_main_executor();
+        for (size_t channel = 0; channel < pwm_.num_channels(); channel++)
+        {
+            channels_.emplace_back(new PCA9685PWMBit(&pwm_, channel));
+        }
+        bus_.clear();
+    }
+
+    /// Applies duty cycle updates within a single executor pass and waits for
+    /// the resulting I2C writes to complete.
+    ///
+    /// @param updates are the channel and duty cycle pairs to apply.
+    void set_duty(std::vector<std::pair<size_t, uint32_t>> updates)
+    {
+        g_executor.sync_run([&]()
+        {
+            for (auto &update : updates)
+            {
+                PWM *pwm = channels_[update.first].get();
+                pwm->set_duty(update.second);
+            }
+        });
+        wait_for_main_executor();
+    }
+
+    /// @return the LEDn_ON/LEDn_OFF register values for a channel.
+    ///
+    /// @param channel is the channel on the device.
+    /// @param counts is the duty cycle of the channel.
+    static std::vector<uint8_t> encode(size_t channel, uint16_t counts)
+    {
+        uint16_t on = channel * 256;
+        uint16_t off = (counts + on) % 0x1000;
+        return {(uint8_t)(on & 0xFF), (uint8_t)(on >> 8),
+                (uint8_t)(off & 0xFF), (uint8_t)(off >> 8)};
+    }
+
+    /// @return the register values of a channel in the full OFF state.
+    static std::vector<uint8_t> full_off()
+    {
+        return {0x00, 0x00, 0x00, 0x10};
+    }
+
+    /// @return the register values of a channel within a burst write.
+    ///
+    /// @param write is the burst write.
+    /// @param channel is the channel on the device.
+    static std::vector<uint8_t> channel_data(const MockI2CBus::Write &write,
+                                            size_t channel)
+    {
+        size_t offs = 1 + (channel * 4) - (write.data[0] - LED0_ON_L);
+        return std::vector<uint8_t>(write.data.begin() + offs,
+                                    write.data.begin() + offs + 4);
+    }
+
+    MockI2CBus bus_;
+    I2CWorker worker_{&g_service, &bus_};
+    PCA9685PWM pwm_{&g_service, &worker_, 50, 2, 400000};
+    std::vector<std::unique_ptr<PCA9685PWMBit>> channels_;
+};
+
+TEST_F(PCA9685PWMTest, Initialize)
+{
+    EXPECT_EQ(32U, pwm_.num_channels());
+    EXPECT_EQ(400000U, bus_.speed());
+}
+
+TEST_F(PCA9685PWMTest, CoalesceNeighbouringChannels)
+{
+    // channels 0-2 and 4 are merged across the clean channel 3, channel 10
+    // is too far away and needs its own burst.
+    set_duty({{0, 100}, {1, 200}, {2, 300}, {4, 400}, {10, 500}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(2U, writes.size());
+
+    EXPECT_EQ(0x40, writes[0].address);
+    EXPECT_EQ(ESP_OK, writes[0].result);
+    ASSERT_EQ(1U + (5 * 4), writes[0].data.size());
+    EXPECT_EQ(LED0_ON_L, writes[0].data[0]);
+    EXPECT_EQ(encode(0, 100), channel_data(writes[0], 0));
+    EXPECT_EQ(encode(1, 200), channel_data(writes[0], 1));
+    EXPECT_EQ(encode(2, 300), channel_data(writes[0], 2));
+    EXPECT_EQ(full_off(), channel_data(writes[0], 3));
+    EXPECT_EQ(encode(4, 400), channel_data(writes[0], 4));
+
+    EXPECT_EQ(0x40, writes[1].address);
+    ASSERT_EQ(1U + 4, writes[1].data.size());
+    EXPECT_EQ(LED0_ON_L + (10 * 4), writes[1].data[0]);
+    EXPECT_EQ(encode(10, 500), channel_data(writes[1], 10));
+
+    EXPECT_EQ(2U, pwm_.transaction_count());
+    EXPECT_EQ(5U, pwm_.update_count());
+    EXPECT_EQ(0U, pwm_.error_count());
+}
+
+TEST_F(PCA9685PWMTest, LatestValueWins)
+{
+    set_duty({{5, 100}, {5, 200}, {5, 300}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    EXPECT_EQ(encode(5, 300), channel_data(writes[0], 5));
+    PWM *pwm = channels_[5].get();
+    EXPECT_EQ(300U, pwm->get_duty());
+}
+
+TEST_F(PCA9685PWMTest, UnchangedValueNotWritten)
+{
+    set_duty({{7, 1000}});
+    EXPECT_EQ(1U, bus_.writes().size());
+    bus_.clear();
+    set_duty({{7, 1000}});
+    EXPECT_EQ(0U, bus_.writes().size());
+}
+
+TEST_F(PCA9685PWMTest, AllChannelsBroadcast)
+{
+    std::vector<std::pair<size_t, uint32_t>> updates;
+    for (size_t channel = 0; channel < PCA9685PWM::NUM_CHANNELS; channel++)
+    {
+        updates.emplace_back(channel, 1000);
+    }
+    set_duty(updates);
+    auto writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    EXPECT_EQ(0x40, writes[0].address);
+    ASSERT_EQ(1U + 4, writes[0].data.size());
+    EXPECT_EQ(ALL_LED_ON_L, writes[0].data[0]);
+    // all channels share the phase of channel 0.
+    EXPECT_EQ(encode(0, 1000), std::vector<uint8_t>(
+        writes[0].data.begin() + 1, writes[0].data.end()));
+
+    // a burst across a clean channel re-writes the common phase value.
+    bus_.clear();
+    set_duty({{1, 2000}, {3, 2000}});
+    writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    ASSERT_EQ(1U + (3 * 4), writes[0].data.size());
+    EXPECT_EQ(LED0_ON_L + 4, writes[0].data[0]);
+    EXPECT_EQ(encode(1, 2000), channel_data(writes[0], 1));
+    EXPECT_EQ(encode(0, 1000), channel_data(writes[0], 2));
+    EXPECT_EQ(encode(3, 2000), channel_data(writes[0], 3));
+}
+
+TEST_F(PCA9685PWMTest, DifferentDutyNotBroadcast)
+{
+    std::vector<std::pair<size_t, uint32_t>> updates;
+    for (size_t channel = 0; channel < PCA9685PWM::NUM_CHANNELS; channel++)
+    {
+        updates.emplace_back(channel, channel == 15 ? 1001 : 1000);
+    }
+    set_duty(updates);
+    auto writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    ASSERT_EQ(1U + (16 * 4), writes[0].data.size());
+    EXPECT_EQ(LED0_ON_L, writes[0].data[0]);
+    EXPECT_EQ(encode(14, 1000), channel_data(writes[0], 14));
+    EXPECT_EQ(encode(15, 1001), channel_data(writes[0], 15));
+}
+
+TEST_F(PCA9685PWMTest, DevicesWrittenSeparately)
+{
+    set_duty({{15, 100}, {16, 200}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(2U, writes.size());
+    EXPECT_EQ(0x40, writes[0].address);
+    EXPECT_EQ(LED0_ON_L + (15 * 4), writes[0].data[0]);
+    EXPECT_EQ(encode(15, 100), channel_data(writes[0], 15));
+    EXPECT_EQ(0x41, writes[1].address);
+    EXPECT_EQ(LED0_ON_L, writes[1].data[0]);
+    EXPECT_EQ(encode(0, 200), channel_data(writes[1], 0));
+}
+
+TEST_F(PCA9685PWMTest, NackRetriedWithNextUpdate)
+{
+    bus_.nack_writes(1);
+    set_duty({{3, 100}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    EXPECT_EQ(ESP_FAIL, writes[0].result);
+    EXPECT_EQ(1U, pwm_.error_count());
+
+    // the failed channel is not retried in a loop, it is included in the
+    // burst of the next update.
+    bus_.clear();
+    wait_for_main_executor();
+    EXPECT_EQ(0U, bus_.writes().size());
+
+    set_duty({{5, 200}});
+    writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    EXPECT_EQ(ESP_OK, writes[0].result);
+    ASSERT_EQ(1U + (3 * 4), writes[0].data.size());
+    EXPECT_EQ(LED0_ON_L + (3 * 4), writes[0].data[0]);
+    EXPECT_EQ(encode(3, 100), channel_data(writes[0], 3));
+    EXPECT_EQ(full_off(), channel_data(writes[0], 4));
+    EXPECT_EQ(encode(5, 200), channel_data(writes[0], 5));
+    EXPECT_EQ(1U, pwm_.error_count());
+}
+
+TEST_F(PCA9685PWMTest, NackDoesNotBlockOtherDevices)
+{
+    // the failed device is skipped for the rest of the flush, the second
+    // device is still written.
+    bus_.nack_writes(1);
+    set_duty({{0, 100}, {16, 200}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(2U, writes.size());
+    EXPECT_EQ(0x40, writes[0].address);
+    EXPECT_EQ(ESP_FAIL, writes[0].result);
+    EXPECT_EQ(0x41, writes[1].address);
+    EXPECT_EQ(ESP_OK, writes[1].result);
+    EXPECT_EQ(encode(0, 200), channel_data(writes[1], 0));
+
+    // the failed channel is retried with the next update.
+    bus_.clear();
+    set_duty({{17, 300}});
+    writes = bus_.writes();
+    ASSERT_EQ(2U, writes.size());
+    EXPECT_EQ(0x40, writes[0].address);
+    EXPECT_EQ(ESP_OK, writes[0].result);
+    EXPECT_EQ(encode(0, 100), channel_data(writes[0], 0));
+    EXPECT_EQ(0x41, writes[1].address);
+    EXPECT_EQ(LED0_ON_L + 4, writes[1].data[0]);
+    EXPECT_EQ(encode(1, 300), channel_data(writes[1], 1));
+}
+
+TEST_F(PCA9685PWMTest, FailingDeviceDoesNotBlockOtherDevices)
+{
+    // the first device fails every write, each update is still written to
+    // the second device and the first device is tried once per flush.
+    bus_.fail_device(0x40);
+    for (uint32_t duty = 100; duty <= 500; duty += 100)
+    {
+        bus_.clear();
+        set_duty({{0, duty}, {16, duty}});
+        auto writes = bus_.writes();
+        ASSERT_EQ(2U, writes.size());
+        EXPECT_EQ(0x40, writes[0].address);
+        EXPECT_EQ(ESP_FAIL, writes[0].result);
+        EXPECT_EQ(encode(0, duty), channel_data(writes[0], 0));
+        EXPECT_EQ(0x41, writes[1].address);
+        EXPECT_EQ(ESP_OK, writes[1].result);
+        EXPECT_EQ(encode(0, duty), channel_data(writes[1], 0));
+    }
+    EXPECT_EQ(5U, pwm_.error_count());
+
+    // updates for the second device alone still retry the first device.
+    bus_.clear();
+    set_duty({{17, 600}});
+    auto writes = bus_.writes();
+    ASSERT_EQ(2U, writes.size());
+    EXPECT_EQ(0x40, writes[0].address);
+    EXPECT_EQ(ESP_FAIL, writes[0].result);
+    EXPECT_EQ(0x41, writes[1].address);
+    EXPECT_EQ(encode(1, 600), channel_data(writes[1], 1));
+}
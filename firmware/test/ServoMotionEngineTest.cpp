@@ -0,0 +1,260 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ServoMotionEngineTest.cpp
+ *
+ * Simulation of servo moves through the motion engine and the PCA9685 driver
+ * which counts the I2C writes of each tick.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#include "utils/test_main.hxx"
+
+#include "MockI2CBus.hxx"
+#include "PCA9685PWM.hxx"
+#include "ServoMotionEngine.hxx"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+using esp32io::ServoMotionEngine;
+
+/// Index of the LED0_ON_L register.
+static constexpr uint8_t LED0_ON_L = 0x06;
+
+/// Index of the ALLCALLADR register used to identify a PCA9685.
+static constexpr uint8_t ALLCALLADR = 0x05;
+
+/// Number of PWM counts between the 1ms and 2ms servo pulse widths with a
+/// 50Hz PWM frequency and 4096 counts per period.
+static constexpr uint32_t SERVO_RANGE = 205;
+
+/// PWM counts of the 1ms, 1.5ms and 2ms servo pulse widths.
+static constexpr uint32_t SERVO_MIN = 205;
+static constexpr uint32_t SERVO_MID = 307;
+static constexpr uint32_t SERVO_MAX = 410;
+
+/// Upper bound on the number of ticks for the simulation, this prevents a
+/// broken profile from hanging the test.
+static constexpr size_t MAX_TICKS = 10000;
+
+class ServoMotionEngineTest : public ::testing::Test
+{
+protected:
+    /// Servo outputs used by the tests, they are far enough apart that each
+    /// one is written with its own burst.
+    static constexpr size_t SERVO_CHANNELS[] = {0, 4, 8};
+
+    ServoMotionEngineTest()
+    {
+        bus_.add_device(0x40);
+        bus_.set_register(0x40, ALLCALLADR,
+                          PCA9685PWM::ALL_CALL_ADDRESS << 1);
+        EXPECT_EQ(ESP_OK, pwm_.hw_init());
+        wait_for_main_executor();
+        for (size_t channel : SERVO_CHANNELS)
+        {
+            outputs_.emplace_back(new PCA9685PWMBit(&pwm_, channel));
+            servos_.emplace_back(
+                new ServoMotionEngine::Channel(&engine_,
+                                               outputs_.back().get()));
+        }
+        bus_.clear();
+    }
+
+    /// Advances the engine by one simulated tick and waits for the resulting
+    /// I2C writes to complete.
+    ///
+    /// @return true if any output is still moving.
+    bool tick()
+    {
+        bool moving = false;
+        g_executor.sync_run([&]()
+        {
+            moving = engine_.advance();
+        });
+        wait_for_main_executor();
+        return moving;
+    }
+
+    /// @return the LEDn_ON/LEDn_OFF burst write of a single channel.
+    ///
+    /// @param channel is the channel on the device.
+    /// @param counts is the duty cycle of the channel.
+    static std::vector<uint8_t> encode(size_t channel, uint16_t counts)
+    {
+        uint16_t on = channel * 256;
+        uint16_t off = (counts + on) % 0x1000;
+        return {(uint8_t)(LED0_ON_L + (channel * 4)), (uint8_t)(on & 0xFF),
+                (uint8_t)(on >> 8), (uint8_t)(off & 0xFF),
+                (uint8_t)(off >> 8)};
+    }
+
+    MockI2CBus bus_;
+    I2CWorker worker_{&g_service, &bus_};
+    PCA9685PWM pwm_{&g_service, &worker_, 50, 1, 400000};
+    /// The engine runs on an executor which is never started so that the
+    /// ticks are only driven by the test. It is not destroyed since an
+    /// executor which never ran can not be shut down.
+    Executor<1> *idleExecutor_{new Executor<1>(NO_THREAD())};
+    Service idleService_{idleExecutor_};
+    ServoMotionEngine engine_{&idleService_};
+    std::vector<std::unique_ptr<PCA9685PWMBit>> outputs_;
+    std::vector<std::unique_ptr<ServoMotionEngine::Channel>> servos_;
+};
+
+constexpr size_t ServoMotionEngineTest::SERVO_CHANNELS[];
+
+TEST_F(ServoMotionEngineTest, FirstMoveIsImmediate)
+{
+    g_executor.sync_run([&]()
+    {
+        servos_[0]->set_limits(SERVO_RANGE, 100, 200);
+        servos_[0]->move_to(SERVO_MID);
+    });
+    wait_for_main_executor();
+    auto writes = bus_.writes();
+    ASSERT_EQ(1U, writes.size());
+    EXPECT_EQ(encode(0, SERVO_MID), writes[0].data);
+    EXPECT_FALSE(servos_[0]->is_moving());
+    EXPECT_EQ(0U, engine_.active_count());
+}
+
+TEST_F(ServoMotionEngineTest, TicksWriteOnlyChangedChannels)
+{
+    // all outputs start at the center, the first move is a jump.
+    g_executor.sync_run([&]()
+    {
+        servos_[0]->set_limits(SERVO_RANGE, 100, 200);
+        servos_[1]->set_limits(SERVO_RANGE, 50, 0);
+        servos_[2]->set_limits(SERVO_RANGE, 100, 100);
+        for (auto &servo : servos_)
+        {
+            servo->move_to(SERVO_MID);
+        }
+    });
+    wait_for_main_executor();
+    ASSERT_EQ(3U, bus_.writes().size());
+    bus_.clear();
+
+    // a long move with acceleration, a long move at constant velocity and
+    // a short move which settles first.
+    const uint32_t targets[] = {SERVO_MAX, SERVO_MIN, SERVO_MID + 10};
+    g_executor.sync_run([&]()
+    {
+        for (size_t index = 0; index < servos_.size(); index++)
+        {
+            servos_[index]->move_to(targets[index]);
+        }
+    });
+    wait_for_main_executor();
+    EXPECT_EQ(0U, bus_.writes().size());
+    EXPECT_EQ(3U, engine_.active_count());
+
+    size_t ticks = 0;
+    size_t writes_total = 0;
+    size_t held_ticks = 0;
+    std::vector<size_t> settled(servos_.size(), 0);
+    bool moving = true;
+    while (moving && ticks < MAX_TICKS)
+    {
+        std::vector<uint32_t> before;
+        std::vector<bool> was_moving;
+        for (auto &servo : servos_)
+        {
+            before.push_back(servo->position());
+            was_moving.push_back(servo->is_moving());
+        }
+        moving = tick();
+        ticks++;
+
+        // one burst for each output whose PWM count changed on this tick.
+        std::set<size_t> changed;
+        for (size_t index = 0; index < servos_.size(); index++)
+        {
+            if (servos_[index]->position() != before[index])
+            {
+                EXPECT_TRUE(was_moving[index])
+                    << "settled output " << index << " moved on tick "
+                    << ticks;
+                changed.insert(index);
+            }
+            else if (was_moving[index])
+            {
+                held_ticks++;
+            }
+            if (was_moving[index] && !servos_[index]->is_moving())
+            {
+                settled[index] = ticks;
+            }
+        }
+        auto writes = bus_.writes();
+        bus_.clear();
+        EXPECT_EQ(changed.size(), writes.size()) << "tick " << ticks;
+        for (size_t index = 0; index < writes.size(); index++)
+        {
+            size_t channel = (writes[index].data[0] - LED0_ON_L) / 4;
+            size_t servo = channel / 4;
+            ASSERT_LT(servo, servos_.size());
+            EXPECT_EQ(SERVO_CHANNELS[servo], channel);
+            EXPECT_TRUE(changed.count(servo)) << "tick " << ticks;
+            EXPECT_EQ(encode(channel, servos_[servo]->position()),
+                      writes[index].data);
+        }
+        writes_total += writes.size();
+    }
+    EXPECT_FALSE(moving);
+    for (size_t index = 0; index < servos_.size(); index++)
+    {
+        EXPECT_EQ(targets[index], servos_[index]->position());
+        EXPECT_FALSE(servos_[index]->is_moving());
+    }
+
+    // the short move settles first, the outputs only hold one write per
+    // count of travel at most.
+    EXPECT_LT(settled[2], settled[0]);
+    EXPECT_LT(settled[2], settled[1]);
+    EXPECT_LE(writes_total, (size_t)(SERVO_MAX - SERVO_MID) +
+                                (SERVO_MID - SERVO_MIN) + 10);
+    // while accelerating the position of a moving output changes by less
+    // than one count on some ticks, these must not produce any writes.
+    EXPECT_GT(held_ticks, 0U);
+    EXPECT_EQ(writes_total, engine_.write_count());
+    EXPECT_EQ(writes_total, pwm_.transaction_count() - 3);
+    EXPECT_EQ(ticks, engine_.tick_count());
+
+    // further ticks with all outputs settled produce no writes.
+    for (size_t idx = 0; idx < 10; idx++)
+    {
+        EXPECT_FALSE(tick());
+    }
+    EXPECT_EQ(0U, bus_.writes().size());
+    EXPECT_EQ(writes_total, engine_.write_count());
+}
@@ -0,0 +1,273 @@
+/** \copyright
+ * Copyright (c) 2021, Mike Dunston
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file ServoProfileTest.cpp
+ *
+ * Simulation of the servo trapezoidal velocity profile.
+ *
+ * @author Mike Dunston
+ * @date 16 October 2026
+ */
+
+#include "ServoProfile.hxx"
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+using esp32io::ServoProfile;
+
+/// Number of PWM counts between the 1ms and 2ms servo pulse widths with a
+/// 50Hz PWM frequency and 4096 counts per period.
+static constexpr uint32_t SERVO_RANGE = 205;
+
+/// Upper bound on the number of steps for any move, this prevents a broken
+/// profile from hanging the test.
+static constexpr size_t MAX_STEPS = 100000;
+
+class ServoProfileTest : public ::testing::Test
+{
+protected:
+    /// Advances the profile until it reaches its target, checking the
+    /// velocity and acceleration limits on every step.
+    ///
+    /// @return the number of steps taken.
+    size_t run()
+    {
+        size_t steps = 0;
+        bool moving = true;
+        while (moving && steps < MAX_STEPS)
+        {
+            moving = step();
+            steps++;
+        }
+        EXPECT_FALSE(moving);
+        return steps;
+    }
+
+    /// Advances the profile by one step and checks the velocity and
+    /// acceleration limits.
+    ///
+    /// @return true if the profile is still moving.
+    bool step()
+    {
+        int32_t position = profile_.position();
+        bool moving = profile_.step();
+        // the final step resets the velocity, use the distance moved.
+        int32_t velocity = profile_.position() - position;
+        EXPECT_LE(abs(velocity), profile_.max_velocity());
+        if (profile_.acceleration())
+        {
+            EXPECT_LE(abs(velocity - lastVelocity_), profile_.acceleration())
+                << "velocity " << lastVelocity_ << " -> " << velocity;
+        }
+        lastVelocity_ = moving ? velocity : 0;
+        if (!moving && profile_.acceleration())
+        {
+            // arriving at the target is a stop, this must also be within
+            // the acceleration limit.
+            EXPECT_LE(abs(velocity), profile_.acceleration());
+        }
+        return moving;
+    }
+
+    /// Position in fixed point counts.
+    static int32_t fixed(uint32_t counts)
+    {
+        return counts << ServoProfile::FRACTION_BITS;
+    }
+
+    ServoProfile profile_;
+    int32_t lastVelocity_{0};
+};
+
+TEST_F(ServoProfileTest, Unlimited)
+{
+    profile_.set_limits(SERVO_RANGE, 0, 100);
+    EXPECT_FALSE(profile_.is_limited());
+    profile_.jump_to(205);
+    profile_.set_target(410);
+    EXPECT_FALSE(profile_.step());
+    EXPECT_EQ(410U, profile_.counts());
+}
+
+TEST_F(ServoProfileTest, Limits)
+{
+    // 50% of 205 counts per second is 2.05 counts per 20ms tick.
+    profile_.set_limits(SERVO_RANGE, 50, 100);
+    EXPECT_TRUE(profile_.is_limited());
+    EXPECT_EQ(524, profile_.max_velocity());
+    // 100% of 205 counts per second per second is 0.082 counts per tick per
+    // tick.
+    EXPECT_EQ(20, profile_.acceleration());
+
+    // acceleration is ignored without a velocity limit.
+    profile_.set_limits(SERVO_RANGE, 0, 100);
+    EXPECT_EQ(0, profile_.acceleration());
+}
+
+TEST_F(ServoProfileTest, ConstantVelocity)
+{
+    profile_.set_limits(SERVO_RANGE, 50, 0);
+    profile_.jump_to(205);
+    profile_.set_target(410);
+    size_t steps = 0;
+    while (profile_.step())
+    {
+        EXPECT_EQ(profile_.max_velocity(), profile_.velocity());
+        EXPECT_LE(profile_.position(), fixed(410));
+        steps++;
+    }
+    EXPECT_EQ(410U, profile_.counts());
+    EXPECT_EQ(0, profile_.velocity());
+    // 205 counts at 2.05 counts per tick, the last step is shorter.
+    EXPECT_EQ(101U, steps + 1);
+}
+
+TEST_F(ServoProfileTest, TrapezoidNoOvershoot)
+{
+    profile_.set_limits(SERVO_RANGE, 50, 100);
+    profile_.jump_to(205);
+    profile_.set_target(410);
+    size_t steps = 0;
+    int32_t last = profile_.position();
+    int32_t peak = 0;
+    bool moving = true;
+    while (moving && steps < MAX_STEPS)
+    {
+        moving = step();
+        steps++;
+        // the output only moves towards the target and never passes it.
+        EXPECT_GE(profile_.position(), last);
+        EXPECT_LE(profile_.position(), fixed(410));
+        last = profile_.position();
+        peak = std::max(peak, lastVelocity_);
+    }
+    EXPECT_FALSE(moving);
+    EXPECT_EQ(fixed(410), profile_.position());
+    EXPECT_EQ(410U, profile_.counts());
+    EXPECT_EQ(0, profile_.velocity());
+    // the move is long enough to reach the velocity limit.
+    EXPECT_EQ(profile_.max_velocity(), peak);
+}
+
+TEST_F(ServoProfileTest, ShortMoveNoOvershoot)
+{
+    // the move is too short to reach the velocity limit.
+    profile_.set_limits(SERVO_RANGE, 100, 10);
+    profile_.jump_to(300);
+    profile_.set_target(290);
+    int32_t last = profile_.position();
+    while (step())
+    {
+        EXPECT_LE(profile_.position(), last);
+        EXPECT_GT(profile_.position(), fixed(290));
+        EXPECT_LT(abs(profile_.velocity()), profile_.max_velocity());
+        last = profile_.position();
+    }
+    EXPECT_EQ(fixed(290), profile_.position());
+}
+
+TEST_F(ServoProfileTest, ReverseWhileMoving)
+{
+    profile_.set_limits(SERVO_RANGE, 50, 100);
+    profile_.jump_to(205);
+    profile_.set_target(410);
+    for (size_t steps = 0; steps < 20; steps++)
+    {
+        ASSERT_TRUE(step());
+    }
+    ASSERT_GT(profile_.velocity(), 0);
+    ASSERT_GT(profile_.position(), fixed(215));
+
+    // the output slows down while still moving away from the new target,
+    // then reverses and stops at the new target without passing it.
+    profile_.set_target(215);
+    int32_t turn = profile_.position();
+    bool reversed = false;
+    bool moving = true;
+    size_t steps = 0;
+    while (moving && steps < MAX_STEPS)
+    {
+        int32_t velocity = profile_.velocity();
+        moving = step();
+        steps++;
+        if (!reversed && lastVelocity_ > 0)
+        {
+            EXPECT_LT(lastVelocity_, velocity);
+            turn = profile_.position();
+        }
+        else
+        {
+            reversed = true;
+            EXPECT_LE(lastVelocity_, 0);
+            EXPECT_GE(profile_.position(), fixed(215));
+            EXPECT_LE(profile_.position(), turn);
+        }
+    }
+    EXPECT_FALSE(moving);
+    EXPECT_TRUE(reversed);
+    EXPECT_EQ(215U, profile_.counts());
+}
+
+TEST_F(ServoProfileTest, RetargetSameDirection)
+{
+    profile_.set_limits(SERVO_RANGE, 50, 100);
+    profile_.jump_to(205);
+    profile_.set_target(410);
+    for (size_t steps = 0; steps < 10; steps++)
+    {
+        ASSERT_TRUE(step());
+    }
+    profile_.set_target(400);
+    run();
+    EXPECT_EQ(400U, profile_.counts());
+}
+
+TEST_F(ServoProfileTest, LimitsHeldForAllSettings)
+{
+    for (uint16_t velocity : {1, 10, 50, 100, 500, 1000})
+    {
+        for (uint16_t acceleration : {1, 10, 100, 1000, 5000})
+        {
+            for (uint32_t distance : {1, 3, 17, 100, 205})
+            {
+                SCOPED_TRACE(::testing::Message()
+                    << "velocity " << velocity << " acceleration "
+                    << acceleration << " distance " << distance);
+                profile_.set_limits(SERVO_RANGE, velocity, acceleration);
+                profile_.jump_to(300);
+                lastVelocity_ = 0;
+                profile_.set_target(300 + distance);
+                run();
+                EXPECT_EQ(fixed(300 + distance), profile_.position());
+                profile_.set_target(300 - distance);
+                run();
+                EXPECT_EQ(fixed(300 - distance), profile_.position());
+            }
+        }
+    }
+}
@@ -111,57 +111,82 @@ function show_group_tab(tab) {
     $(tab).removeClass('inactive');
     $('#rep-' + selected_tab).show();
 }
+const max_cdi_batch_fields = 32;
+function build_cdi_batches(fields) {
+    // Fields of the same node and memory space are requested together so that
+    // the node can combine neighbouring fields into a single memory config
+    // read.
+    var batches = [];
+    var open_batches = {};
+    fields.forEach(field => {
+        const req = JSON.parse(field.msg);
+        const batch_id = req.node + ':' + req.spc;
+        var batch = open_batches[batch_id];
+        if (!batch || batch.fields.length >= max_cdi_batch_fields) {
+            batch = { key: 'batch-' + batches.length, node: req.node, spc: req.spc, fields: [] };
+            open_batches[batch_id] = batch;
+            batches.push(batch);
+        }
+        batch.fields.push({ ofs: req.ofs, sz: req.sz, type: req.type, tgt: req.tgt });
+    });
+    return batches.map(batch => ({
+        key: batch.key,
+        count: batch.fields.length,
+        msg: JSON.stringify({
+            req: 'cdi-batch',
+            tgt: batch.key,
+            node: batch.node,
+            spc: batch.spc,
+            fields: batch.fields
+        })
+    }));
+}
 async function download_cdi_fields() {
     const maxConcurrentWorkers = $('#max_cdi_workers').val();
+    const batches = build_cdi_batches(cdi_fields);
     var activeWorkers = 0;
-    var fieldIndex = 0;
+    var batchIndex = 0;
+    var fieldCount = 0;
     const download_start = +new Date();
     var failures = 0;
     return new Promise(done => {
         const getNextTask = () => {
-            if (activeWorkers < maxConcurrentWorkers && fieldIndex < cdi_fields.length) {
-                console.debug(String.format('Workers:{0}/{1}, Index:{2}/{3}', activeWorkers, maxConcurrentWorkers, fieldIndex, cdi_fields.length));
-                const msg = cdi_fields[fieldIndex].msg;
-                const key = cdi_fields[fieldIndex].key;
+            if (activeWorkers < maxConcurrentWorkers && batchIndex < batches.length) {
+                console.debug(String.format('Workers:{0}/{1}, Index:{2}/{3}', activeWorkers, maxConcurrentWorkers, batchIndex, batches.length));
+                const batch = batches[batchIndex];
                 const start = +new Date();
-                $('#node-cdi-status').text(String.format('Retrieving field: {0}/{1}', fieldIndex, cdi_fields.length));
+                $('#node-cdi-status').text(String.format('Retrieving field: {0}/{1}', fieldCount, cdi_fields.length));
                 new Promise((resolve, reject) => {
-                    console.debug('requesting:', key, msg);
-                    ws_pending_response[key] = resolve;
-                    ws_tx(msg);
+                    console.debug('requesting:', batch.key, batch.msg);
+                    ws_pending_response[batch.key] = resolve;
+                    ws_tx(batch.msg);
                     setTimeout(() => {
-                        reject(new Error('Failed to receive response after 10sec: ' + msg));
+                        reject(new Error('Failed to receive response after 10sec: ' + batch.msg));
                     }, 10000);
-                }).then(() => {
+                }).then(json => {
+                    if (json && json.res === 'busy') {
+                        throw new Error('Request pool exhausted');
+                    }
                     const end = +new Date();
-                    console.debug(String.format('{0} completed in {1} ms', key, (end - start)));
-                    delete ws_pending_response[key];
+                    console.debug(String.format('{0} completed in {1} ms', batch.key, (end - start)));
+                    delete ws_pending_response[batch.key];
+                    fieldCount += batch.count;
                     activeWorkers--;
                     getNextTask();
                 }).catch(reason => {
                     const end = +new Date();
-                    console.debug(String.format('{0} failed in {1} ms: {2}', key, (end - start), reason));
+                    console.debug(String.format('{0} failed in {1} ms: {2}', batch.key, (end - start), reason));
+                    delete ws_pending_response[batch.key];
                     activeWorkers--;
                     failures++;
-                    console.log(String.format('Failed to download {0}, queueing redownload', key));
-                    cdi_fields.push({
-                        key: key,
-                        msg: JSON.stringify({
-                            req: 'cdi',
-                            ofs: parseInt($('#' + key).data('offset')),
-                            sz: parseInt($('#' + key).data('size')),
-                            type: $('#' + key).data('type'),
-                            tgt: key,
-                            node: $('#' + key).data('node'),
-                            spc: parseInt($('#' + key).data('space'))
-                        })
-                    });
+                    console.log(String.format('Failed to download {0}, queueing redownload', batch.key));
+                    batches.push(batch);
                     getNextTask();
                 });
-                fieldIndex++;
+                batchIndex++;
                 activeWorkers++;
                 getNextTask();
-            } else if (activeWorkers === 0 && fieldIndex === cdi_fields.length) {
+            } else if (activeWorkers === 0 && batchIndex === batches.length) {
                 const download_end = +new Date();
                 console.info(String.format('Downloaded {0} fields in {1} ms ({2} failures) with {3} concurrent requests',
                     cdi_fields.length, (download_end - download_start), failures, maxConcurrentWorkers));